@@ -93,6 +93,28 @@ static double Deg(double ang)
 	return ang / M_PI * 180.0;
 }
 
+namespace {
+/**
+ * Passes every entity record to the creation interface as soon as it
+ * is decoded, the document does not keep the entity lists.
+ */
+class DL_JwwStreamHandler : public JWWReadHandler {
+public:
+	DL_JwwStreamHandler(DL_Jww* j, DL_CreationInterface* ci):
+		jww(j), creationInterface(ci) {}
+	void OnSen(CDataSen& D) { jww->CreateSen(creationInterface, D); }
+	void OnEnko(CDataEnko& D) { jww->CreateEnko(creationInterface, D); }
+	void OnTen(CDataTen& D) { jww->CreateTen(creationInterface, D); }
+	void OnMoji(CDataMoji& D) { jww->CreateMoji(creationInterface, D); }
+	void OnSunpou(CDataSunpou& D) { jww->CreateSunpou(creationInterface, D); }
+	void OnSolid(CDataSolid& D) { jww->CreateSolid(creationInterface, D); }
+	void OnBlock(CDataBlock& D) { jww->CreateBlock(creationInterface, D); }
+private:
+	DL_Jww* jww;
+	DL_CreationInterface* creationInterface;
+};
+}
+
 /**
  * Default constructor.
  */
@@ -671,35 +693,15 @@ bool DL_Jww::in(const string& file, DL_CreationInterface* creationInterface) {
 	//JWWファイル読み取り
 	string ofile("");
 	JWWDocument* jwdoc = new JWWDocument((std::string&)file, ofile);
-	if(!jwdoc->Read())
-		return false;
 	//DXF変数設定
 	creationInterface->setVariableString("$DWGCODEPAGE", "SJIS", 7);
 	creationInterface->setVariableString("$TEXTSTYLE", "japanese", 7);
-	//線分データ
-	for( unsigned int i = 0; i < jwdoc->vSen.size(); i++ )
-		CreateSen(creationInterface, jwdoc->vSen[i]);
-	//円弧データ
-	for( unsigned int i = 0; i < jwdoc->vEnko.size(); i++ )
-		CreateEnko(creationInterface, jwdoc->vEnko[i]);
-	//点データ
-	for( unsigned int i = 0; i < jwdoc->vTen.size(); i++ )
-		CreateTen(creationInterface, jwdoc->vTen[i]);
-	//文字データ
-	for( unsigned int i = 0; i < jwdoc->vMoji.size(); i++ )
-		CreateMoji(creationInterface, jwdoc->vMoji[i]);
-	//寸法
-    for(unsigned int i=0 ; i < jwdoc->vSunpou.size(); i++ )
-		CreateSunpou(creationInterface, jwdoc->vSunpou[i]);
-	//ソリッド
-    for(unsigned int i=0 ; i < jwdoc->vSolid.size(); i++ )
-		CreateSolid(creationInterface, jwdoc->vSolid[i]);
-	//部品
-    for(unsigned int i=0 ; i < jwdoc->vBlock.size(); i++)
-		CreateBlock(creationInterface, jwdoc->vBlock[i]);
+	//図形は読み込みながら追加する、ブロック定義部だけはJWWDocumentに残る
+	DL_JwwStreamHandler handler(this, creationInterface);
+	bool ret = jwdoc->Read(&handler);
 	delete jwdoc;
 
-	return true;
+	return ret;
 }
 
 /**
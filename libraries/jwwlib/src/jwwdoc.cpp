@@ -942,7 +942,7 @@ jwBOOL JWWDocument::WriteHeader()
 }
 
 //データファイル読み込み
-jwBOOL JWWDocument::Read()
+jwBOOL JWWDocument::Read(JWWReadHandler* handler)
 {
     if(!ifs)
         return false;
@@ -1064,7 +1064,10 @@ cout << DSen;
                 ListCount++;
             } else
             {
-                vSen.push_back(DSen);
+                if( handler )
+                    handler->OnSen(DSen);
+                else
+                    vSen.push_back(DSen);
                 SenCount++;
             }
         }
@@ -1081,7 +1084,10 @@ cout << DEnko;
             }
             else
             {
-                vEnko.push_back(DEnko);
+                if( handler )
+                    handler->OnEnko(DEnko);
+                else
+                    vEnko.push_back(DEnko);
                 EnkoCount++;
             }
         }
@@ -1097,7 +1103,10 @@ cout << DTen;
                 ListCount++;
             } else
             {
-                vTen.push_back(DTen);
+                if( handler )
+                    handler->OnTen(DTen);
+                else
+                    vTen.push_back(DTen);
                 TenCount++;
             }
         }
@@ -1113,7 +1122,10 @@ cout << DMoji;
                 ListCount++;
             } else
             {
-                vMoji.push_back(DMoji);
+                if( handler )
+                    handler->OnMoji(DMoji);
+                else
+                    vMoji.push_back(DMoji);
                 MojiCount++;
             }
         }
@@ -1129,7 +1141,10 @@ cout << DSolid;
                 ListCount++;
             } else
             {
-                vSolid.push_back(DSolid);
+                if( handler )
+                    handler->OnSolid(DSolid);
+                else
+                    vSolid.push_back(DSolid);
                 SolidCount++;
             }
         }
@@ -1145,7 +1160,10 @@ cout << DBlock;
                 ListCount++;
             } else
             {
-                vBlock.push_back(DBlock);
+                if( handler )
+                    handler->OnBlock(DBlock);
+                else
+                    vBlock.push_back(DBlock);
                 BlockCount++;
             }
         }
@@ -1161,7 +1179,10 @@ cout << DSunpou;
                 ListCount++;
             } else
             {
-                vSunpou.push_back(DSunpou);
+                if( handler )
+                    handler->OnSunpou(DSunpou);
+                else
+                    vSunpou.push_back(DSunpou);
                 SunpouCount++;
             }
         }
@@ -888,6 +888,21 @@ public:
 	void AddItem(int No,string& str);
 };
 
+//読み込んだ図形データを逐次受け取るクラス
+//Read()に渡すとブロック定義部以外の図形はvSenなどに格納せずに直接渡す
+class	JWWReadHandler
+{
+public:
+	virtual ~JWWReadHandler(){}
+	virtual void OnSen(CDataSen& D) = 0;
+	virtual void OnEnko(CDataEnko& D) = 0;
+	virtual void OnTen(CDataTen& D) = 0;
+	virtual void OnMoji(CDataMoji& D) = 0;
+	virtual void OnSunpou(CDataSunpou& D) = 0;
+	virtual void OnSolid(CDataSolid& D) = 0;
+	virtual void OnBlock(CDataBlock& D) = 0;
+};
+
 //JWWファイル入出力クラス
 class	JWWDocument
 {
@@ -967,7 +982,7 @@ public:
 	string ReadString();
 	jwBOOL ReadHeader();
 	jwBOOL WriteHeader();
-	jwBOOL Read();
+	jwBOOL Read(JWWReadHandler* handler = NULL);
 	jwBOOL Save();
 	jwBOOL SaveBich16(jwDWORD id);
 	jwBOOL SaveSen(CDataSen const& DSen);
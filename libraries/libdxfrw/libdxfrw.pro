@@ -30,6 +30,7 @@ QT -= svg
 SOURCES += \
     src/libdxfrw.cpp \
     src/libdwgr.cpp \
+    src/libdwgw.cpp \
     src/drw_header.cpp \
     src/drw_classes.cpp \
     src/drw_entities.cpp \
@@ -46,11 +47,13 @@ SOURCES += \
     src/intern/dwgutil.cpp \
     src/intern/rscodec.cpp \
     src/intern/dwgreader27.cpp \
-    src/intern/dwgreader24.cpp
+    src/intern/dwgreader24.cpp \
+    src/intern/dwgwriter.cpp
 
 HEADERS += \
     src/libdxfrw.h \
     src/libdwgr.h \
+    src/libdwgw.h \
     src/drw_interface.h \
     src/drw_base.h \
     src/drw_header.h \
@@ -74,5 +77,6 @@ HEADERS += \
     src/intern/dwgutil.h \
     src/intern/rscodec.h \
     src/intern/dwgreader27.h \
-    src/intern/dwgreader24.h
+    src/intern/dwgreader24.h \
+    src/intern/dwgwriter.h
 
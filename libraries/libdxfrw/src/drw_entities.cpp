@@ -1261,7 +1261,7 @@ bool DRW_LWPolyline::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
         for (unsigned int i = 0; i < widthsnum; i++){
             double staW = buf->getBitDouble();
             double endW = buf->getBitDouble();
-            if (vertlist.size()< i) {
+            if (vertlist.size()> i) {
                 vertlist.at(i)->stawidth = staW;
                 vertlist.at(i)->endwidth = endW;
             }
@@ -1364,18 +1364,18 @@ bool DRW_Text::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
 
     if (version > DRW::AC1014) {//2000+
         if ( !(data_flags & 0x04) ) { /* Oblique ang RD 51 present if !(DataFlags & 0x04) */
-            oblique = buf->getRawDouble();
+            oblique = buf->getRawDouble() * ARAD;
         }
         if ( !(data_flags & 0x08) ) { /* Rotation ang RD 50 present if !(DataFlags & 0x08) */
-            angle = buf->getRawDouble();
+            angle = buf->getRawDouble() * ARAD;
         }
         height = buf->getRawDouble(); /* Height RD 40 */
         if ( !(data_flags & 0x10) ) { /* Width factor RD 41 present if !(DataFlags & 0x10) */
             widthscale = buf->getRawDouble();
         }
     } else {//14-
-        oblique = buf->getBitDouble(); /* Oblique ang BD 51 */
-        angle = buf->getBitDouble(); /* Rotation ang BD 50 */
+        oblique = buf->getBitDouble() * ARAD; /* Oblique ang BD 51 */
+        angle = buf->getBitDouble() * ARAD; /* Rotation ang BD 50 */
         height = buf->getBitDouble(); /* Height BD 40 */
         widthscale = buf->getBitDouble(); /* Width factor BD 41 */
     }
@@ -1447,6 +1447,7 @@ bool DRW_MText::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
     DRW_DBG("Insertion: "); DRW_DBGPT(basePoint.x, basePoint.y, basePoint.z); DRW_DBG("\n");
     extPoint = buf->get3BitDouble(); /* Extrusion 3BD 210 Undocumented; */
     secPoint = buf->get3BitDouble(); /* X-axis dir 3BD 11 */
+    haveXAxis = true;
     updateAngle();
     widthscale = buf->getBitDouble(); /* Rect width BD 41 */
     if (version > DRW::AC1018) {//2007+
@@ -1476,7 +1477,7 @@ bool DRW_MText::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
     text = sBuf->getVariableText(version, false); /* Text value TV 1 */
     if (version > DRW::AC1014) {//2000+
         buf->getBitShort();/* Linespacing Style BS 73 */
-        buf->getBitDouble();/* Linespacing Factor BD 44 */
+        interlin = buf->getBitDouble();/* Linespacing Factor BD 44 */
         buf->getBit();/* Unknown bit B */
     }
     if (version > DRW::AC1015) {//2004+
@@ -1947,7 +1948,7 @@ bool DRW_Hatch::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
     hpattern = buf->getBitShort();
     DRW_DBG("\nhatch style: "); DRW_DBG(hstyle); DRW_DBG(" pattern type"); DRW_DBG(hpattern);
     if (!solid){
-        angle = buf->getBitDouble();
+        angle = buf->getBitDouble() * ARAD;
         scale = buf->getBitDouble();
         doubleflag = buf->getBit();
         deflines = buf->getBitShort();
@@ -2143,8 +2144,9 @@ bool DRW_Spline::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs){
     controllist.reserve(ncontrol);
 	for (dint32 i= 0; i<ncontrol; ++i){
 		controllist.push_back(std::make_shared<DRW_Coord>(buf->get3BitDouble()));
-		if (weight)
+		if (weight) {
             DRW_DBG("\n w: "); DRW_DBG(buf->getBitDouble()); //RLZ Warning: D (BD or RD)
+        }
     }
     fitlist.reserve(nfit);
 	for (dint32 i= 0; i<nfit; ++i)
@@ -2662,7 +2664,7 @@ bool DRW_DimOrdinate::parseDwg(DRW::Version version, dwgBuffer *buf, duint32 bs)
     DRW_DBG("\ndef2: "); DRW_DBGPT(pt.x, pt.y, pt.z);
     duint8 type2 = buf->getRawChar8();//RLZ: correct this
     DRW_DBG("type2 (70) read: "); DRW_DBG(type2);
-    type =  (type2 & 1) ? type | 0x80 : type & 0xBF; //set bit 6
+    type =  (type2 & 1) ? type | 0x40 : type & 0xBF; //set bit 6
     DRW_DBG(" type (70) set: "); DRW_DBG(type);
     type |= 6;
     DRW_DBG("\n  type (70) final: "); DRW_DBG(type);
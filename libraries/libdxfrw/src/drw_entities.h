@@ -89,6 +89,7 @@ namespace DRW {
 //shape, dictionary, MLEADER, MLEADERSTYLE
 
 #define SETENTFRIENDS  friend class dxfRW; \
+                       friend class dwgWriter; \
                        friend class dwgReader;
 
 //! Base class for entities
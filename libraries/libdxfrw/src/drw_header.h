@@ -22,6 +22,7 @@ class dxfWriter;
 class dwgBuffer;
 
 #define SETHDRFRIENDS  friend class dxfRW; \
+                       friend class dwgWriter; \
                        friend class dwgReader;
 
 //! Class to handle header entries
@@ -47,6 +47,7 @@ namespace DRW {
 }
 
 #define SETOBJFRIENDS  friend class dxfRW; \
+                       friend class dwgWriter; \
                        friend class dwgReader;
 
 //! Base class for tables entries
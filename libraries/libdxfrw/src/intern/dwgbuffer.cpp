@@ -15,6 +15,16 @@
 #include "../libdwgr.h"
 #include "drw_textcodec.h"
 #include "drw_dbg.h"
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define DRW_HAVE_MMAP
+#endif
 //#include <bitset>
 /*#include <fstream>
 #include <algorithm>
@@ -144,6 +154,130 @@ bool dwgCharStream::read(duint8* s, duint64 n){
     return true;
 }
 
+dwgFileMap::dwgFileMap(const std::string &name):
+    buf{NULL},
+    sz{0},
+    opened{false},
+    mapped{false}
+{
+#ifdef _WIN32
+    hFile = hMap = NULL;
+#endif
+    if (!map(name))
+        load(name);
+}
+
+dwgFileMap::~dwgFileMap(){
+    unmap();
+}
+
+/*maps the whole file read-only, return false if the platform can't do it*/
+bool dwgFileMap::map(const std::string &name){
+#if defined(_WIN32)
+    HANDLE fh = CreateFileA(name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fh == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fs;
+    if (!GetFileSizeEx(fh, &fs) || fs.QuadPart == 0) {
+        CloseHandle(fh);
+        return false;
+    }
+    HANDLE mh = CreateFileMappingA(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mh == NULL) {
+        CloseHandle(fh);
+        return false;
+    }
+    void *p = MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0);
+    if (p == NULL) {
+        CloseHandle(mh);
+        CloseHandle(fh);
+        return false;
+    }
+    hFile = fh;
+    hMap = mh;
+    buf = static_cast<const duint8*>(p);
+    sz = fs.QuadPart;
+    opened = mapped = true;
+    return true;
+#elif defined(DRW_HAVE_MMAP)
+    int fd = ::open(name.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); //the mapping keeps its own reference
+    if (p == MAP_FAILED)
+        return false;
+    buf = static_cast<const duint8*>(p);
+    sz = st.st_size;
+    opened = mapped = true;
+    return true;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+/*fallback, reads the whole file in memory*/
+bool dwgFileMap::load(const std::string &name){
+    std::ifstream filestr(name.c_str(), std::ios_base::in | std::ios::binary);
+    if (!filestr.is_open() || !filestr.good())
+        return false;
+    filestr.seekg(0, std::ios::end);
+    std::streamoff fs = filestr.tellg();
+    filestr.seekg(0, std::ios_base::beg);
+    if (fs < 0)
+        return false;
+    content.resize(fs);
+    if (fs > 0) {
+        filestr.read(reinterpret_cast<char*>(&content.front()), fs);
+        if (!filestr.good())
+            return false;
+        buf = &content.front();
+    }
+    sz = fs;
+    opened = true;
+    return true;
+}
+
+void dwgFileMap::unmap(){
+    if (!mapped)
+        return;
+#if defined(_WIN32)
+    UnmapViewOfFile(buf);
+    CloseHandle(hMap);
+    CloseHandle(hFile);
+#elif defined(DRW_HAVE_MMAP)
+    munmap(const_cast<duint8*>(buf), sz);
+#endif
+    buf = NULL;
+    mapped = false;
+}
+
+bool dwgMappedStream::setPos(duint64 p){
+    if (p >= file->size())
+        return false;
+
+    pos = p;
+    return true;
+}
+
+bool dwgMappedStream::read(duint8* s, duint64 n){
+    if ( n > (file->size() - pos) ) {
+        isOk = false;
+        return false;
+    }
+    if (n > 0)
+        memcpy(s, file->data() + pos, n);
+    pos += n;
+    return true;
+}
+
 dwgBuffer::dwgBuffer(duint8 *buf, int size, DRW_TextCodec *dc):
 	filestr{new dwgCharStream(buf, size)}
 {
@@ -160,6 +294,15 @@ dwgBuffer::dwgBuffer(std::ifstream *stream, DRW_TextCodec *dc):
     bitPos = 0;
 }
 
+/*takes ownership of stream*/
+dwgBuffer::dwgBuffer(dwgBasicStream *stream, DRW_TextCodec *dc):
+	filestr{stream}
+{
+    decoder = dc;
+    maxSize = filestr->size();
+    bitPos = 0;
+}
+
 dwgBuffer::dwgBuffer( const dwgBuffer& org ):
 	filestr{org.filestr->clone()}
 {
@@ -923,3 +1066,214 @@ duint32 dwgBuffer::crc32(duint32 seed,dint32 start,dint32 end){
 //    return std::string(buffer);
 }*/
 
+
+dwgBufferW::dwgBufferW(DRW_TextCodec *encoder)
+    : bitPos(0), encoder(encoder) {
+}
+
+void dwgBufferW::putBit(duint8 b){
+    if (bitPos == 0)
+        buf.push_back(0);
+    if (b & 1)
+        buf.back() |= 0x80 >> bitPos;
+    bitPos = (bitPos + 1) & 7;
+}
+
+void dwgBufferW::put2Bits(duint8 b){
+    putBit((b >> 1) & 1);
+    putBit(b & 1);
+}
+
+void dwgBufferW::putRawChar8(duint8 c){
+    if (bitPos == 0) {
+        buf.push_back(c);
+        return;
+    }
+    buf.back() |= c >> bitPos;
+    buf.push_back(static_cast<duint8>(c << (8 - bitPos)));
+}
+
+void dwgBufferW::putRawShort16(duint16 s){
+    putRawChar8(s & 0xFF);
+    putRawChar8(s >> 8);
+}
+
+void dwgBufferW::putBERawShort16(duint16 s){
+    putRawChar8(s >> 8);
+    putRawChar8(s & 0xFF);
+}
+
+void dwgBufferW::putRawLong32(duint32 l){
+    putRawShort16(l & 0xFFFF);
+    putRawShort16(l >> 16);
+}
+
+void dwgBufferW::putRawDouble(double d){
+    duint8 tmp[8];
+    memcpy(tmp, &d, 8);
+    putBytes(tmp, 8);
+}
+
+void dwgBufferW::put2RawDouble(const DRW_Coord &c){
+    putRawDouble(c.x);
+    putRawDouble(c.y);
+}
+
+void dwgBufferW::putBytes(const duint8 *p, duint64 n){
+    for (duint64 i = 0; i < n; i++)
+        putRawChar8(p[i]);
+}
+
+/**Writes the shortest form of a bit short (BS) **/
+void dwgBufferW::putBitShort(duint16 s){
+    if (s == 0)
+        put2Bits(2);
+    else if (s == 256)
+        put2Bits(3);
+    else if (s < 256) {
+        put2Bits(1);
+        putRawChar8(static_cast<duint8>(s));
+    } else {
+        put2Bits(0);
+        putRawShort16(s);
+    }
+}
+
+/**Writes the shortest form of a bit long (BL) **/
+void dwgBufferW::putBitLong(dint32 l){
+    duint32 u = static_cast<duint32>(l);
+    if (u == 0)
+        put2Bits(2);
+    else if (u < 256) {
+        put2Bits(1);
+        putRawChar8(static_cast<duint8>(u));
+    } else {
+        put2Bits(0);
+        putRawLong32(u);
+    }
+}
+
+/**Writes the shortest form of a bit double (BD) **/
+void dwgBufferW::putBitDouble(double d){
+    if (d == 0.0)
+        put2Bits(2);
+    else if (d == 1.0)
+        put2Bits(1);
+    else {
+        put2Bits(0);
+        putRawDouble(d);
+    }
+}
+
+void dwgBufferW::put3BitDouble(const DRW_Coord &c){
+    putBitDouble(c.x);
+    putBitDouble(c.y);
+    putBitDouble(c.z);
+}
+
+/**Writes a double with default (DD), only full or unchanged forms are used **/
+void dwgBufferW::putDefaultDouble(double d, double def){
+    if (d == def)
+        put2Bits(0);
+    else {
+        put2Bits(3);
+        putRawDouble(d);
+    }
+}
+
+void dwgBufferW::putThickness(double t){
+    if (t == 0.0)
+        putBit(1);
+    else {
+        putBit(0);
+        putBitDouble(t);
+    }
+}
+
+void dwgBufferW::putExtrusion(const DRW_Coord &ext){
+    if (ext.x == 0.0 && ext.y == 0.0 && ext.z == 1.0)
+        putBit(1);
+    else {
+        putBit(0);
+        put3BitDouble(ext);
+    }
+}
+
+/**Writes modular unsigned int, 7 bits per byte, little-endian order (U-MC) **/
+void dwgBufferW::putUModularChar(duint32 v){
+    do {
+        duint8 b = v & 0x7F;
+        v >>= 7;
+        if (v != 0)
+            b |= 0x80;
+        putRawChar8(b);
+    } while (v != 0);
+}
+
+/**Writes modular signed int, sign in bit 6 of the last byte (MC) **/
+void dwgBufferW::putModularChar(dint32 v){
+    bool negative = v < 0;
+    duint32 u = negative ? static_cast<duint32>(-v) : static_cast<duint32>(v);
+    for (;;) {
+        duint8 b = u & 0x7F;
+        u >>= 7;
+        if (u == 0 && !(b & 0x40)) {
+            if (negative)
+                b |= 0x40;
+            putRawChar8(b);
+            return;
+        }
+        putRawChar8(b | 0x80);
+        if (u == 0) { //sign bit needs an extra byte
+            putRawChar8(negative ? 0x40 : 0);
+            return;
+        }
+    }
+}
+
+/**Writes modular short, 15 bits per word, little-endian order (MS) **/
+void dwgBufferW::putModularShort(duint32 v){
+    do {
+        duint16 w = v & 0x7FFF;
+        v >>= 15;
+        if (v != 0)
+            w |= 0x8000;
+        putRawShort16(w);
+    } while (v != 0);
+}
+
+/**Writes a handle reference with the minimal number of bytes (H) **/
+void dwgBufferW::putHandle(duint8 code, duint32 ref){
+    duint8 size = 0;
+    for (duint32 r = ref; r != 0; r >>= 8)
+        size++;
+    putRawChar8(static_cast<duint8>((code << 4) | size));
+    for (int i = size - 1; i >= 0; i--)
+        putRawChar8((ref >> (i * 8)) & 0xFF);
+}
+
+/**Writes a utf8 string converted to the drawing codepage (T) **/
+void dwgBufferW::putCP8Text(const std::string &s){
+    std::string str = encoder ? encoder->fromUtf8(s) : s;
+    putBitShort(static_cast<duint16>(str.size()));
+    putBytes(reinterpret_cast<const duint8*>(str.data()), str.size());
+}
+
+void dwgBufferW::putBuffer(const dwgBufferW &b){
+    duint64 n = b.bitSize();
+    duint64 full = n / 8;
+    putBytes(b.buf.data(), full);
+    for (duint64 i = full * 8; i < n; i++)
+        putBit((b.buf[i / 8] >> (7 - (i & 7))) & 1);
+}
+
+duint16 dwgBufferW::crc8(duint16 dx, const duint8 *p, duint64 n){
+    duint8 al;
+    while (n-- > 0) {
+        al = (duint8)((*p) ^ ((dint8)(dx & 0xFF)));
+        dx = (dx>>8) & 0xFF;
+        dx = dx ^ crctable[al & 0xFF];
+        p++;
+    }
+    return dx;
+}
@@ -16,6 +16,7 @@
 #include <fstream>
 #include <sstream>
 #include <memory>
+#include <vector>
 #include "../drw_base.h"
 
 class DRW_Coord;
@@ -76,9 +77,61 @@ private:
     bool isOk;
 };
 
+//! Read-only view of a whole file
+/*!
+*  The file is memory mapped when the platform allows it, otherwise it is
+*  read in memory at once. Shared by all the clones of a dwgMappedStream.
+*/
+class dwgFileMap {
+public:
+    dwgFileMap(const std::string &name);
+    ~dwgFileMap();
+    const duint8* data() const {return buf;}
+    duint64 size() const {return sz;}
+    bool isOpen() const {return opened;}
+private:
+    dwgFileMap(const dwgFileMap&) = delete;
+    dwgFileMap& operator=(const dwgFileMap&) = delete;
+    bool map(const std::string &name);
+    bool load(const std::string &name);
+    void unmap();
+
+    const duint8 *buf;
+    duint64 sz;
+    bool opened;
+    bool mapped;
+    std::vector<duint8> content; //fallback when can't map the file
+#ifdef _WIN32
+    void *hFile;
+    void *hMap;
+#endif
+};
+
+class dwgMappedStream: public dwgBasicStream{
+public:
+    dwgMappedStream(const std::string &name):
+        file{std::make_shared<dwgFileMap>(name)},
+        pos{0}
+    {
+        isOk = file->isOpen();
+    }
+	virtual ~dwgMappedStream() = default;
+    virtual bool read(duint8* s, duint64 n);
+    virtual duint64 size(){return file->size();}
+    virtual duint64 getPos(){return pos;}
+    virtual bool setPos(duint64 p);
+    virtual bool good(){return isOk;}
+    virtual dwgBasicStream* clone(){return new dwgMappedStream(*this);}
+private:
+    std::shared_ptr<dwgFileMap> file;
+    duint64 pos;
+    bool isOk;
+};
+
 class dwgBuffer {
 public:
     dwgBuffer(std::ifstream *stream, DRW_TextCodec *decoder = NULL);
+    dwgBuffer(dwgBasicStream *stream, DRW_TextCodec *decoder = NULL);
     dwgBuffer(duint8 *buf, int size, DRW_TextCodec *decoder= NULL);
     dwgBuffer( const dwgBuffer& org );
     dwgBuffer& operator=( const dwgBuffer& org );
@@ -153,4 +206,52 @@ private:
     UTF8STRING get16bitStr(duint16 textSize, bool nullTerm = true);
 };
 
+//! Bit stream writer, counterpart of dwgBuffer
+/*!
+*  Builds the bit coded data of a dwg object or section in memory,
+*  every put* function writes the same encoding read by the matching
+*  get* function of dwgBuffer. Only R2000 encoding is supported.
+*/
+class dwgBufferW {
+public:
+    dwgBufferW(DRW_TextCodec *encoder = NULL);
+    duint64 size() const {return buf.size();}
+    duint64 bitSize() const {return bitPos == 0 ? buf.size()*8 : (buf.size()-1)*8 + bitPos;}
+    const duint8* data() const {return buf.data();}
+    void clear(){buf.clear(); bitPos = 0;}
+
+    void putBit(duint8 b);  //B
+    void put2Bits(duint8 b); //BB
+    void putBitShort(duint16 s); //BS
+    void putBitLong(dint32 l); //BL
+    void putBitDouble(double d); //BD
+    void put3BitDouble(const DRW_Coord &c); //3BD
+    void putRawChar8(duint8 c);  //RC
+    void putRawShort16(duint16 s);  //RS
+    void putRawDouble(double d); //RD
+    void putRawLong32(duint32 l);   //RL
+    void put2RawDouble(const DRW_Coord &c); //2RD
+    void putUModularChar(duint32 v); //UMC
+    void putModularChar(dint32 v); //MC
+    void putModularShort(duint32 v); //MS
+    void putHandle(duint8 code, duint32 ref); //H
+    void putCP8Text(const std::string &s); //T utf8 text converted to codepage
+    void putObjType(duint16 t){putBitShort(t);} //OT R2000
+    void putExtrusion(const DRW_Coord &ext); //BE R2000 style
+    void putDefaultDouble(double d, double def); //DD
+    void putThickness(double t); //BT R2000 style
+    void putCmColor(dint32 c){putBitShort(static_cast<duint16>(c));} //CMC R2000
+    void putEnColor(dint32 c){putBitShort(static_cast<duint16>(c));} //ENC R2000
+    void putBERawShort16(duint16 s);  //RS big-endian order
+    void putBytes(const duint8 *p, duint64 n);
+    void putBuffer(const dwgBufferW &b); //appends all bits of b
+
+    static duint16 crc8(duint16 dx, const duint8 *p, duint64 n);
+
+private:
+    std::vector<duint8> buf;
+    duint8 bitPos; //used bits of the last byte, 0 if full
+    DRW_TextCodec *encoder;
+};
+
 #endif // DWGBUFFER_H
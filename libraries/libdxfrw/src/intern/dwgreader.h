@@ -120,7 +120,7 @@ public:
 class dwgReader {
 	friend class dwgR;
 public:
-	dwgReader(std::ifstream *stream, dwgR *p):
+	dwgReader(dwgBasicStream *stream, dwgR *p):
 		fileBuf{new dwgBuffer(stream)}
 	{
 		parent = p;
@@ -41,7 +41,7 @@ static const int DRW_magicNumEnd18[] = {
 
 class dwgReader18 : public dwgReader {
 public:
-	dwgReader18(std::ifstream *stream, dwgR *p):dwgReader(stream, p){
+	dwgReader18(dwgBasicStream *stream, dwgR *p):dwgReader(stream, p){
 	}
 	bool readMetaData() override;
 	bool readFileHeader() override;
@@ -94,7 +94,7 @@ bool dwgReader21::parseDataPage(dwgSectionInfo si, duint8 *dData){
 
 		std::vector<duint8> tmpPageRS(pi.size);
 
-        duint8 chunks =pi.size / 255;
+        duint32 chunks =pi.size / 255;
 		dwgRSCodec::decode251I(&tmpPageRaw.front(), &tmpPageRS.front(), chunks);
     #ifdef DRW_DBG_DUMP
         DRW_DBG("\nSection OBJECTS RS data=\n");
@@ -11,6 +11,7 @@
 ******************************************************************************/
 
 #include <sstream>
+#include <vector>
 #include "drw_dbg.h"
 #include "dwgutil.h"
 #include "rscodec.h"
@@ -34,31 +35,58 @@ std::string toHexStr(int n){
 }
 
 /**
- * @brief dwgRSCodec::decode239I
+ * @brief decodeI, decodes blk interleaved Reed-Solomon codewords
+ * The syndromes of all codewords are computed first in a single pass, only
+ * the codewords with errors are deinterleaved and sent to the full decoder.
+ * @param rsc : codec to use
+ * @param kk : length of data in a codeword
  * @param in : input data (at least 255*blk bytes)
- * @param out : output data (at least 239*blk bytes)
+ * @param out : output data (at least kk*blk bytes)
  * @param blk number of codewords ( 1 cw == 255 bytes)
  */
-void dwgRSCodec::decode239I(unsigned char *in, unsigned char *out, duint32 blk){
-    int k=0;
+static void decodeI(RScodec &rsc, int kk, unsigned char *in, unsigned char *out, duint32 blk){
+    if (blk == 0)
+        return;
+    //syn is empty without parity symbols (kk==255), syndromesI doesn't touch it then
+    std::vector<duint8> syn((255-kk)*blk);
+    bool errors = rsc.syndromesI(in, blk, syn.data());
     unsigned char data[255];
-    RScodec rsc(0x96, 8, 8); //(255, 239)
     for (duint32 i=0; i<blk; i++){
-        k = i;
-        for (int j=0; j<255; j++) {
-            data[j] = in[k];
-            k +=blk;
+        duint32 k = i*kk;
+        bool cwErrors = false;
+        for (int j=0; errors && j<255-kk; j++) {
+            if (syn[j*blk+i] != 0) {
+                cwErrors = true;
+                break;
+            }
+        }
+        if (!cwErrors) {
+            //common case, copy data symbols as is
+            for (int j=0; j<kk; j++)
+                out[k++] = in[i+j*blk];
+            continue;
         }
+        for (int j=0; j<255; j++)
+            data[j] = in[i+j*blk];
         int r = rsc.decode(data);
         if (r<0)
-            DRW_DBG("\nWARNING: dwgRSCodec::decode239I, can't correct all errors");
-        k = i*239;
-        for (int j=0; j<239; j++) {
+            DRW_DBG("\nWARNING: dwgRSCodec::decodeI, can't correct all errors");
+        for (int j=0; j<kk; j++)
             out[k++] = data[j];
-        }
     }
 }
 
+/**
+ * @brief dwgRSCodec::decode239I
+ * @param in : input data (at least 255*blk bytes)
+ * @param out : output data (at least 239*blk bytes)
+ * @param blk number of codewords ( 1 cw == 255 bytes)
+ */
+void dwgRSCodec::decode239I(unsigned char *in, unsigned char *out, duint32 blk){
+    static RScodec rsc(0x96, 8, 8); //(255, 239)
+    decodeI(rsc, 239, in, out, blk);
+}
+
 /**
  * @brief dwgRSCodec::decode251I
  * @param in : input data (at least 255*blk bytes)
@@ -66,23 +94,8 @@ void dwgRSCodec::decode239I(unsigned char *in, unsigned char *out, duint32 blk){
  * @param blk number of codewords ( 1 cw == 255 bytes)
  */
 void dwgRSCodec::decode251I(unsigned char *in, unsigned char *out, duint32 blk){
-    int k=0;
-    unsigned char data[255];
-    RScodec rsc(0xB8, 8, 2); //(255, 251)
-    for (duint32 i=0; i<blk; i++){
-        k = i;
-        for (int j=0; j<255; j++) {
-            data[j] = in[k];
-            k +=blk;
-        }
-        int r = rsc.decode(data);
-        if (r<0)
-            DRW_DBG("\nWARNING: dwgRSCodec::decode251I, can't correct all errors");
-        k = i*251;
-        for (int j=0; j<251; j++) {
-            out[k++] = data[j];
-        }
-    }
+    static RScodec rsc(0xB8, 8, 2); //(255, 251)
+    decodeI(rsc, 251, in, out, blk);
 }
 
 duint32 dwgCompressor::twoByteOffset(duint32 *ll){
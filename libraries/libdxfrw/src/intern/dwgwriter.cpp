@@ -0,0 +1,1662 @@
+/******************************************************************************
+**  libDXFrw - Library to read/write DXF files (ascii & binary)              **
+**                                                                           **
+**  Copyright (C) 2011-2015 José F. Soriano, rallazz@gmail.com               **
+**                                                                           **
+**  This library is free software, licensed under the terms of the GNU       **
+**  General Public License as published by the Free Software Foundation,     **
+**  either version 2 of the License, or (at your option) any later version.  **
+**  You should have received a copy of the GNU General Public License        **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
+******************************************************************************/
+
+
+#include <fstream>
+#include <cmath>
+#include <ctime>
+#include "dwgwriter.h"
+#include "drw_dbg.h"
+
+namespace {
+//fixed handles, same values used by dxfRW when writing dxf files
+const duint32 hBlockCtrl = 0x01;
+const duint32 hLayerCtrl = 0x02;
+const duint32 hStyleCtrl = 0x03;
+const duint32 hLTypeCtrl = 0x05;
+const duint32 hViewCtrl = 0x06;
+const duint32 hUcsCtrl = 0x07;
+const duint32 hVportCtrl = 0x08;
+const duint32 hAppIdCtrl = 0x09;
+const duint32 hDimstyleCtrl = 0x0A;
+const duint32 hVpEntHdrCtrl = 0x0B;
+const duint32 hNamedObjDict = 0x0C;
+const duint32 hGroupDict = 0x0D;
+const duint32 hMLineStyleDict = 0x0E;
+const duint32 hByBlock = 0x14;
+const duint32 hByLayer = 0x15;
+const duint32 hContinuous = 0x16;
+const duint32 hPaperSpace = 0x1B;
+const duint32 hModelSpace = 0x1F;
+const duint32 hFirstFree = 0x30;
+
+//handle reference codes
+const duint8 softOwner = 2;
+const duint8 hardOwner = 3;
+const duint8 softPtr = 4;
+const duint8 hardPtr = 5;
+
+//oType of the classes written in the classes section
+const duint16 lwPolylineClass = 500;
+const duint16 hatchClass = 501;
+
+const duint8 headerSentinel[] = {0xCF,0x7B,0x1F,0x23,0xFD,0xDE,0x38,0xA9,0x5F,0x7C,0x68,0xB8,0x4E,0x6D,0x33,0x5F};
+const duint8 classesSentinel[] = {0x8D,0xA1,0xC4,0xB8,0xC4,0xA9,0xF8,0xC5,0xC0,0xDC,0xF4,0x5F,0xE7,0xCF,0xB6,0x8A};
+const duint8 imageSentinel[] = {0x1F,0x25,0x6D,0x07,0xD4,0x36,0x28,0x28,0x9D,0x57,0xCA,0x3F,0x9D,0x44,0x10,0x2B};
+const duint8 fileHeaderSentinel[] = {0x95,0xA0,0x4E,0x28,0x99,0x82,0x1A,0xE5,0x5E,0x41,0xE0,0x5F,0x9D,0x3A,0x4D,0x00};
+
+//writes start sentinel, RL size, data, RS crc & end sentinel (header & classes sections)
+void putSection(dwgBufferW &out, const duint8 *sentinel, const dwgBufferW &data){
+    out.putBytes(sentinel, 16);
+    dwgBufferW body;
+    body.putRawLong32(data.size());
+    body.putBytes(data.data(), data.size());
+    out.putBytes(body.data(), body.size());
+    out.putRawShort16(dwgBufferW::crc8(0xC0C1, body.data(), body.size()));
+    for (int i = 0; i < 16; ++i)
+        out.putRawChar8(~sentinel[i]);
+}
+}
+
+dwgWriter::dwgWriter(std::ofstream *stream){
+    fileStr = stream;
+    encoder.setVersion(DRW::AC1015, false);
+    encoder.setCodePage("ANSI_1252", false);
+    currBlock = NULL;
+    defaultsAdded = false;
+    nextHandle = hFirstFree;
+    modelSpace.name = "*Model_Space";
+    modelSpace.handle = hModelSpace;
+    paperSpace.name = "*Paper_Space";
+    paperSpace.handle = hPaperSpace;
+}
+
+dwgWriter::~dwgWriter(){
+}
+
+std::string dwgWriter::toUpper(const std::string &s){
+    std::string u = s;
+    for (std::string::iterator it = u.begin(); it != u.end(); ++it)
+        *it = toupper(*it);
+    return u;
+}
+
+duint32 dwgWriter::findHandle(const std::map<std::string, duint32> &m, const std::string &name, duint32 def){
+    std::map<std::string, duint32>::const_iterator it = m.find(toUpper(name));
+    if (it == m.end())
+        return def;
+    return it->second;
+}
+
+void dwgWriter::addLType(const DRW_LType &ent){
+    std::string n = toUpper(ent.name);
+    //BYLAYER & BYBLOCK are always written with fixed handles
+    if (n == "BYLAYER" || n == "BYBLOCK" || ltypeMap.count(n))
+        return;
+    duint32 h = (n == "CONTINUOUS") ? hContinuous : nextHandle++;
+    ltypes.push_back(tableEntry<DRW_LType>(ent, h));
+    ltypeMap[n] = h;
+}
+
+void dwgWriter::addLayer(const DRW_Layer &ent){
+    std::string n = toUpper(ent.name);
+    if (layerMap.count(n))
+        return;
+    layers.push_back(tableEntry<DRW_Layer>(ent, nextHandle));
+    layerMap[n] = nextHandle++;
+}
+
+void dwgWriter::addTextstyle(const DRW_Textstyle &ent){
+    std::string n = toUpper(ent.name);
+    if (styleMap.count(n))
+        return;
+    styles.push_back(tableEntry<DRW_Textstyle>(ent, nextHandle));
+    styleMap[n] = nextHandle++;
+}
+
+void dwgWriter::addDimstyle(const DRW_Dimstyle &ent){
+    std::string n = toUpper(ent.name);
+    if (dimstyleMap.count(n))
+        return;
+    dimstyles.push_back(tableEntry<DRW_Dimstyle>(ent, nextHandle));
+    dimstyleMap[n] = nextHandle++;
+}
+
+void dwgWriter::addVport(const DRW_Vport &ent){
+    for (unsigned i = 0; i < vports.size(); ++i){
+        if (toUpper(vports.at(i).ent.name) == toUpper(ent.name))
+            return;
+    }
+    vports.push_back(tableEntry<DRW_Vport>(ent, nextHandle++));
+}
+
+void dwgWriter::addAppId(const DRW_AppId &ent){
+    for (unsigned i = 0; i < appIds.size(); ++i){
+        if (toUpper(appIds.at(i).ent.name) == toUpper(ent.name))
+            return;
+    }
+    appIds.push_back(tableEntry<DRW_AppId>(ent, nextHandle++));
+}
+
+void dwgWriter::addBlockRecord(const std::string &name){
+    addDefaults();
+    std::string n = toUpper(name);
+    if (n == "*MODEL_SPACE" || n == "*PAPER_SPACE" || blockMap.count(n))
+        return;
+    blockRecordW br;
+    br.name = name;
+    br.handle = nextHandle;
+    nextHandle += 3; //block record, BLOCK & ENDBLK
+    blockRecords.push_back(br);
+    blockMap[n] = br.handle;
+}
+
+/**
+ * Adds the table entries required by the entities and by the header
+ * if not supplied by the application, called before the first handle
+ * of a block record or entity is reserved.
+ */
+void dwgWriter::addDefaults(){
+    if (defaultsAdded)
+        return;
+    defaultsAdded = true;
+    if (!ltypeMap.count("CONTINUOUS")){
+        DRW_LType lt;
+        lt.name = "CONTINUOUS";
+        lt.desc = "Solid line";
+        addLType(lt);
+    }
+    if (!layerMap.count("0")){
+        DRW_Layer lay;
+        lay.name = "0";
+        addLayer(lay);
+    }
+    if (!styleMap.count("STANDARD")){
+        DRW_Textstyle ts;
+        ts.name = "Standard";
+        ts.font = "txt";
+        addTextstyle(ts);
+    }
+    if (!dimstyleMap.count("STANDARD")){
+        DRW_Dimstyle ds;
+        ds.name = "Standard";
+        addDimstyle(ds);
+    }
+    bool haveAcad = false;
+    for (unsigned i = 0; i < appIds.size(); ++i){
+        if (toUpper(appIds.at(i).ent.name) == "ACAD")
+            haveAcad = true;
+    }
+    if (!haveAcad){
+        DRW_AppId ai;
+        ai.name = "ACAD";
+        addAppId(ai);
+    }
+    if (vports.empty()){
+        DRW_Vport vp;
+        vp.name = "*Active";
+        addVport(vp);
+    }
+}
+
+/**
+ * Stores the encoded object, data starts after the EED and hData holds
+ * the handle stream.
+ */
+void dwgWriter::addObject(duint32 handle, duint16 type, const dwgBufferW &data, const dwgBufferW &hData){
+    dwgBufferW head;
+    head.putObjType(type);
+    dwgBufferW tail;
+    tail.putHandle(0, handle);
+    tail.putBitShort(0); //no EED
+    tail.putBuffer(data);
+    //RL size in bits of the object data, handle stream starts here
+    head.putRawLong32(head.bitSize() + 32 + tail.bitSize());
+    head.putBuffer(tail);
+    head.putBuffer(hData);
+
+    dwgBufferW obj;
+    obj.putModularShort(head.size());
+    obj.putBytes(head.data(), head.size());
+    obj.putRawShort16(dwgBufferW::crc8(0xC0C1, obj.data(), obj.size()));
+    objects[handle] = std::vector<duint8>(obj.data(), obj.data() + obj.size());
+}
+
+/**
+ * Writes the common entity data, the entity gets the next free handle.
+ * Block content are owned by the block record (entmode 0), the others
+ * are placed in model or paper space.
+ */
+duint32 dwgWriter::beginEntity(DRW_Entity *ent, dwgBufferW &data){
+    addDefaults();
+    ent->handle = nextHandle++;
+    data.putBit(0); //no graphics
+    if (currBlock != NULL)
+        data.put2Bits(0);
+    else
+        data.put2Bits(ent->space == DRW::PaperSpace ? 1 : 2);
+    data.putBitShort(0); //num reactors
+    data.putBit(1); //no links, next entity is handle+1
+    data.putEnColor(ent->color);
+    data.putBitDouble(ent->ltypeScale);
+    std::string lt = toUpper(ent->lineType);
+    if (lt == "BYLAYER" || lt.empty())
+        ent->ltFlags = 0;
+    else if (lt == "BYBLOCK")
+        ent->ltFlags = 1;
+    else
+        ent->ltFlags = ltypeMap.count(lt) ? 3 : 0;
+    data.put2Bits(ent->ltFlags);
+    data.put2Bits(0); //plot style by layer
+    data.putBitShort(ent->visible ? 0 : 1);
+    data.putRawChar8(DRW_LW_Conv::lineWidth2dwgInt(ent->lWeight));
+    return ent->handle;
+}
+
+void dwgWriter::putEntityHandles(DRW_Entity *ent, dwgBufferW &hData){
+    if (currBlock != NULL)
+        hData.putHandle(softPtr, currBlock->handle);
+    hData.putHandle(hardOwner, 0); //xdict
+    hData.putHandle(hardPtr, findHandle(layerMap, ent->layer, layerMap["0"]));
+    if (ent->ltFlags == 3)
+        hData.putHandle(hardPtr, findHandle(ltypeMap, ent->lineType, hByLayer));
+}
+
+void dwgWriter::endEntity(DRW_Entity *ent, duint16 type, const dwgBufferW &data, dwgBufferW &hData){
+    addObject(ent->handle, type, data, hData);
+    if (currBlock != NULL){
+        if (currBlock->firstEH == 0)
+            currBlock->firstEH = ent->handle;
+        currBlock->lastEH = ent->handle;
+    }
+}
+
+bool dwgWriter::writeBlock(DRW_Block *ent){
+    addDefaults();
+    std::string n = toUpper(ent->name);
+    if (!blockMap.count(n))
+        addBlockRecord(ent->name);
+    currBlock = NULL;
+    for (std::list<blockRecordW>::iterator it = blockRecords.begin(); it != blockRecords.end(); ++it){
+        if (it->handle == blockMap[n])
+            currBlock = &(*it);
+    }
+    if (currBlock == NULL)
+        return false;
+    currBlock->basePoint = ent->basePoint;
+    currBlock->flags = ent->flags;
+    putBlockEnt(currBlock->handle+1, currBlock->handle, currBlock->name, false);
+    putBlockEnt(currBlock->handle+2, currBlock->handle, currBlock->name, true);
+    return true;
+}
+
+void dwgWriter::endBlocks(){
+    currBlock = NULL;
+}
+
+/**
+ * Writes BLOCK or ENDBLK entities, owner 0 are for model & paper
+ * space blocks.
+ */
+void dwgWriter::putBlockEnt(duint32 handle, duint32 owner, const std::string &name, bool isEnd){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    data.putBit(0);
+    if (owner == hModelSpace)
+        data.put2Bits(2);
+    else if (owner == hPaperSpace)
+        data.put2Bits(1);
+    else
+        data.put2Bits(0);
+    data.putBitShort(0);
+    data.putBit(1);
+    data.putEnColor(256);
+    data.putBitDouble(1.0);
+    data.put2Bits(0);
+    data.put2Bits(0);
+    data.putBitShort(0);
+    data.putRawChar8(DRW_LW_Conv::lineWidth2dwgInt(DRW_LW_Conv::widthByLayer));
+    if (!isEnd)
+        data.putCP8Text(name);
+    if (owner != hModelSpace && owner != hPaperSpace)
+        hData.putHandle(softPtr, owner);
+    hData.putHandle(hardOwner, 0);
+    hData.putHandle(hardPtr, layerMap["0"]);
+    addObject(handle, isEnd ? 5 : 4, data, hData);
+}
+
+bool dwgWriter::writePoint(DRW_Point *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    data.putBitDouble(ent->basePoint.x);
+    data.putBitDouble(ent->basePoint.y);
+    data.putBitDouble(ent->basePoint.z);
+    data.putThickness(ent->thickness);
+    data.putExtrusion(ent->extPoint);
+    data.putBitDouble(0.0); //x axis
+    putEntityHandles(ent, hData);
+    endEntity(ent, 27, data, hData);
+    return true;
+}
+
+bool dwgWriter::writeLine(DRW_Line *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    bool zIsZero = (ent->basePoint.z == 0.0 && ent->secPoint.z == 0.0);
+    data.putBit(zIsZero);
+    data.putRawDouble(ent->basePoint.x);
+    data.putDefaultDouble(ent->secPoint.x, ent->basePoint.x);
+    data.putRawDouble(ent->basePoint.y);
+    data.putDefaultDouble(ent->secPoint.y, ent->basePoint.y);
+    if (!zIsZero){
+        data.putRawDouble(ent->basePoint.z);
+        data.putDefaultDouble(ent->secPoint.z, ent->basePoint.z);
+    }
+    data.putThickness(ent->thickness);
+    data.putExtrusion(ent->extPoint);
+    putEntityHandles(ent, hData);
+    endEntity(ent, 19, data, hData);
+    return true;
+}
+
+bool dwgWriter::writeRay(DRW_Ray *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    data.put3BitDouble(ent->basePoint);
+    data.put3BitDouble(ent->secPoint);
+    putEntityHandles(ent, hData);
+    endEntity(ent, 40, data, hData);
+    return true;
+}
+
+bool dwgWriter::writeXline(DRW_Xline *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    data.put3BitDouble(ent->basePoint);
+    data.put3BitDouble(ent->secPoint);
+    putEntityHandles(ent, hData);
+    endEntity(ent, 41, data, hData);
+    return true;
+}
+
+bool dwgWriter::writeCircle(DRW_Circle *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    data.put3BitDouble(ent->basePoint);
+    data.putBitDouble(ent->radious);
+    data.putThickness(ent->thickness);
+    data.putExtrusion(ent->extPoint);
+    putEntityHandles(ent, hData);
+    endEntity(ent, 18, data, hData);
+    return true;
+}
+
+bool dwgWriter::writeArc(DRW_Arc *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    data.put3BitDouble(ent->basePoint);
+    data.putBitDouble(ent->radious);
+    data.putThickness(ent->thickness);
+    data.putExtrusion(ent->extPoint);
+    data.putBitDouble(ent->staangle);
+    data.putBitDouble(ent->endangle);
+    putEntityHandles(ent, hData);
+    endEntity(ent, 17, data, hData);
+    return true;
+}
+
+bool dwgWriter::writeEllipse(DRW_Ellipse *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    data.put3BitDouble(ent->basePoint);
+    data.put3BitDouble(ent->secPoint);
+    data.put3BitDouble(ent->extPoint);
+    data.putBitDouble(ent->ratio);
+    data.putBitDouble(ent->staparam);
+    data.putBitDouble(ent->endparam);
+    putEntityHandles(ent, hData);
+    endEntity(ent, 35, data, hData);
+    return true;
+}
+
+bool dwgWriter::writeTrace(DRW_Trace *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    data.putThickness(ent->thickness);
+    data.putBitDouble(ent->basePoint.z);
+    data.put2RawDouble(ent->basePoint);
+    data.put2RawDouble(ent->secPoint);
+    data.put2RawDouble(ent->thirdPoint);
+    data.put2RawDouble(ent->fourPoint);
+    data.putExtrusion(ent->extPoint);
+    putEntityHandles(ent, hData);
+    endEntity(ent, ent->eType == DRW::SOLID ? 31 : 32, data, hData);
+    return true;
+}
+
+bool dwgWriter::writeSolid(DRW_Solid *ent){
+    return writeTrace(ent);
+}
+
+bool dwgWriter::write3dface(DRW_3Dface *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    bool noFlag = (ent->invisibleflag == DRW_3Dface::NoEdge);
+    bool zIsZero = (ent->basePoint.z == 0.0);
+    data.putBit(noFlag);
+    data.putBit(zIsZero);
+    data.putRawDouble(ent->basePoint.x);
+    data.putRawDouble(ent->basePoint.y);
+    if (!zIsZero)
+        data.putRawDouble(ent->basePoint.z);
+    data.putDefaultDouble(ent->secPoint.x, ent->basePoint.x);
+    data.putDefaultDouble(ent->secPoint.y, ent->basePoint.y);
+    data.putDefaultDouble(ent->secPoint.z, ent->basePoint.z);
+    data.putDefaultDouble(ent->thirdPoint.x, ent->secPoint.x);
+    data.putDefaultDouble(ent->thirdPoint.y, ent->secPoint.y);
+    data.putDefaultDouble(ent->thirdPoint.z, ent->secPoint.z);
+    data.putDefaultDouble(ent->fourPoint.x, ent->thirdPoint.x);
+    data.putDefaultDouble(ent->fourPoint.y, ent->thirdPoint.y);
+    data.putDefaultDouble(ent->fourPoint.z, ent->thirdPoint.z);
+    if (!noFlag)
+        data.putBitShort(ent->invisibleflag);
+    putEntityHandles(ent, hData);
+    endEntity(ent, 28, data, hData);
+    return true;
+}
+
+bool dwgWriter::writeLWPolyline(DRW_LWPolyline *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    bool haveBulges = false;
+    bool haveWidths = false;
+    for (unsigned i = 0; i < ent->vertlist.size(); ++i){
+        DRW_Vertex2D *v = ent->vertlist.at(i).get();
+        if (v->bulge != 0.0)
+            haveBulges = true;
+        if (v->stawidth != 0.0 || v->endwidth != 0.0)
+            haveWidths = true;
+    }
+    duint16 flags = 0;
+    if (ent->width != 0.0) flags |= 4;
+    if (ent->elevation != 0.0) flags |= 8;
+    if (ent->thickness != 0.0) flags |= 2;
+    if (ent->extPoint.x != 0.0 || ent->extPoint.y != 0.0 || ent->extPoint.z != 1.0) flags |= 1;
+    if (haveBulges) flags |= 16;
+    if (haveWidths) flags |= 32;
+    if (ent->flags & 1) flags |= 512;
+    if (ent->flags & 128) flags |= 128;
+
+    beginEntity(ent, data);
+    data.putBitShort(flags);
+    if (flags & 4)
+        data.putBitDouble(ent->width);
+    if (flags & 8)
+        data.putBitDouble(ent->elevation);
+    if (flags & 2)
+        data.putBitDouble(ent->thickness);
+    if (flags & 1)
+        data.put3BitDouble(ent->extPoint);
+    data.putBitLong(ent->vertlist.size());
+    if (flags & 16)
+        data.putBitLong(ent->vertlist.size());
+    if (flags & 32)
+        data.putBitLong(ent->vertlist.size());
+    for (unsigned i = 0; i < ent->vertlist.size(); ++i){
+        DRW_Vertex2D *v = ent->vertlist.at(i).get();
+        if (i == 0){
+            data.putRawDouble(v->x);
+            data.putRawDouble(v->y);
+        } else {
+            DRW_Vertex2D *pv = ent->vertlist.at(i-1).get();
+            data.putDefaultDouble(v->x, pv->x);
+            data.putDefaultDouble(v->y, pv->y);
+        }
+    }
+    if (flags & 16){
+        for (unsigned i = 0; i < ent->vertlist.size(); ++i)
+            data.putBitDouble(ent->vertlist.at(i)->bulge);
+    }
+    if (flags & 32){
+        for (unsigned i = 0; i < ent->vertlist.size(); ++i){
+            data.putBitDouble(ent->vertlist.at(i)->stawidth);
+            data.putBitDouble(ent->vertlist.at(i)->endwidth);
+        }
+    }
+    putEntityHandles(ent, hData);
+    endEntity(ent, lwPolylineClass, data, hData);
+    return true;
+}
+
+/**
+ * 2D polylines are written as LWPOLYLINE, 3D polylines and meshes
+ * are not supported.
+ */
+bool dwgWriter::writePolyline(DRW_Polyline *ent){
+    if (ent->flags & (8 | 16 | 64))
+        return false;
+    DRW_LWPolyline pol;
+    pol.layer = ent->layer;
+    pol.lineType = ent->lineType;
+    pol.color = ent->color;
+    pol.lWeight = ent->lWeight;
+    pol.ltypeScale = ent->ltypeScale;
+    pol.visible = ent->visible;
+    pol.space = ent->space;
+    pol.flags = ent->flags & 129;
+    pol.elevation = ent->basePoint.z;
+    pol.thickness = ent->thickness;
+    pol.extPoint = ent->extPoint;
+    for (unsigned i = 0; i < ent->vertlist.size(); ++i){
+        DRW_Vertex *v = ent->vertlist.at(i).get();
+        pol.addVertex(DRW_Vertex2D(v->basePoint.x, v->basePoint.y, v->bulge));
+        pol.vertlist.back()->stawidth = v->stawidth;
+        pol.vertlist.back()->endwidth = v->endwidth;
+    }
+    bool ret = writeLWPolyline(&pol);
+    ent->handle = pol.handle;
+    return ret;
+}
+
+bool dwgWriter::writeSpline(DRW_Spline *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    bool fitScenario = ent->controllist.empty() && !ent->fitlist.empty();
+    data.putBitLong(fitScenario ? 2 : 1);
+    data.putBitLong(ent->degree);
+    if (fitScenario){
+        data.putBitDouble(ent->tolfit);
+        data.put3BitDouble(ent->tgStart);
+        data.put3BitDouble(ent->tgEnd);
+        data.putBitLong(ent->fitlist.size());
+    } else {
+        data.putBit((ent->flags & 4) != 0);
+        data.putBit((ent->flags & 1) != 0);
+        data.putBit((ent->flags & 2) != 0);
+        data.putBitDouble(ent->tolknot);
+        data.putBitDouble(ent->tolcontrol);
+        data.putBitLong(ent->knotslist.size());
+        data.putBitLong(ent->controllist.size());
+        data.putBit(0); //weights are not stored
+        for (unsigned i = 0; i < ent->knotslist.size(); ++i)
+            data.putBitDouble(ent->knotslist.at(i));
+        for (unsigned i = 0; i < ent->controllist.size(); ++i)
+            data.put3BitDouble(*ent->controllist.at(i));
+    }
+    if (fitScenario){
+        for (unsigned i = 0; i < ent->fitlist.size(); ++i)
+            data.put3BitDouble(*ent->fitlist.at(i));
+    }
+    putEntityHandles(ent, hData);
+    endEntity(ent, 36, data, hData);
+    return true;
+}
+
+bool dwgWriter::writeInsert(DRW_Insert *ent){
+    duint32 blkH = findHandle(blockMap, ent->name, 0);
+    if (blkH == 0)
+        return false;
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    data.put3BitDouble(ent->basePoint);
+    if (ent->xscale == 1.0 && ent->yscale == 1.0 && ent->zscale == 1.0){
+        data.put2Bits(3);
+    } else if (ent->xscale == 1.0){
+        data.put2Bits(1);
+        data.putDefaultDouble(ent->yscale, ent->xscale);
+        data.putDefaultDouble(ent->zscale, ent->xscale);
+    } else if (ent->xscale == ent->yscale && ent->xscale == ent->zscale){
+        data.put2Bits(2);
+        data.putRawDouble(ent->xscale);
+    } else {
+        data.put2Bits(0);
+        data.putRawDouble(ent->xscale);
+        data.putDefaultDouble(ent->yscale, ent->xscale);
+        data.putDefaultDouble(ent->zscale, ent->xscale);
+    }
+    data.putBitDouble(ent->angle);
+    data.put3BitDouble(ent->extPoint);
+    data.putBit(0); //no attribs
+    putEntityHandles(ent, hData);
+    hData.putHandle(hardPtr, blkH);
+    endEntity(ent, 7, data, hData);
+    return true;
+}
+
+bool dwgWriter::writeText(DRW_Text *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    //angles are stored in degrees in DRW_Text and in radians in dwg
+    double oblique = ent->oblique / ARAD;
+    double angle = ent->angle / ARAD;
+    duint8 dataFlags = 0;
+    if (ent->basePoint.z == 0.0) dataFlags |= 0x01;
+    if (ent->alignH == DRW_Text::HLeft && ent->alignV == DRW_Text::VBaseLine) dataFlags |= 0x02;
+    if (oblique == 0.0) dataFlags |= 0x04;
+    if (angle == 0.0) dataFlags |= 0x08;
+    if (ent->widthscale == 1.0) dataFlags |= 0x10;
+    if (ent->textgen == 0) dataFlags |= 0x20;
+    if (ent->alignH == DRW_Text::HLeft) dataFlags |= 0x40;
+    if (ent->alignV == DRW_Text::VBaseLine) dataFlags |= 0x80;
+    data.putRawChar8(dataFlags);
+    if (!(dataFlags & 0x01))
+        data.putRawDouble(ent->basePoint.z);
+    data.putRawDouble(ent->basePoint.x);
+    data.putRawDouble(ent->basePoint.y);
+    if (!(dataFlags & 0x02)){
+        data.putDefaultDouble(ent->secPoint.x, ent->basePoint.x);
+        data.putDefaultDouble(ent->secPoint.y, ent->basePoint.y);
+    }
+    data.putExtrusion(ent->extPoint);
+    data.putThickness(ent->thickness);
+    if (!(dataFlags & 0x04))
+        data.putRawDouble(oblique);
+    if (!(dataFlags & 0x08))
+        data.putRawDouble(angle);
+    data.putRawDouble(ent->height);
+    if (!(dataFlags & 0x10))
+        data.putRawDouble(ent->widthscale);
+    data.putCP8Text(ent->text);
+    if (!(dataFlags & 0x20))
+        data.putBitShort(ent->textgen);
+    if (!(dataFlags & 0x40))
+        data.putBitShort(ent->alignH);
+    if (!(dataFlags & 0x80))
+        data.putBitShort(ent->alignV);
+    putEntityHandles(ent, hData);
+    hData.putHandle(hardPtr, findHandle(styleMap, ent->style, styleMap["STANDARD"]));
+    endEntity(ent, 1, data, hData);
+    return true;
+}
+
+bool dwgWriter::writeMText(DRW_MText *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    data.put3BitDouble(ent->basePoint);
+    data.put3BitDouble(ent->extPoint);
+    double angle = ent->angle / ARAD;
+    data.put3BitDouble(DRW_Coord(cos(angle), sin(angle), 0.0));
+    data.putBitDouble(ent->widthscale);
+    data.putBitDouble(ent->height);
+    data.putBitShort(ent->textgen);
+    data.putBitShort(1); //left to right
+    data.putBitDouble(0.0); //extents height
+    data.putBitDouble(ent->widthscale); //extents width
+    data.putCP8Text(ent->text);
+    data.putBitShort(1); //linespacing style, at least
+    data.putBitDouble(ent->interlin);
+    data.putBit(0);
+    putEntityHandles(ent, hData);
+    hData.putHandle(hardPtr, findHandle(styleMap, ent->style, styleMap["STANDARD"]));
+    endEntity(ent, 44, data, hData);
+    return true;
+}
+
+bool dwgWriter::writeHatch(DRW_Hatch *ent){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    data.putBitDouble(ent->basePoint.z);
+    data.put3BitDouble(ent->extPoint);
+    data.putCP8Text(ent->name);
+    data.putBit(ent->solid != 0);
+    data.putBit(ent->associative != 0);
+    data.putBitLong(ent->looplist.size());
+    for (unsigned i = 0; i < ent->looplist.size(); ++i){
+        DRW_HatchLoop *loop = ent->looplist.at(i).get();
+        std::vector<std::shared_ptr<DRW_Entity> > &objs = loop->objlist;
+        DRW_LWPolyline *pol = NULL;
+        if ((loop->type & 2) && !objs.empty() && objs.front()->eType == DRW::LWPOLYLINE)
+            pol = static_cast<DRW_LWPolyline*>(objs.front().get());
+        if (pol == NULL){
+            data.putBitLong(loop->type & ~2);
+            dint32 nSeg = 0;
+            for (unsigned j = 0; j < objs.size(); ++j){
+                DRW::ETYPE t = objs.at(j)->eType;
+                if (t == DRW::LINE || t == DRW::ARC || t == DRW::ELLIPSE)
+                    ++nSeg;
+            }
+            data.putBitLong(nSeg);
+            for (unsigned j = 0; j < objs.size(); ++j){
+                DRW_Entity *e = objs.at(j).get();
+                if (e->eType == DRW::LINE){
+                    DRW_Line *l = static_cast<DRW_Line*>(e);
+                    data.putRawChar8(1);
+                    data.put2RawDouble(l->basePoint);
+                    data.put2RawDouble(l->secPoint);
+                } else if (e->eType == DRW::ARC){
+                    DRW_Arc *a = static_cast<DRW_Arc*>(e);
+                    data.putRawChar8(2);
+                    data.put2RawDouble(a->basePoint);
+                    data.putBitDouble(a->radious);
+                    data.putBitDouble(a->staangle);
+                    data.putBitDouble(a->endangle);
+                    data.putBit(a->isccw != 0);
+                } else if (e->eType == DRW::ELLIPSE){
+                    DRW_Ellipse *el = static_cast<DRW_Ellipse*>(e);
+                    data.putRawChar8(3);
+                    data.put2RawDouble(el->basePoint);
+                    data.put2RawDouble(el->secPoint);
+                    data.putBitDouble(el->ratio);
+                    data.putBitDouble(el->staparam);
+                    data.putBitDouble(el->endparam);
+                    data.putBit(el->isccw != 0);
+                }
+            }
+        } else {
+            bool haveBulges = false;
+            for (unsigned j = 0; j < pol->vertlist.size(); ++j){
+                if (pol->vertlist.at(j)->bulge != 0.0)
+                    haveBulges = true;
+            }
+            data.putBitLong(loop->type);
+            data.putBit(haveBulges);
+            data.putBit(pol->flags & 1);
+            data.putBitLong(pol->vertlist.size());
+            for (unsigned j = 0; j < pol->vertlist.size(); ++j){
+                data.putRawDouble(pol->vertlist.at(j)->x);
+                data.putRawDouble(pol->vertlist.at(j)->y);
+                if (haveBulges)
+                    data.putBitDouble(pol->vertlist.at(j)->bulge);
+            }
+        }
+        data.putBitLong(0); //num boundary object handles
+    }
+    data.putBitShort(ent->hstyle);
+    data.putBitShort(ent->hpattern);
+    if (!ent->solid){
+        data.putBitDouble(ent->angle / ARAD);
+        data.putBitDouble(ent->scale);
+        data.putBit(ent->doubleflag != 0);
+        data.putBitShort(0); //pattern definition lines are taken from the pattern name
+    }
+    data.putBitLong(0); //num seed points
+    putEntityHandles(ent, hData);
+    endEntity(ent, hatchClass, data, hData);
+    return true;
+}
+
+/**
+ * Writes the data common to all dimension types, after the entity data.
+ */
+void dwgWriter::putDimensionCommon(DRW_Dimension *ent, dwgBufferW &data){
+    data.putExtrusion(ent->extPoint);
+    for (int i = 0; i < 5; ++i)
+        data.putBit(0);
+    data.putRawDouble(ent->textPoint.x);
+    data.putRawDouble(ent->textPoint.y);
+    data.putBitDouble(ent->textPoint.z);
+    duint8 flags = (ent->type & 0x80) ? 0 : 1;
+    if (ent->type & 0x20)
+        flags |= 2;
+    data.putRawChar8(flags);
+    data.putCP8Text(ent->text);
+    data.putBitDouble(ent->rot);
+    data.putBitDouble(0.0); //horizontal direction
+    data.put3BitDouble(DRW_Coord(0.0, 0.0, 0.0)); //insertion scale
+    data.putBitDouble(0.0); //insertion rotation
+    data.putBitShort(ent->align);
+    data.putBitShort(ent->linesty);
+    data.putBitDouble(ent->linefactor);
+    data.putBitDouble(0.0); //actual measurement
+    data.putRawDouble(ent->clonePoint.x);
+    data.putRawDouble(ent->clonePoint.y);
+}
+
+bool dwgWriter::writeDimension(DRW_Dimension *ent){
+    duint16 oType;
+    switch (ent->eType) {
+    case DRW::DIMLINEAR:
+        oType = 21;
+        break;
+    case DRW::DIMALIGNED:
+        oType = 22;
+        break;
+    case DRW::DIMANGULAR:
+        oType = 24;
+        break;
+    case DRW::DIMDIAMETRIC:
+        oType = 26;
+        break;
+    case DRW::DIMRADIAL:
+        oType = 25;
+        break;
+    case DRW::DIMANGULAR3P:
+        oType = 23;
+        break;
+    case DRW::DIMORDINATE:
+        oType = 20;
+        break;
+    default:
+        return false;
+    }
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    beginEntity(ent, data);
+    putDimensionCommon(ent, data);
+    switch (oType) {
+    case 21:
+    case 22:
+        data.put3BitDouble(ent->getPt3());
+        data.put3BitDouble(ent->getPt4());
+        data.put3BitDouble(ent->getDefPoint());
+        data.putBitDouble(ent->getOb52());
+        if (oType == 21)
+            data.putBitDouble(ent->getAn50() / ARAD);
+        break;
+    case 24:
+        data.putRawDouble(ent->getPt6().x);
+        data.putRawDouble(ent->getPt6().y);
+        data.put3BitDouble(ent->getPt3());
+        data.put3BitDouble(ent->getPt4());
+        data.put3BitDouble(ent->getPt5());
+        data.put3BitDouble(ent->getDefPoint());
+        break;
+    case 26:
+        data.put3BitDouble(ent->getPt5());
+        data.put3BitDouble(ent->getDefPoint());
+        data.putBitDouble(ent->getRa40());
+        break;
+    case 25:
+        data.put3BitDouble(ent->getDefPoint());
+        data.put3BitDouble(ent->getPt5());
+        data.putBitDouble(ent->getRa40());
+        break;
+    case 23:
+        data.put3BitDouble(ent->getDefPoint());
+        data.put3BitDouble(ent->getPt3());
+        data.put3BitDouble(ent->getPt4());
+        data.put3BitDouble(ent->getPt5());
+        break;
+    default: //ordinate
+        data.put3BitDouble(ent->getDefPoint());
+        data.put3BitDouble(ent->getPt3());
+        data.put3BitDouble(ent->getPt4());
+        data.putRawChar8((ent->type & 0x40) ? 1 : 0);
+    }
+    putEntityHandles(ent, hData);
+    hData.putHandle(hardPtr, findHandle(dimstyleMap, ent->style, dimstyleMap["STANDARD"]));
+    hData.putHandle(hardPtr, findHandle(blockMap, ent->name, 0));
+    endEntity(ent, oType, data, hData);
+    return true;
+}
+
+void dwgWriter::putTableCommon(const DRW_TableEntry &ent, dwgBufferW &data, int flags){
+    data.putBitLong(0); //num reactors
+    data.putCP8Text(ent.name);
+    data.putBit((flags & 64) != 0);
+    data.putBitShort(0); //xref index
+    data.putBit((flags & 16) != 0);
+}
+
+/**
+ * Writes a table control object, extra handles are the model & paper
+ * space block records in BLOCK control and BYBLOCK & BYLAYER in LTYPE control.
+ */
+void dwgWriter::putControl(duint32 handle, duint16 type, const std::vector<duint32> &entries, duint32 extra1, duint32 extra2){
+    dwgBufferW data(&encoder);
+    dwgBufferW hData;
+    data.putBitLong(0); //num reactors
+    data.putBitLong(entries.size());
+    if (type == 0x44)
+        data.putRawChar8(0);
+    hData.putHandle(softPtr, 0);
+    hData.putHandle(hardOwner, 0);
+    for (unsigned i = 0; i < entries.size(); ++i)
+        hData.putHandle(softOwner, entries.at(i));
+    if (extra1 != 0)
+        hData.putHandle(softOwner, extra1);
+    if (extra2 != 0)
+        hData.putHandle(softOwner, extra2);
+    addObject(handle, type, data, hData);
+}
+
+void dwgWriter::writeTables(){
+    std::vector<duint32> entries;
+    //line types
+    DRW_LType byBlock;
+    byBlock.name = "ByBlock";
+    DRW_LType byLayer;
+    byLayer.name = "ByLayer";
+    std::vector<tableEntry<DRW_LType> > allLt = ltypes;
+    allLt.push_back(tableEntry<DRW_LType>(byBlock, hByBlock));
+    allLt.push_back(tableEntry<DRW_LType>(byLayer, hByLayer));
+    for (unsigned i = 0; i < allLt.size(); ++i){
+        DRW_LType &lt = allLt.at(i).ent;
+        dwgBufferW data(&encoder);
+        dwgBufferW hData;
+        putTableCommon(lt, data, lt.flags);
+        data.putCP8Text(lt.desc);
+        double length = 0.0;
+        for (unsigned j = 0; j < lt.path.size(); ++j)
+            length += fabs(lt.path.at(j));
+        data.putBitDouble(length);
+        data.putRawChar8('A');
+        data.putRawChar8(lt.path.size());
+        for (unsigned j = 0; j < lt.path.size(); ++j){
+            data.putBitDouble(lt.path.at(j));
+            data.putBitShort(0); //complex shape code
+            data.putRawDouble(0.0); //x offset
+            data.putRawDouble(0.0); //y offset
+            data.putBitDouble(1.0); //scale
+            data.putBitDouble(0.0); //rotation
+            data.putBitShort(0); //shape flag
+        }
+        duint8 strArea[256] = {0};
+        data.putBytes(strArea, 256);
+        hData.putHandle(softPtr, hLTypeCtrl);
+        hData.putHandle(hardOwner, 0);
+        hData.putHandle(hardPtr, 0); //xref block
+        if (!lt.path.empty()){
+            for (unsigned j = 0; j < lt.path.size() || j < 2; ++j)
+                hData.putHandle(hardPtr, 0); //shape file
+        }
+        addObject(allLt.at(i).handle, 0x39, data, hData);
+        if (i < ltypes.size())
+            entries.push_back(allLt.at(i).handle);
+    }
+    putControl(hLTypeCtrl, 0x38, entries, hByBlock, hByLayer);
+
+    //layers
+    entries.clear();
+    for (unsigned i = 0; i < layers.size(); ++i){
+        DRW_Layer &lay = layers.at(i).ent;
+        dwgBufferW data(&encoder);
+        dwgBufferW hData;
+        data.putBitLong(0);
+        data.putCP8Text(lay.name);
+        data.putBit((lay.flags & 64) != 0);
+        data.putBitShort(0);
+        data.putBit((lay.flags & 16) != 0);
+        dint16 f = (lay.flags & 1) | ((lay.flags & 2) << 1) | ((lay.flags & 4) << 1);
+        if (lay.color < 0)
+            f |= 2; //layer off
+        if (lay.plotF)
+            f |= 16;
+        f |= (DRW_LW_Conv::lineWidth2dwgInt(lay.lWeight) & 0x1F) << 5;
+        data.putBitShort(f);
+        data.putCmColor(lay.color);
+        hData.putHandle(softPtr, hLayerCtrl);
+        hData.putHandle(hardOwner, 0);
+        hData.putHandle(hardPtr, 0); //xref block
+        hData.putHandle(hardPtr, 0); //plot style
+        hData.putHandle(hardPtr, findHandle(ltypeMap, lay.lineType, hContinuous));
+        addObject(layers.at(i).handle, 0x33, data, hData);
+        entries.push_back(layers.at(i).handle);
+    }
+    putControl(hLayerCtrl, 0x32, entries);
+
+    //text styles
+    entries.clear();
+    for (unsigned i = 0; i < styles.size(); ++i){
+        DRW_Textstyle &ts = styles.at(i).ent;
+        dwgBufferW data(&encoder);
+        dwgBufferW hData;
+        putTableCommon(ts, data, ts.flags);
+        data.putBit((ts.flags & 4) != 0);
+        data.putBit((ts.flags & 1) != 0);
+        data.putBitDouble(ts.height);
+        data.putBitDouble(ts.width);
+        data.putBitDouble(ts.oblique);
+        data.putRawChar8(ts.genFlag);
+        data.putBitDouble(ts.lastHeight);
+        data.putCP8Text(ts.font);
+        data.putCP8Text(ts.bigFont);
+        hData.putHandle(softPtr, hStyleCtrl);
+        hData.putHandle(hardOwner, 0);
+        hData.putHandle(hardPtr, 0);
+        addObject(styles.at(i).handle, 0x35, data, hData);
+        entries.push_back(styles.at(i).handle);
+    }
+    putControl(hStyleCtrl, 0x34, entries);
+
+    //views & ucs are always empty
+    entries.clear();
+    putControl(hViewCtrl, 0x3C, entries);
+    putControl(hUcsCtrl, 0x3E, entries);
+    putControl(hVpEntHdrCtrl, 0x46, entries);
+
+    //viewports
+    for (unsigned i = 0; i < vports.size(); ++i){
+        DRW_Vport &vp = vports.at(i).ent;
+        dwgBufferW data(&encoder);
+        dwgBufferW hData;
+        putTableCommon(vp, data, vp.flags);
+        data.putBitDouble(vp.height);
+        data.putBitDouble(vp.ratio);
+        data.put2RawDouble(vp.center);
+        data.put3BitDouble(vp.viewTarget);
+        data.put3BitDouble(vp.viewDir);
+        data.putBitDouble(vp.twistAngle);
+        data.putBitDouble(vp.lensHeight);
+        data.putBitDouble(vp.frontClip);
+        data.putBitDouble(vp.backClip);
+        data.putBit(vp.viewMode & 1);
+        data.putBit((vp.viewMode >> 1) & 1);
+        data.putBit((vp.viewMode >> 2) & 1);
+        data.putBit((vp.viewMode >> 4) & 1);
+        data.putRawChar8(0); //render mode
+        data.put2RawDouble(vp.lowerLeft);
+        data.put2RawDouble(vp.UpperRight);
+        data.putBit((vp.viewMode >> 3) & 1);
+        data.putBitShort(vp.circleZoom);
+        data.putBit(vp.fastZoom != 0);
+        data.putBit(vp.ucsIcon & 1);
+        data.putBit((vp.ucsIcon >> 1) & 1);
+        data.putBit(vp.grid != 0);
+        data.put2RawDouble(vp.gridSpacing);
+        data.putBit(vp.snap != 0);
+        data.putBit(vp.snapStyle != 0);
+        data.putBitShort(vp.snapIsopair);
+        data.putBitDouble(vp.snapAngle);
+        data.put2RawDouble(vp.snapBase);
+        data.put2RawDouble(vp.snapSpacing);
+        data.putBit(0);
+        data.putBit(0); //ucs per viewport
+        data.put3BitDouble(DRW_Coord(0.0, 0.0, 0.0));
+        data.put3BitDouble(DRW_Coord(1.0, 0.0, 0.0));
+        data.put3BitDouble(DRW_Coord(0.0, 1.0, 0.0));
+        data.putBitDouble(0.0); //ucs elevation
+        data.putBitShort(0); //ucs orthographic type
+        hData.putHandle(softPtr, hVportCtrl);
+        hData.putHandle(hardOwner, 0);
+        hData.putHandle(hardPtr, 0); //xref block
+        hData.putHandle(hardPtr, 0); //named ucs
+        hData.putHandle(hardPtr, 0); //base ucs
+        addObject(vports.at(i).handle, 0x41, data, hData);
+        entries.push_back(vports.at(i).handle);
+    }
+    putControl(hVportCtrl, 0x40, entries);
+
+    //application ids
+    entries.clear();
+    for (unsigned i = 0; i < appIds.size(); ++i){
+        DRW_AppId &ai = appIds.at(i).ent;
+        dwgBufferW data(&encoder);
+        dwgBufferW hData;
+        putTableCommon(ai, data, ai.flags);
+        data.putRawChar8(0);
+        hData.putHandle(softPtr, hAppIdCtrl);
+        hData.putHandle(hardOwner, 0);
+        hData.putHandle(hardPtr, 0);
+        addObject(appIds.at(i).handle, 0x43, data, hData);
+        entries.push_back(appIds.at(i).handle);
+    }
+    putControl(hAppIdCtrl, 0x42, entries);
+
+    //dimension styles
+    entries.clear();
+    for (unsigned i = 0; i < dimstyles.size(); ++i){
+        DRW_Dimstyle &ds = dimstyles.at(i).ent;
+        dwgBufferW data(&encoder);
+        dwgBufferW hData;
+        putTableCommon(ds, data, ds.flags);
+        data.putCP8Text(ds.dimpost);
+        data.putCP8Text(ds.dimapost);
+        data.putBitDouble(ds.dimscale);
+        data.putBitDouble(ds.dimasz);
+        data.putBitDouble(ds.dimexo);
+        data.putBitDouble(ds.dimdli);
+        data.putBitDouble(ds.dimexe);
+        data.putBitDouble(ds.dimrnd);
+        data.putBitDouble(ds.dimdle);
+        data.putBitDouble(ds.dimtp);
+        data.putBitDouble(ds.dimtm);
+        data.putBit(ds.dimtol != 0);
+        data.putBit(ds.dimlim != 0);
+        data.putBit(ds.dimtih != 0);
+        data.putBit(ds.dimtoh != 0);
+        data.putBit(ds.dimse1 != 0);
+        data.putBit(ds.dimse2 != 0);
+        data.putBitShort(ds.dimtad);
+        data.putBitShort(ds.dimzin);
+        data.putBitShort(ds.dimazin);
+        data.putBitDouble(ds.dimtxt);
+        data.putBitDouble(ds.dimcen);
+        data.putBitDouble(ds.dimtsz);
+        data.putBitDouble(ds.dimaltf);
+        data.putBitDouble(ds.dimlfac);
+        data.putBitDouble(ds.dimtvp);
+        data.putBitDouble(ds.dimtfac);
+        data.putBitDouble(ds.dimgap);
+        data.putBitDouble(ds.dimaltrnd);
+        data.putBit(ds.dimalt != 0);
+        data.putBitShort(ds.dimaltd);
+        data.putBit(ds.dimtofl != 0);
+        data.putBit(ds.dimsah != 0);
+        data.putBit(ds.dimtix != 0);
+        data.putBit(ds.dimsoxd != 0);
+        data.putBitShort(ds.dimclrd);
+        data.putBitShort(ds.dimclre);
+        data.putBitShort(ds.dimclrt);
+        data.putBitShort(ds.dimadec);
+        data.putBitShort(ds.dimdec);
+        data.putBitShort(ds.dimtdec);
+        data.putBitShort(ds.dimaltu);
+        data.putBitShort(ds.dimalttd);
+        data.putBitShort(ds.dimaunit);
+        data.putBitShort(ds.dimfrac);
+        data.putBitShort(ds.dimlunit);
+        data.putBitShort(ds.dimdsep);
+        data.putBitShort(ds.dimtmove);
+        data.putBitShort(ds.dimjust);
+        data.putBit(ds.dimsd1 != 0);
+        data.putBit(ds.dimsd2 != 0);
+        data.putBitShort(ds.dimtolj);
+        data.putBitShort(ds.dimtzin);
+        data.putBitShort(ds.dimaltz);
+        data.putBitShort(ds.dimaltttz);
+        data.putBit(ds.dimupt != 0);
+        data.putBitShort(ds.dimatfit);
+        data.putBitShort(ds.dimlwd);
+        data.putBitShort(ds.dimlwe);
+        data.putBit(0);
+        hData.putHandle(softPtr, hDimstyleCtrl);
+        hData.putHandle(hardOwner, 0);
+        hData.putHandle(hardPtr, 0); //xref block
+        hData.putHandle(hardPtr, findHandle(styleMap, ds.dimtxsty, styleMap["STANDARD"]));
+        hData.putHandle(hardPtr, 0); //DIMLDRBLK
+        hData.putHandle(hardPtr, 0); //DIMBLK
+        hData.putHandle(hardPtr, 0); //DIMBLK1
+        hData.putHandle(hardPtr, 0); //DIMBLK2
+        addObject(dimstyles.at(i).handle, 0x45, data, hData);
+        entries.push_back(dimstyles.at(i).handle);
+    }
+    putControl(hDimstyleCtrl, 0x44, entries);
+
+    //block records, model & paper space BLOCK/ENDBLK are written here
+    putBlockEnt(hModelSpace+1, hModelSpace, modelSpace.name, false);
+    putBlockEnt(hModelSpace+2, hModelSpace, modelSpace.name, true);
+    putBlockEnt(hPaperSpace+1, hPaperSpace, paperSpace.name, false);
+    putBlockEnt(hPaperSpace+2, hPaperSpace, paperSpace.name, true);
+    entries.clear();
+    std::list<blockRecordW> allBr = blockRecords;
+    allBr.push_back(modelSpace);
+    allBr.push_back(paperSpace);
+    for (std::list<blockRecordW>::iterator it = allBr.begin(); it != allBr.end(); ++it){
+        blockRecordW &br = *it;
+        dwgBufferW data(&encoder);
+        dwgBufferW hData;
+        data.putBitLong(0);
+        data.putCP8Text(br.name);
+        data.putBit(0);
+        data.putBitShort(0);
+        data.putBit(0);
+        data.putBit((br.flags & 1) != 0); //anonymous
+        data.putBit((br.flags & 2) != 0); //has attdefs
+        data.putBit(0); //is xref
+        data.putBit(0); //is overlaid xref
+        data.putBit(0); //is loaded xref
+        data.put3BitDouble(br.basePoint);
+        data.putCP8Text(std::string()); //xref path
+        data.putRawChar8(0); //end of inserts count
+        data.putCP8Text(std::string()); //description
+        data.putBitLong(0); //preview data size
+        hData.putHandle(softPtr, hBlockCtrl);
+        hData.putHandle(hardOwner, 0);
+        hData.putHandle(hardPtr, 0); //null handle
+        hData.putHandle(softOwner, br.handle+1); //BLOCK
+        hData.putHandle(softPtr, br.firstEH);
+        hData.putHandle(softPtr, br.lastEH);
+        hData.putHandle(softOwner, br.handle+2); //ENDBLK
+        hData.putHandle(hardPtr, 0); //layout
+        addObject(br.handle, 0x31, data, hData);
+        if (br.handle != hModelSpace && br.handle != hPaperSpace)
+            entries.push_back(br.handle);
+    }
+    putControl(hBlockCtrl, 0x30, entries, hModelSpace, hPaperSpace);
+}
+
+/**
+ * Writes the named objects dictionary, with empty ACAD_GROUP &
+ * ACAD_MLINESTYLE dictionaries.
+ */
+void dwgWriter::writeDictionaries(){
+    const duint32 dicts[] = {hNamedObjDict, hGroupDict, hMLineStyleDict};
+    for (int i = 0; i < 3; ++i){
+        dwgBufferW data(&encoder);
+        dwgBufferW hData;
+        data.putBitLong(0); //num reactors
+        data.putBitLong(dicts[i] == hNamedObjDict ? 2 : 0);
+        data.putBitShort(1); //cloning flag
+        data.putRawChar8(0); //hard owner flag
+        if (dicts[i] == hNamedObjDict){
+            data.putCP8Text("ACAD_GROUP");
+            data.putCP8Text("ACAD_MLINESTYLE");
+        }
+        hData.putHandle(softPtr, dicts[i] == hNamedObjDict ? 0 : hNamedObjDict);
+        hData.putHandle(hardOwner, 0);
+        if (dicts[i] == hNamedObjDict){
+            hData.putHandle(softOwner, hGroupDict);
+            hData.putHandle(softOwner, hMLineStyleDict);
+        }
+        addObject(dicts[i], 42, data, hData);
+    }
+}
+
+DRW_Variant *dwgWriter::findVar(const std::string &key){
+    std::map<std::string,DRW_Variant*>::iterator it = header.vars.find("$" + key);
+    if (it == header.vars.end())
+        it = header.vars.find(key);
+    if (it == header.vars.end())
+        return NULL;
+    return it->second;
+}
+
+int dwgWriter::getHdrInt(const std::string &key, int def){
+    DRW_Variant *v = findVar(key);
+    if (v == NULL)
+        return def;
+    if (v->type() == DRW_Variant::INTEGER)
+        return v->content.i;
+    if (v->type() == DRW_Variant::DOUBLE)
+        return static_cast<int>(v->content.d);
+    return def;
+}
+
+double dwgWriter::getHdrDouble(const std::string &key, double def){
+    DRW_Variant *v = findVar(key);
+    if (v == NULL)
+        return def;
+    if (v->type() == DRW_Variant::DOUBLE)
+        return v->content.d;
+    if (v->type() == DRW_Variant::INTEGER)
+        return v->content.i;
+    return def;
+}
+
+DRW_Coord dwgWriter::getHdrCoord(const std::string &key, const DRW_Coord &def){
+    DRW_Variant *v = findVar(key);
+    if (v == NULL || v->type() != DRW_Variant::COORD)
+        return def;
+    return *v->content.v;
+}
+
+std::string dwgWriter::getHdrStr(const std::string &key, const std::string &def){
+    DRW_Variant *v = findVar(key);
+    if (v == NULL || v->type() != DRW_Variant::STRING)
+        return def;
+    return *v->content.s;
+}
+
+/**
+ * Writes the header variables in R2000 order, see DRW_Header::parseDwg,
+ * data and handles share the same stream.
+ */
+void dwgWriter::writeDwgHeader(dwgBufferW &buf){
+    const DRW_Coord zero(0.0, 0.0, 0.0);
+    buf.putBitDouble(412148564080.0);
+    buf.putBitDouble(1.0);
+    buf.putBitDouble(1.0);
+    buf.putBitDouble(1.0);
+    buf.putCP8Text("");
+    buf.putCP8Text("");
+    buf.putCP8Text("");
+    buf.putCP8Text("");
+    buf.putBitLong(24);
+    buf.putBitLong(0);
+    buf.putHandle(hardPtr, 0); //current viewport entity header
+    buf.putBit(getHdrInt("DIMASO", 1));
+    buf.putBit(getHdrInt("DIMSHO", 1));
+    buf.putBit(getHdrInt("PLINEGEN", 0));
+    buf.putBit(getHdrInt("ORTHOMODE", 0));
+    buf.putBit(getHdrInt("REGENMODE", 1));
+    buf.putBit(getHdrInt("FILLMODE", 1));
+    buf.putBit(getHdrInt("QTEXTMODE", 0));
+    buf.putBit(getHdrInt("PSLTSCALE", 1));
+    buf.putBit(getHdrInt("LIMCHECK", 0));
+    buf.putBit(getHdrInt("USRTIMER", 1));
+    buf.putBit(getHdrInt("SKPOLY", 0));
+    buf.putBit(getHdrInt("ANGDIR", 0));
+    buf.putBit(getHdrInt("SPLFRAME", 0));
+    buf.putBit(getHdrInt("MIRRTEXT", 0));
+    buf.putBit(getHdrInt("WORLDVIEW", 1));
+    buf.putBit(getHdrInt("TILEMODE", 1));
+    buf.putBit(getHdrInt("PLIMCHECK", 0));
+    buf.putBit(getHdrInt("VISRETAIN", 1));
+    buf.putBit(getHdrInt("DISPSILH", 0));
+    buf.putBit(getHdrInt("PELLIPSE", 0));
+    buf.putBitShort(getHdrInt("PROXIGRAPHICS", 1));
+    buf.putBitShort(getHdrInt("TREEDEPTH", 3020));
+    buf.putBitShort(getHdrInt("LUNITS", 2));
+    buf.putBitShort(getHdrInt("LUPREC", 4));
+    buf.putBitShort(getHdrInt("AUNITS", 0));
+    buf.putBitShort(getHdrInt("AUPREC", 0));
+    buf.putBitShort(getHdrInt("ATTMODE", 1));
+    buf.putBitShort(getHdrInt("PDMODE", 0));
+    buf.putBitShort(getHdrInt("USERI1", 0));
+    buf.putBitShort(getHdrInt("USERI2", 0));
+    buf.putBitShort(getHdrInt("USERI3", 0));
+    buf.putBitShort(getHdrInt("USERI4", 0));
+    buf.putBitShort(getHdrInt("USERI5", 0));
+    buf.putBitShort(getHdrInt("SPLINESEGS", 8));
+    buf.putBitShort(getHdrInt("SURFU", 6));
+    buf.putBitShort(getHdrInt("SURFV", 6));
+    buf.putBitShort(getHdrInt("SURFTYPE", 6));
+    buf.putBitShort(getHdrInt("SURFTAB1", 6));
+    buf.putBitShort(getHdrInt("SURFTAB2", 6));
+    buf.putBitShort(getHdrInt("SPLINETYPE", 6));
+    buf.putBitShort(getHdrInt("SHADEDGE", 3));
+    buf.putBitShort(getHdrInt("SHADEDIF", 70));
+    buf.putBitShort(getHdrInt("UNITMODE", 0));
+    buf.putBitShort(getHdrInt("MAXACTVP", 64));
+    buf.putBitShort(getHdrInt("ISOLINES", 4));
+    buf.putBitShort(getHdrInt("CMLJUST", 0));
+    buf.putBitShort(getHdrInt("TEXTQLTY", 50));
+    buf.putBitDouble(getHdrDouble("LTSCALE", 1.0));
+    buf.putBitDouble(getHdrDouble("TEXTSIZE", 2.5));
+    buf.putBitDouble(getHdrDouble("TRACEWID", 1.0));
+    buf.putBitDouble(getHdrDouble("SKETCHINC", 1.0));
+    buf.putBitDouble(getHdrDouble("FILLETRAD", 0.0));
+    buf.putBitDouble(getHdrDouble("THICKNESS", 0.0));
+    buf.putBitDouble(getHdrDouble("ANGBASE", 0.0));
+    buf.putBitDouble(getHdrDouble("PDSIZE", 0.0));
+    buf.putBitDouble(getHdrDouble("PLINEWID", 0.0));
+    buf.putBitDouble(getHdrDouble("USERR1", 0.0));
+    buf.putBitDouble(getHdrDouble("USERR2", 0.0));
+    buf.putBitDouble(getHdrDouble("USERR3", 0.0));
+    buf.putBitDouble(getHdrDouble("USERR4", 0.0));
+    buf.putBitDouble(getHdrDouble("USERR5", 0.0));
+    buf.putBitDouble(getHdrDouble("CHAMFERA", 0.0));
+    buf.putBitDouble(getHdrDouble("CHAMFERB", 0.0));
+    buf.putBitDouble(getHdrDouble("CHAMFERC", 0.0));
+    buf.putBitDouble(getHdrDouble("CHAMFERD", 0.0));
+    buf.putBitDouble(getHdrDouble("FACETRES", 0.5));
+    buf.putBitDouble(getHdrDouble("CMLSCALE", 1.0));
+    buf.putBitDouble(getHdrDouble("CELTSCALE", 1.0));
+    buf.putCP8Text(getHdrStr("MENU", "acad"));
+    //julian date, days & milliseconds
+    time_t now = time(NULL);
+    dint32 day = 2440588 + static_cast<dint32>(now / 86400);
+    dint32 msec = static_cast<dint32>((now % 86400) * 1000);
+    buf.putBitLong(day);  //TDCREATE
+    buf.putBitLong(msec);
+    buf.putBitLong(day);  //TDUPDATE
+    buf.putBitLong(msec);
+    buf.putBitLong(0);  //TDINDWG
+    buf.putBitLong(0);
+    buf.putBitLong(0);  //TDUSRTIMER
+    buf.putBitLong(0);
+    buf.putCmColor(getHdrInt("CECOLOR", 256));
+    buf.putHandle(0, nextHandle); //HANDSEED
+    buf.putHandle(hardPtr, findHandle(layerMap, getHdrStr("CLAYER", "0"), layerMap["0"]));
+    buf.putHandle(hardPtr, findHandle(styleMap, getHdrStr("TEXTSTYLE", "STANDARD"), styleMap["STANDARD"]));
+    buf.putHandle(hardPtr, findHandle(ltypeMap, getHdrStr("CELTYPE", "BYLAYER"), hByLayer));
+    buf.putHandle(hardPtr, findHandle(dimstyleMap, getHdrStr("DIMSTYLE", "STANDARD"), dimstyleMap["STANDARD"]));
+    buf.putHandle(hardPtr, 0); //CMLSTYLE
+    //paper space
+    buf.putBitDouble(getHdrDouble("PSVPSCALE", 0.0));
+    buf.put3BitDouble(getHdrCoord("PINSBASE", zero));
+    buf.put3BitDouble(getHdrCoord("PEXTMIN", zero));
+    buf.put3BitDouble(getHdrCoord("PEXTMAX", zero));
+    buf.put2RawDouble(getHdrCoord("PLIMMIN", zero));
+    buf.put2RawDouble(getHdrCoord("PLIMMAX", DRW_Coord(420.0, 297.0, 0.0)));
+    buf.putBitDouble(getHdrDouble("PELEVATION", 0.0));
+    buf.put3BitDouble(getHdrCoord("PUCSORG", zero));
+    buf.put3BitDouble(getHdrCoord("PUCSXDIR", DRW_Coord(1.0, 0.0, 0.0)));
+    buf.put3BitDouble(getHdrCoord("PUCSYDIR", DRW_Coord(0.0, 1.0, 0.0)));
+    buf.putHandle(hardPtr, 0); //PUCSNAME
+    buf.putHandle(hardPtr, 0); //PUCSORTHOREF
+    buf.putBitShort(getHdrInt("PUCSORTHOVIEW", 0));
+    buf.putHandle(hardPtr, 0); //PUCSBASE
+    for (int i = 0; i < 6; ++i)
+        buf.put3BitDouble(zero); //PUCSORGTOP...PUCSORGBACK
+    //model space
+    buf.put3BitDouble(getHdrCoord("INSBASE", zero));
+    buf.put3BitDouble(getHdrCoord("EXTMIN", zero));
+    buf.put3BitDouble(getHdrCoord("EXTMAX", zero));
+    buf.put2RawDouble(getHdrCoord("LIMMIN", zero));
+    buf.put2RawDouble(getHdrCoord("LIMMAX", DRW_Coord(420.0, 297.0, 0.0)));
+    buf.putBitDouble(getHdrDouble("ELEVATION", 0.0));
+    buf.put3BitDouble(getHdrCoord("UCSORG", zero));
+    buf.put3BitDouble(getHdrCoord("UCSXDIR", DRW_Coord(1.0, 0.0, 0.0)));
+    buf.put3BitDouble(getHdrCoord("UCSYDIR", DRW_Coord(0.0, 1.0, 0.0)));
+    buf.putHandle(hardPtr, 0); //UCSNAME
+    buf.putHandle(hardPtr, 0); //UCSORTHOREF
+    buf.putBitShort(getHdrInt("UCSORTHOVIEW", 0));
+    buf.putHandle(hardPtr, 0); //UCSBASE
+    for (int i = 0; i < 6; ++i)
+        buf.put3BitDouble(zero); //UCSORGTOP...UCSORGBACK
+    //dimension vars
+    buf.putCP8Text(getHdrStr("DIMPOST", ""));
+    buf.putCP8Text(getHdrStr("DIMAPOST", ""));
+    buf.putBitDouble(getHdrDouble("DIMSCALE", 1.0));
+    buf.putBitDouble(getHdrDouble("DIMASZ", 2.5));
+    buf.putBitDouble(getHdrDouble("DIMEXO", 0.625));
+    buf.putBitDouble(getHdrDouble("DIMDLI", 3.75));
+    buf.putBitDouble(getHdrDouble("DIMEXE", 1.25));
+    buf.putBitDouble(getHdrDouble("DIMRND", 0.0));
+    buf.putBitDouble(getHdrDouble("DIMDLE", 0.0));
+    buf.putBitDouble(getHdrDouble("DIMTP", 0.0));
+    buf.putBitDouble(getHdrDouble("DIMTM", 0.0));
+    buf.putBit(getHdrInt("DIMTOL", 0));
+    buf.putBit(getHdrInt("DIMLIM", 0));
+    buf.putBit(getHdrInt("DIMTIH", 0));
+    buf.putBit(getHdrInt("DIMTOH", 0));
+    buf.putBit(getHdrInt("DIMSE1", 0));
+    buf.putBit(getHdrInt("DIMSE2", 0));
+    buf.putBitShort(getHdrInt("DIMTAD", 1));
+    buf.putBitShort(getHdrInt("DIMZIN", 8));
+    buf.putBitShort(getHdrInt("DIMAZIN", 0));
+    buf.putBitDouble(getHdrDouble("DIMTXT", 2.5));
+    buf.putBitDouble(getHdrDouble("DIMCEN", 2.5));
+    buf.putBitDouble(getHdrDouble("DIMTSZ", 0.0));
+    buf.putBitDouble(getHdrDouble("DIMALTF", 25.4));
+    buf.putBitDouble(getHdrDouble("DIMLFAC", 1.0));
+    buf.putBitDouble(getHdrDouble("DIMTVP", 0.0));
+    buf.putBitDouble(getHdrDouble("DIMTFAC", 1.0));
+    buf.putBitDouble(getHdrDouble("DIMGAP", 0.625));
+    buf.putBitDouble(getHdrDouble("DIMALTRND", 0.0));
+    buf.putBit(getHdrInt("DIMALT", 0));
+    buf.putBitShort(getHdrInt("DIMALTD", 2));
+    buf.putBit(getHdrInt("DIMTOFL", 1));
+    buf.putBit(getHdrInt("DIMSAH", 0));
+    buf.putBit(getHdrInt("DIMTIX", 0));
+    buf.putBit(getHdrInt("DIMSOXD", 0));
+    buf.putCmColor(getHdrInt("DIMCLRD", 0));
+    buf.putCmColor(getHdrInt("DIMCLRE", 0));
+    buf.putCmColor(getHdrInt("DIMCLRT", 0));
+    buf.putBitShort(getHdrInt("DIMADEC", 0));
+    buf.putBitShort(getHdrInt("DIMDEC", 2));
+    buf.putBitShort(getHdrInt("DIMTDEC", 2));
+    buf.putBitShort(getHdrInt("DIMALTU", 2));
+    buf.putBitShort(getHdrInt("DIMALTTD", 2));
+    buf.putBitShort(getHdrInt("DIMAUNIT", 0));
+    buf.putBitShort(getHdrInt("DIMFRAC", 0));
+    buf.putBitShort(getHdrInt("DIMLUNIT", 2));
+    buf.putBitShort(getHdrInt("DIMDSEP", '.'));
+    buf.putBitShort(getHdrInt("DIMTMOVE", 0));
+    buf.putBitShort(getHdrInt("DIMJUST", 0));
+    buf.putBit(getHdrInt("DIMSD1", 0));
+    buf.putBit(getHdrInt("DIMSD2", 0));
+    buf.putBitShort(getHdrInt("DIMTOLJ", 0));
+    buf.putBitShort(getHdrInt("DIMTZIN", 8));
+    buf.putBitShort(getHdrInt("DIMALTZ", 0));
+    buf.putBitShort(getHdrInt("DIMALTTZ", 0));
+    buf.putBit(getHdrInt("DIMUPT", 0));
+    buf.putBitShort(getHdrInt("DIMATFIT", 3));
+    buf.putHandle(hardPtr, styleMap["STANDARD"]); //DIMTXSTY
+    buf.putHandle(hardPtr, 0); //DIMLDRBLK
+    buf.putHandle(hardPtr, 0); //DIMBLK
+    buf.putHandle(hardPtr, 0); //DIMBLK1
+    buf.putHandle(hardPtr, 0); //DIMBLK2
+    buf.putBitShort(getHdrInt("DIMLWD", -2));
+    buf.putBitShort(getHdrInt("DIMLWE", -2));
+    //table controls
+    buf.putHandle(hardOwner, hBlockCtrl);
+    buf.putHandle(hardOwner, hLayerCtrl);
+    buf.putHandle(hardOwner, hStyleCtrl);
+    buf.putHandle(hardOwner, hLTypeCtrl);
+    buf.putHandle(hardOwner, hViewCtrl);
+    buf.putHandle(hardOwner, hUcsCtrl);
+    buf.putHandle(hardOwner, hVportCtrl);
+    buf.putHandle(hardOwner, hAppIdCtrl);
+    buf.putHandle(hardOwner, hDimstyleCtrl);
+    buf.putHandle(hardOwner, hVpEntHdrCtrl);
+    buf.putHandle(hardPtr, hGroupDict);
+    buf.putHandle(hardPtr, hMLineStyleDict);
+    buf.putHandle(hardPtr, hNamedObjDict);
+    buf.putBitShort(getHdrInt("TSTACKALIGN", 1));
+    buf.putBitShort(getHdrInt("TSTACKSIZE", 70));
+    buf.putCP8Text(getHdrStr("HYPERLINKBASE", ""));
+    buf.putCP8Text(getHdrStr("STYLESHEET", ""));
+    buf.putHandle(hardPtr, 0); //layouts dictionary
+    buf.putHandle(hardPtr, 0); //plot settings dictionary
+    buf.putHandle(hardPtr, 0); //plot styles dictionary
+    //flags: CELWEIGHT bylayer (0x1F) plus LWDISPLAY & XEDIT
+    buf.putBitLong(0x1F | 0x0200 | 0x0400);
+    buf.putBitShort(getHdrInt("INSUNITS", 0));
+    buf.putBitShort(0); //CEPSNTYPE by layer
+    buf.putCP8Text(getHdrStr("FINGERPRINTGUID", ""));
+    buf.putCP8Text(getHdrStr("VERSIONGUID", ""));
+    buf.putHandle(hardPtr, hPaperSpace);
+    buf.putHandle(hardPtr, hModelSpace);
+    buf.putHandle(hardPtr, hByLayer);
+    buf.putHandle(hardPtr, hByBlock);
+    buf.putHandle(hardPtr, hContinuous);
+    buf.putBitShort(0);
+    buf.putBitShort(0);
+    buf.putBitShort(0);
+    buf.putBitShort(0);
+}
+
+/**
+ * Writes the classes of the objects without fixed type number
+ * used by this writer.
+ */
+void dwgWriter::writeDwgClasses(dwgBufferW &buf){
+    const char *cppNames[] = {"AcDbPolyline", "AcDbHatch"};
+    const char *dxfNames[] = {"LWPOLYLINE", "HATCH"};
+    const duint16 nums[] = {lwPolylineClass, hatchClass};
+    for (int i = 0; i < 2; ++i){
+        buf.putBitShort(nums[i]);
+        buf.putBitShort(0); //proxy flags
+        buf.putCP8Text("ObjectDBX Classes");
+        buf.putCP8Text(cppNames[i]);
+        buf.putCP8Text(dxfNames[i]);
+        buf.putBit(0); //was a zombie
+        buf.putBitShort(0x1F2); //is an entity
+    }
+}
+
+/**
+ * Writes the object map, handles & offsets are delta encoded and
+ * restarted in each section of at most 2032 bytes.
+ */
+void dwgWriter::writeDwgHandles(dwgBufferW &buf, duint32 offset){
+    std::map<duint32, std::vector<duint8> >::iterator it = objects.begin();
+    while (it != objects.end()){
+        dwgBufferW chunk;
+        duint32 lastHandle = 0;
+        dint32 lastLoc = 0;
+        while (it != objects.end() && chunk.size() < 2020){
+            chunk.putUModularChar(it->first - lastHandle);
+            chunk.putModularChar(static_cast<dint32>(offset) - lastLoc);
+            lastHandle = it->first;
+            lastLoc = offset;
+            offset += it->second.size();
+            ++it;
+        }
+        dwgBufferW sect;
+        sect.putBERawShort16(chunk.size() + 2);
+        sect.putBytes(chunk.data(), chunk.size());
+        buf.putBytes(sect.data(), sect.size());
+        buf.putBERawShort16(dwgBufferW::crc8(0xC0C1, sect.data(), sect.size()));
+    }
+    //last empty section
+    dwgBufferW sect;
+    sect.putBERawShort16(2);
+    buf.putBytes(sect.data(), sect.size());
+    buf.putBERawShort16(dwgBufferW::crc8(0xC0C1, sect.data(), sect.size()));
+}
+
+bool dwgWriter::writeFile(){
+    addDefaults();
+    currBlock = NULL;
+    writeTables();
+    writeDictionaries();
+
+    dwgBufferW hdrData(&encoder);
+    writeDwgHeader(hdrData);
+    dwgBufferW hdrSect;
+    putSection(hdrSect, headerSentinel, hdrData);
+    dwgBufferW clsData(&encoder);
+    writeDwgClasses(clsData);
+    dwgBufferW clsSect;
+    putSection(clsSect, classesSentinel, clsData);
+
+    //file header with 3 section locators: header, classes & object map
+    const duint32 fileHeaderSize = 25 + 3*9 + 2 + 16;
+    duint32 hdrAddr = fileHeaderSize;
+    duint32 clsAddr = hdrAddr + hdrSect.size();
+    duint32 objAddr = clsAddr + clsSect.size();
+    duint32 objSize = 0;
+    for (std::map<duint32, std::vector<duint8> >::iterator it = objects.begin(); it != objects.end(); ++it)
+        objSize += it->second.size();
+    dwgBufferW mapSect;
+    writeDwgHandles(mapSect, objAddr);
+    duint32 mapAddr = objAddr + objSize;
+    duint32 imgAddr = mapAddr + mapSect.size();
+
+    dwgBufferW fh;
+    const char *ver = "AC1015";
+    fh.putBytes(reinterpret_cast<const duint8*>(ver), 6);
+    for (int i = 0; i < 5; ++i)
+        fh.putRawChar8(0);
+    fh.putRawChar8(0x0F); //maintenance version
+    fh.putRawChar8(0x01);
+    fh.putRawLong32(imgAddr);
+    fh.putRawShort16(getHdrInt("MEASUREMENT", 1));
+    fh.putRawShort16(30); //ANSI_1252
+    fh.putRawLong32(3);
+    fh.putRawChar8(0);
+    fh.putRawLong32(hdrAddr);
+    fh.putRawLong32(hdrSect.size());
+    fh.putRawChar8(1);
+    fh.putRawLong32(clsAddr);
+    fh.putRawLong32(clsSect.size());
+    fh.putRawChar8(2);
+    fh.putRawLong32(mapAddr);
+    fh.putRawLong32(mapSect.size());
+    fh.putRawShort16(dwgBufferW::crc8(0, fh.data(), fh.size()) ^ 0xA598);
+    fh.putBytes(fileHeaderSentinel, 16);
+
+    //empty preview image
+    dwgBufferW img;
+    img.putBytes(imageSentinel, 16);
+    img.putRawLong32(1);
+    img.putRawChar8(0);
+    for (int i = 0; i < 16; ++i)
+        img.putRawChar8(~imageSentinel[i]);
+
+    fileStr->write(reinterpret_cast<const char*>(fh.data()), fh.size());
+    fileStr->write(reinterpret_cast<const char*>(hdrSect.data()), hdrSect.size());
+    fileStr->write(reinterpret_cast<const char*>(clsSect.data()), clsSect.size());
+    for (std::map<duint32, std::vector<duint8> >::iterator it = objects.begin(); it != objects.end(); ++it)
+        fileStr->write(reinterpret_cast<const char*>(it->second.data()), it->second.size());
+    fileStr->write(reinterpret_cast<const char*>(mapSect.data()), mapSect.size());
+    fileStr->write(reinterpret_cast<const char*>(img.data()), img.size());
+    return fileStr->good();
+}
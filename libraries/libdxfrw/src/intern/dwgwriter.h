@@ -0,0 +1,146 @@
+/******************************************************************************
+**  libDXFrw - Library to read/write DXF files (ascii & binary)              **
+**                                                                           **
+**  Copyright (C) 2011-2015 José F. Soriano, rallazz@gmail.com               **
+**                                                                           **
+**  This library is free software, licensed under the terms of the GNU       **
+**  General Public License as published by the Free Software Foundation,     **
+**  either version 2 of the License, or (at your option) any later version.  **
+**  You should have received a copy of the GNU General Public License        **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
+******************************************************************************/
+
+#ifndef DWGWRITER_H
+#define DWGWRITER_H
+
+#include <map>
+#include <list>
+#include <vector>
+#include "drw_textcodec.h"
+#include "dwgbuffer.h"
+#include "../drw_entities.h"
+#include "../drw_objects.h"
+#include "../drw_header.h"
+
+//! Class to write R2000 dwg files
+/*!
+*  Counterpart of dwgReader15. Table entries are stored until the end
+*  because block records and controls need the complete list of entries,
+*  entities are encoded as soon as they are received. The file is
+*  assembled in writeFile() with the same section layout read by
+*  dwgReader15: file header, header vars, classes, objects, object map
+*  and an empty preview image.
+*  Entities are written without prev/next links, the handles of the
+*  entities of a block must be consecutive, entities are numbered in
+*  the order they are received.
+*/
+class dwgWriter {
+public:
+    dwgWriter(std::ofstream *stream);
+    ~dwgWriter();
+
+    void setHeader(const DRW_Header &h){header = h;}
+
+    void addLType(const DRW_LType &ent);
+    void addLayer(const DRW_Layer &ent);
+    void addTextstyle(const DRW_Textstyle &ent);
+    void addDimstyle(const DRW_Dimstyle &ent);
+    void addVport(const DRW_Vport &ent);
+    void addAppId(const DRW_AppId &ent);
+    void addBlockRecord(const std::string &name);
+
+    bool writeBlock(DRW_Block *ent);
+    void endBlocks();
+    bool writePoint(DRW_Point *ent);
+    bool writeLine(DRW_Line *ent);
+    bool writeRay(DRW_Ray *ent);
+    bool writeXline(DRW_Xline *ent);
+    bool writeCircle(DRW_Circle *ent);
+    bool writeArc(DRW_Arc *ent);
+    bool writeEllipse(DRW_Ellipse *ent);
+    bool writeTrace(DRW_Trace *ent);
+    bool writeSolid(DRW_Solid *ent);
+    bool write3dface(DRW_3Dface *ent);
+    bool writeLWPolyline(DRW_LWPolyline *ent);
+    bool writePolyline(DRW_Polyline *ent);
+    bool writeSpline(DRW_Spline *ent);
+    bool writeInsert(DRW_Insert *ent);
+    bool writeText(DRW_Text *ent);
+    bool writeMText(DRW_MText *ent);
+    bool writeHatch(DRW_Hatch *ent);
+    bool writeDimension(DRW_Dimension *ent);
+
+    bool writeFile();
+
+private:
+    //! Table entry and its assigned handle
+    template <class T> class tableEntry {
+    public:
+        tableEntry(const T &e, duint32 h): ent(e), handle(h) {}
+        T ent;
+        duint32 handle;
+    };
+    //! Block record with the handles of its content
+    class blockRecordW {
+    public:
+        blockRecordW(): handle(0), firstEH(0), lastEH(0), flags(0) {}
+        std::string name;
+        duint32 handle;  //block record, BLOCK is handle+1 and ENDBLK handle+2
+        duint32 firstEH;
+        duint32 lastEH;
+        int flags;
+        DRW_Coord basePoint;
+    };
+
+    void addDefaults();
+    duint32 findHandle(const std::map<std::string, duint32> &m, const std::string &name, duint32 def);
+    static std::string toUpper(const std::string &s);
+
+    void addObject(duint32 handle, duint16 type, const dwgBufferW &data, const dwgBufferW &hData);
+    duint32 beginEntity(DRW_Entity *ent, dwgBufferW &data);
+    void putEntityHandles(DRW_Entity *ent, dwgBufferW &hData);
+    void endEntity(DRW_Entity *ent, duint16 type, const dwgBufferW &data, dwgBufferW &hData);
+    void putTableCommon(const DRW_TableEntry &ent, dwgBufferW &data, int flags);
+    void putControl(duint32 handle, duint16 type, const std::vector<duint32> &entries, duint32 extra1 = 0, duint32 extra2 = 0);
+    void putBlockEnt(duint32 handle, duint32 owner, const std::string &name, bool isEnd);
+    void putDimensionCommon(DRW_Dimension *ent, dwgBufferW &data);
+
+    void writeTables();
+    void writeDictionaries();
+    void writeDwgHeader(dwgBufferW &buf);
+    void writeDwgClasses(dwgBufferW &buf);
+    void writeDwgHandles(dwgBufferW &buf, duint32 offset);
+
+    int getHdrInt(const std::string &key, int def);
+    double getHdrDouble(const std::string &key, double def);
+    DRW_Coord getHdrCoord(const std::string &key, const DRW_Coord &def);
+    std::string getHdrStr(const std::string &key, const std::string &def);
+    DRW_Variant *findVar(const std::string &key);
+
+private:
+    std::ofstream *fileStr;
+    DRW_TextCodec encoder;
+    DRW_Header header;
+    std::map<duint32, std::vector<duint8> > objects;
+
+    std::vector<tableEntry<DRW_LType> > ltypes;
+    std::vector<tableEntry<DRW_Layer> > layers;
+    std::vector<tableEntry<DRW_Textstyle> > styles;
+    std::vector<tableEntry<DRW_Dimstyle> > dimstyles;
+    std::vector<tableEntry<DRW_Vport> > vports;
+    std::vector<tableEntry<DRW_AppId> > appIds;
+    std::list<blockRecordW> blockRecords;
+    std::map<std::string, duint32> ltypeMap;
+    std::map<std::string, duint32> layerMap;
+    std::map<std::string, duint32> styleMap;
+    std::map<std::string, duint32> dimstyleMap;
+    std::map<std::string, duint32> blockMap;
+
+    blockRecordW modelSpace;
+    blockRecordW paperSpace;
+    blockRecordW *currBlock;
+    bool defaultsAdded;
+    duint32 nextHandle;
+};
+
+#endif // DWGWRITER_H
@@ -39,16 +39,20 @@ RScodec::RScodec(unsigned int pp, int mm, int tt) {
     alpha_to = new (std::nothrow) int[nn+1];
     index_of = new (std::nothrow) unsigned int[nn+1];
     gg = new (std::nothrow) int[nn-kk+1];
+    syn_tab = new (std::nothrow) unsigned char[(nn-kk)*(nn+1)];
 
     RSgenerate_gf(pp) ;
     /* compute the generator polynomial for this RS code */
     RSgen_poly() ;
+    /* multiplication tables used for syndrome evaluation */
+    RSgen_syntab() ;
 }
 
 RScodec::~RScodec() {
     delete[] alpha_to;
     delete[] index_of;
     delete[] gg;
+    delete[] syn_tab;
 }
 
 
@@ -111,6 +115,65 @@ void RScodec::RSgen_poly() {
     for (i=0; i<=bb; i++)  gg[i] = index_of[gg[i]] ;
 }
 
+/* Build for each syndrome i=1..2*tt the table of products x * alpha**i in
+   polynomial form, it allows evaluate the syndromes by Horner's rule with
+   one lookup and one xor per symbol, without log/antilog conversions.
+*/
+void RScodec::RSgen_syntab() {
+    if (!isOk) return;
+    int bb = nn-kk; //nn-kk length of parity data
+    for (int i=1; i<=bb; i++) {
+        unsigned char *row = syn_tab + (i-1)*(nn+1);
+        row[0] = 0;
+        for (int x=1; x<=nn; x++)
+            row[x] = alpha_to[(index_of[x] + i) % nn];
+    }
+}
+
+/* returns true if any syndrome of data (nn symbols, polynomial form) is non zero,
+   s[i] = sum(data[j] * alpha**(i*j)), evaluated as ((data[nn-1]*a + data[nn-2])*a + ...)
+*/
+bool RScodec::hasSyndromes(const unsigned char *data) {
+    int bb = nn-kk; //nn-kk length of parity data
+    for (int i=0; i<bb; i++) {
+        const unsigned char *mul = syn_tab + i*(nn+1);
+        unsigned char s = 0;
+        for (int j=nn-1; j>=0; j--)
+            s = mul[s] ^ data[j];
+        if (s != 0)
+            return true;
+    }
+    return false;
+}
+
+/** computes the syndromes of blk interleaved codewords, codeword i are the
+   symbols in[i], in[i+blk], in[i+2*blk] ... in[i+(nn-1)*blk].
+   The input is swept once row by row, all codewords are evaluated in parallel
+   in the inner loop.
+   syn[] is output and must hold (nn-kk)*blk bytes, syndrome k of codeword i
+   are stored in syn[k*blk+i].
+   return value: true if any syndrome of any codeword is non zero */
+bool RScodec::syndromesI(const unsigned char *in, unsigned int blk, unsigned char *syn) {
+    if (!isOk) return true;
+    int bb = nn-kk; //nn-kk length of parity data
+    for (unsigned int i=0; i<bb*blk; i++)
+        syn[i] = 0;
+    for (int j=nn-1; j>=0; j--) {
+        const unsigned char *row = in + j*blk;
+        for (int k=0; k<bb; k++) {
+            const unsigned char *mul = syn_tab + k*(nn+1);
+            unsigned char *s = syn + k*blk;
+            for (unsigned int i=0; i<blk; i++)
+                s[i] = mul[s[i]] ^ row[i];
+        }
+    }
+    for (unsigned int i=0; i<bb*blk; i++) {
+        if (syn[i] != 0)
+            return true;
+    }
+    return false;
+}
+
 int RScodec::calcDecode(unsigned char* data, int* recd, int** elp, int* d, int* l, int* u_lu, int* s, int* root, int* loc, int* z, int* err, int* reg, int bb)
 {
     if (!isOk) return -1;
@@ -365,6 +428,9 @@ bool RScodec::encode(unsigned char *data, unsigned char *parity) {
 /** return value: number of corrected errors or -1 if can't correct it */
 int RScodec::decode(unsigned char *data) {
     if (!isOk) return -1;
+    /* fast path: no non-zero syndromes => no errors, nothing to correct */
+    if (!hasSyndromes(data))
+        return 0;
     int bb = nn-kk;; //nn-kk length of parity data
 
     int *recd = new (std::nothrow) int[nn];
@@ -44,6 +44,7 @@ public:
 //    int decode(int *recd);
     bool encode(unsigned char *data, unsigned char *parity);
     int decode(unsigned char *data);
+    bool syndromesI(const unsigned char *in, unsigned int blk, unsigned char *syn);
     bool isOkey(){return isOk;}
     const unsigned int* indexOf() {return index_of;}
     const int* alphaTo() {return alpha_to;}
@@ -51,6 +52,8 @@ public:
 private:
     void RSgenerate_gf(unsigned int pp);
     void RSgen_poly();
+    void RSgen_syntab();
+    bool hasSyndromes(const unsigned char *data);
     int calcDecode(unsigned char* data, int* recd, int** elp, int* d, int* l, int* u_lu, int* s, int* root, int* loc, int* z, int* err, int* reg, int bb);
   
 
@@ -64,6 +67,7 @@ private:
     bool isOk;
     unsigned int *index_of;
     int *alpha_to;
+    unsigned char *syn_tab; //syn_tab[(i-1)*(nn+1)+x] = x * alpha**i, i=1..2*tt
 };
 
 #endif // RSCODEC_H
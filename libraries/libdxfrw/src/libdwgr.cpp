@@ -65,8 +65,7 @@ void dwgR::setDebug(DRW::DBG_LEVEL lvl){
 bool dwgR::getPreview(){
     bool isOk = false;
 
-    std::ifstream filestr;
-    isOk = openFile(&filestr);
+    isOk = openFile();
     if (!isOk)
         return false;
 
@@ -76,7 +75,6 @@ bool dwgR::getPreview(){
     } else
         error = DRW::BAD_READ_METADATA;
 
-    filestr.close();
     if (reader != NULL) {
         delete reader;
         reader = NULL;
@@ -146,8 +144,7 @@ bool dwgR::read(DRW_Interface *interface_, bool ext){
 
 //testReader();return false;
 
-    std::ifstream filestr;
-    isOk = openFile(&filestr);
+    isOk = openFile();
     if (!isOk)
         return false;
 
@@ -161,7 +158,6 @@ bool dwgR::read(DRW_Interface *interface_, bool ext){
     } else
         error = DRW::BAD_READ_METADATA;
 
-    filestr.close();
     if (reader != NULL) {
         delete reader;
         reader = NULL;
@@ -170,24 +166,65 @@ bool dwgR::read(DRW_Interface *interface_, bool ext){
     return isOk;
 }
 
-/* Open the file and stores it in filestr, install the correct reader version.
+/*reads header and tables only, without blocks, entities & objects*/
+bool dwgR::probe(DRW_Interface *interface_){
+    bool isOk = false;
+    applyExt = false;
+    iface = interface_;
+
+    isOk = openFile();
+    if (!isOk)
+        return false;
+
+    isOk = reader->readMetaData();
+    if (isOk) {
+        isOk = reader->readFileHeader();
+        if (isOk) {
+            isOk = processDwgTables();
+            //report block names without reading its entities
+            for (std::map<duint32, DRW_Block_Record*>::iterator it=reader->blockRecordmap.begin(); it!=reader->blockRecordmap.end(); ++it) {
+                DRW_Block_Record *br = it->second;
+                DRW_Block bk;
+                bk.name = br->name;
+                bk.flags = br->flags;
+                bk.basePoint = br->basePoint;
+                iface->addBlock(bk);
+                iface->endBlock();
+            }
+        } else
+            error = DRW::BAD_READ_FILE_HEADER;
+    } else
+        error = DRW::BAD_READ_METADATA;
+
+    if (reader != NULL) {
+        delete reader;
+        reader = NULL;
+    }
+
+    return isOk;
+}
+
+/* Open the file and install the correct reader version, the file is memory
+ * mapped (or read at once if mapping is not possible) and owned by the reader.
  * If fail opening file, error are set as DRW::BAD_OPEN
  * If not are DWG or are unsupported version, error are set as DRW::BAD_VERSION
- * and closes filestr.
+ * and closes the file.
  * Return true on succeed or false on fail
 */
-bool dwgR::openFile(std::ifstream *filestr){
+bool dwgR::openFile(){
     bool isOk = false;
     DRW_DBG("dwgR::read 1\n");
-    filestr->open (fileName.c_str(), std::ios_base::in | std::ios::binary);
-    if (!filestr->is_open() || !filestr->good() ){
+    dwgBasicStream *filestr = new dwgMappedStream(fileName);
+    if (!filestr->good()){
         error = DRW::BAD_OPEN;
+        delete filestr;
         return isOk;
     }
 
-    char line[7];
-    filestr->read (line, 6);
+    char line[7] = {'\0'};
+    filestr->read (reinterpret_cast<duint8*>(line), 6);
     line[6]='\0';
+    filestr->setPos(0);
     DRW_DBG("dwgR::read 2\n");
     DRW_DBG("dwgR::read line version: ");
     DRW_DBG(line);
@@ -197,7 +234,7 @@ bool dwgR::openFile(std::ifstream *filestr){
         version = DRW::AC1006;
     else if (strcmp(line, "AC1009") == 0) {
         version = DRW::AC1009;
-//        reader = new dwgReader09(&filestr, this);
+//        reader = new dwgReader09(filestr, this);
     }else if (strcmp(line, "AC1012") == 0){
         version = DRW::AC1012;
         reader = new dwgReader15(filestr, this);
@@ -224,7 +261,7 @@ bool dwgR::openFile(std::ifstream *filestr){
 
     if (reader == NULL) {
         error = DRW::BAD_VERSION;
-        filestr->close();
+        delete filestr;
     } else
         isOk = true;
 
@@ -233,8 +270,11 @@ bool dwgR::openFile(std::ifstream *filestr){
 
 /********* Reader Process *********/
 
-bool dwgR::processDwg() {
-    DRW_DBG("dwgR::processDwg() start processing dwg\n");
+/* Reads header, classes, handles & tables and sends header & table entries
+ * to the interface. Used by processDwg() and probe().
+*/
+bool dwgR::processDwgTables() {
+    DRW_DBG("dwgR::processDwgTables() start processing dwg\n");
     bool ret;
     bool ret2;
     DRW_Header hdr;
@@ -292,6 +332,14 @@ bool dwgR::processDwg() {
         iface->addAppId(const_cast<DRW_AppId&>(*ly));
     }
 
+    return ret;
+}
+
+bool dwgR::processDwg() {
+    DRW_DBG("dwgR::processDwg() start processing dwg\n");
+    bool ret = processDwgTables();
+    bool ret2;
+
     ret2 = reader->readDwgBlocks(*iface);
     if (ret && !ret2) {
         error = DRW::BAD_READ_BLOCKS;
@@ -28,6 +28,8 @@ public:
     ~dwgR();
     //read: return true if all ok
     bool read(DRW_Interface *interface_, bool ext);
+    //probe: reads only header & tables, blocks are reported empty, return true if all ok
+    bool probe(DRW_Interface *interface_);
     bool getPreview();
     DRW::Version getVersion(){return version;}
     DRW::error getError(){return error;}
@@ -35,8 +37,9 @@ bool testReader();
     void setDebug(DRW::DBG_LEVEL lvl);
 
 private:
-    bool openFile(std::ifstream *filestr);
+    bool openFile();
     bool processDwg();
+    bool processDwgTables();
 private:
     DRW::Version version;
     DRW::error error;
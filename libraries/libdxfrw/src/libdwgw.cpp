@@ -0,0 +1,186 @@
+/******************************************************************************
+**  libDXFrw - Library to read/write DXF files (ascii & binary)              **
+**                                                                           **
+**  Copyright (C) 2011-2015 José F. Soriano, rallazz@gmail.com               **
+**                                                                           **
+**  This library is free software, licensed under the terms of the GNU       **
+**  General Public License as published by the Free Software Foundation,     **
+**  either version 2 of the License, or (at your option) any later version.  **
+**  You should have received a copy of the GNU General Public License        **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
+******************************************************************************/
+
+
+#include "libdwgw.h"
+#include <fstream>
+#include "intern/dwgwriter.h"
+#include "intern/drw_dbg.h"
+
+dwgW::dwgW(const char* name) : dxfRW(name){
+    fileName = name;
+    writer = NULL;
+}
+
+dwgW::~dwgW(){
+    if (writer != NULL)
+        delete writer;
+}
+
+/**
+ * Calls the interface in the same order as dxfRW, tables first to
+ * know all the handles, next blocks and last the entities.
+ */
+bool dwgW::write(DRW_Interface *interface_, DRW::Version /*ver*/, bool /*bin*/){
+    bool isOk = false;
+    std::ofstream filestr;
+    filestr.open(fileName.c_str(), std::ios_base::out | std::ios::binary | std::ios::trunc);
+    if (!filestr.is_open() || !filestr.good())
+        return false;
+    writer = new dwgWriter(&filestr);
+    DRW_Header header;
+    interface_->writeHeader(header);
+    writer->setHeader(header);
+    interface_->writeVports();
+    interface_->writeLTypes();
+    interface_->writeLayers();
+    interface_->writeTextstyles();
+    interface_->writeAppId();
+    interface_->writeDimstyles();
+    interface_->writeBlockRecords();
+    interface_->writeBlocks();
+    writer->endBlocks();
+    interface_->writeEntities();
+    isOk = writer->writeFile();
+    filestr.close();
+    delete writer;
+    writer = NULL;
+    DRW_DBG("dwgW::write finished\n");
+    return isOk;
+}
+
+bool dwgW::writeLineType(DRW_LType *ent){
+    writer->addLType(*ent);
+    return true;
+}
+
+bool dwgW::writeLayer(DRW_Layer *ent){
+    writer->addLayer(*ent);
+    return true;
+}
+
+bool dwgW::writeDimstyle(DRW_Dimstyle *ent){
+    writer->addDimstyle(*ent);
+    return true;
+}
+
+bool dwgW::writeTextstyle(DRW_Textstyle *ent){
+    writer->addTextstyle(*ent);
+    return true;
+}
+
+bool dwgW::writeVport(DRW_Vport *ent){
+    writer->addVport(*ent);
+    return true;
+}
+
+bool dwgW::writeAppId(DRW_AppId *ent){
+    writer->addAppId(*ent);
+    return true;
+}
+
+bool dwgW::writePoint(DRW_Point *ent){
+    return writer->writePoint(ent);
+}
+
+bool dwgW::writeLine(DRW_Line *ent){
+    return writer->writeLine(ent);
+}
+
+bool dwgW::writeRay(DRW_Ray *ent){
+    return writer->writeRay(ent);
+}
+
+bool dwgW::writeXline(DRW_Xline *ent){
+    return writer->writeXline(ent);
+}
+
+bool dwgW::writeCircle(DRW_Circle *ent){
+    return writer->writeCircle(ent);
+}
+
+bool dwgW::writeArc(DRW_Arc *ent){
+    return writer->writeArc(ent);
+}
+
+bool dwgW::writeEllipse(DRW_Ellipse *ent){
+    return writer->writeEllipse(ent);
+}
+
+bool dwgW::writeTrace(DRW_Trace *ent){
+    return writer->writeTrace(ent);
+}
+
+bool dwgW::writeSolid(DRW_Solid *ent){
+    return writer->writeSolid(ent);
+}
+
+bool dwgW::write3dface(DRW_3Dface *ent){
+    return writer->write3dface(ent);
+}
+
+bool dwgW::writeLWPolyline(DRW_LWPolyline *ent){
+    return writer->writeLWPolyline(ent);
+}
+
+bool dwgW::writePolyline(DRW_Polyline *ent){
+    return writer->writePolyline(ent);
+}
+
+bool dwgW::writeSpline(DRW_Spline *ent){
+    return writer->writeSpline(ent);
+}
+
+bool dwgW::writeBlockRecord(std::string name){
+    writer->addBlockRecord(name);
+    return true;
+}
+
+bool dwgW::writeBlock(DRW_Block *ent){
+    return writer->writeBlock(ent);
+}
+
+bool dwgW::writeInsert(DRW_Insert *ent){
+    return writer->writeInsert(ent);
+}
+
+bool dwgW::writeMText(DRW_MText *ent){
+    return writer->writeMText(ent);
+}
+
+bool dwgW::writeText(DRW_Text *ent){
+    return writer->writeText(ent);
+}
+
+bool dwgW::writeHatch(DRW_Hatch *ent){
+    return writer->writeHatch(ent);
+}
+
+bool dwgW::writeViewport(DRW_Viewport */*ent*/){
+    return false;
+}
+
+DRW_ImageDef *dwgW::writeImage(DRW_Image */*ent*/, std::string /*name*/){
+    return NULL;
+}
+
+bool dwgW::writeLeader(DRW_Leader */*ent*/){
+    return false;
+}
+
+bool dwgW::writeDimension(DRW_Dimension *ent){
+    return writer->writeDimension(ent);
+}
+
+bool dwgW::writePlotSettings(DRW_PlotSettings */*ent*/){
+    return false;
+}
@@ -0,0 +1,70 @@
+/******************************************************************************
+**  libDXFrw - Library to read/write DXF files (ascii & binary)              **
+**                                                                           **
+**  Copyright (C) 2011-2015 José F. Soriano, rallazz@gmail.com               **
+**                                                                           **
+**  This library is free software, licensed under the terms of the GNU       **
+**  General Public License as published by the Free Software Foundation,     **
+**  either version 2 of the License, or (at your option) any later version.  **
+**  You should have received a copy of the GNU General Public License        **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
+******************************************************************************/
+
+#ifndef LIBDWGW_H
+#define LIBDWGW_H
+
+#include <string>
+#include "libdxfrw.h"
+
+class dwgWriter;
+
+//! Class to write dwg files
+/*!
+*  Uses the same DRW_Interface callbacks as dxfRW, the application can
+*  switch between dxf & dwg output only changing the created object.
+*  Only R2000 (AC1015) files are written, images, leaders, viewports
+*  and plot settings are not supported and are silently dropped.
+*/
+class dwgW : public dxfRW {
+public:
+    dwgW(const char* name);
+    virtual ~dwgW();
+    //write: return true if all ok, ver & bin are ignored, always AC1015
+    virtual bool write(DRW_Interface *interface_, DRW::Version ver, bool bin);
+    virtual bool writeLineType(DRW_LType *ent);
+    virtual bool writeLayer(DRW_Layer *ent);
+    virtual bool writeDimstyle(DRW_Dimstyle *ent);
+    virtual bool writeTextstyle(DRW_Textstyle *ent);
+    virtual bool writeVport(DRW_Vport *ent);
+    virtual bool writeAppId(DRW_AppId *ent);
+    virtual bool writePoint(DRW_Point *ent);
+    virtual bool writeLine(DRW_Line *ent);
+    virtual bool writeRay(DRW_Ray *ent);
+    virtual bool writeXline(DRW_Xline *ent);
+    virtual bool writeCircle(DRW_Circle *ent);
+    virtual bool writeArc(DRW_Arc *ent);
+    virtual bool writeEllipse(DRW_Ellipse *ent);
+    virtual bool writeTrace(DRW_Trace *ent);
+    virtual bool writeSolid(DRW_Solid *ent);
+    virtual bool write3dface(DRW_3Dface *ent);
+    virtual bool writeLWPolyline(DRW_LWPolyline *ent);
+    virtual bool writePolyline(DRW_Polyline *ent);
+    virtual bool writeSpline(DRW_Spline *ent);
+    virtual bool writeBlockRecord(std::string name);
+    virtual bool writeBlock(DRW_Block *ent);
+    virtual bool writeInsert(DRW_Insert *ent);
+    virtual bool writeMText(DRW_MText *ent);
+    virtual bool writeText(DRW_Text *ent);
+    virtual bool writeHatch(DRW_Hatch *ent);
+    virtual bool writeViewport(DRW_Viewport *ent);
+    virtual DRW_ImageDef *writeImage(DRW_Image *ent, std::string name);
+    virtual bool writeLeader(DRW_Leader *ent);
+    virtual bool writeDimension(DRW_Dimension *ent);
+    virtual bool writePlotSettings(DRW_PlotSettings *ent);
+
+private:
+    std::string fileName;
+    dwgWriter *writer;
+};
+
+#endif // LIBDWGW_H
@@ -38,6 +38,7 @@ dxfRW::dxfRW(const char* name){
     reader = NULL;
     writer = NULL;
     applyExt = false;
+    probeOnly = false;
     elParts = 128; //parts munber when convert ellipse to polyline
 }
 dxfRW::~dxfRW(){
@@ -61,6 +62,13 @@ void dxfRW::setDebug(DRW::DBG_LEVEL lvl){
     }
 }
 
+bool dxfRW::probe(DRW_Interface *interface_){
+    probeOnly = true;
+    bool isOk = read(interface_, false);
+    probeOnly = false;
+    return isOk;
+}
+
 bool dxfRW::read(DRW_Interface *interface_, bool ext){
     drw_assert(fileName.empty() == false);
     bool isOk = false;
@@ -1850,6 +1858,10 @@ bool dxfRW::processDxf() {
                         if (!processTables()) {
                             return false;
                         }
+                        if (probeOnly)
+                            return true; //metadata read, skip blocks & entities
+                    } else if (probeOnly) {
+                        return true; //no TABLES section, nothing more to probe
                     } else if (sectionstr == "BLOCKS") {
                         if (!processBlocks()) {
                             return false;
@@ -1937,7 +1949,8 @@ bool dxfRW::processTables() {
                     } else if (sectionstr == "DIMSTYLE") {
                         processDimStyle();
                     } else if (sectionstr == "BLOCK_RECORD") {
-//                        processBlockRecord();
+                        if (probeOnly)
+                            processBlockRecord();
                     }
                 }
             } else if (sectionstr == "ENDSEC") {
@@ -2100,6 +2113,36 @@ bool dxfRW::processAppId(){
     return true;
 }
 
+bool dxfRW::processBlockRecord(){
+    DRW_DBG("dxfRW::processBlockRecord");
+    int code;
+    std::string sectionstr;
+    bool reading = false;
+    DRW_Block_Record br;
+    DRW_Block block;
+    while (reader->readRec(&code)) {
+        DRW_DBG(code); DRW_DBG("\n");
+        if (code == 0) {
+            if (reading) {
+                //only the name is relevant for probe, blocks are reported empty
+                block.name = br.name;
+                iface->addBlock(block);
+                iface->endBlock();
+            }
+            sectionstr = reader->getString();
+            DRW_DBG(sectionstr); DRW_DBG("\n");
+            if (sectionstr == "BLOCK_RECORD") {
+                reading = true;
+                br.reset();
+            } else if (sectionstr == "ENDTAB") {
+                return true;  //found ENDTAB terminate
+            }
+        } else if (reading)
+            br.parseCode(code, reader);
+    }
+    return true;
+}
+
 /********* Block Section *********/
 
 bool dxfRW::processBlocks() {
@@ -26,7 +26,7 @@ class dxfWriter;
 class dxfRW {
 public:
     dxfRW(const char* name);
-    ~dxfRW();
+    virtual ~dxfRW();
     void setDebug(DRW::DBG_LEVEL lvl);
     /// reads the file specified in constructor
     /*!
@@ -37,40 +37,49 @@ public:
      * @return true for success
      */
     bool read(DRW_Interface *interface_, bool ext);
+    /// reads only the metadata of the file specified in constructor
+    /*!
+     * Parses the HEADER and TABLES sections and stops before BLOCKS, no
+     * entities are built. Block names are taken from the BLOCK_RECORD table
+     * and reported through addBlock()/endBlock() without content.
+     * @param interface_ the interface to use
+     * @return true for success
+     */
+    bool probe(DRW_Interface *interface_);
     void setBinary(bool b) {binFile = b;}
 
-    bool write(DRW_Interface *interface_, DRW::Version ver, bool bin);
-    bool writeLineType(DRW_LType *ent);
-    bool writeLayer(DRW_Layer *ent);
-    bool writeDimstyle(DRW_Dimstyle *ent);
-    bool writeTextstyle(DRW_Textstyle *ent);
-    bool writeVport(DRW_Vport *ent);
-    bool writeAppId(DRW_AppId *ent);
-    bool writePoint(DRW_Point *ent);
-    bool writeLine(DRW_Line *ent);
-    bool writeRay(DRW_Ray *ent);
-    bool writeXline(DRW_Xline *ent);
-    bool writeCircle(DRW_Circle *ent);
-    bool writeArc(DRW_Arc *ent);
-    bool writeEllipse(DRW_Ellipse *ent);
-    bool writeTrace(DRW_Trace *ent);
-    bool writeSolid(DRW_Solid *ent);
-    bool write3dface(DRW_3Dface *ent);
-    bool writeLWPolyline(DRW_LWPolyline *ent);
-    bool writePolyline(DRW_Polyline *ent);
-    bool writeSpline(DRW_Spline *ent);
-    bool writeBlockRecord(std::string name);
-    bool writeBlock(DRW_Block *ent);
-    bool writeInsert(DRW_Insert *ent);
-    bool writeMText(DRW_MText *ent);
-    bool writeText(DRW_Text *ent);
-    bool writeHatch(DRW_Hatch *ent);
-    bool writeViewport(DRW_Viewport *ent);
-    DRW_ImageDef *writeImage(DRW_Image *ent, std::string name);
-    bool writeLeader(DRW_Leader *ent);
-    bool writeDimension(DRW_Dimension *ent);
+    virtual bool write(DRW_Interface *interface_, DRW::Version ver, bool bin);
+    virtual bool writeLineType(DRW_LType *ent);
+    virtual bool writeLayer(DRW_Layer *ent);
+    virtual bool writeDimstyle(DRW_Dimstyle *ent);
+    virtual bool writeTextstyle(DRW_Textstyle *ent);
+    virtual bool writeVport(DRW_Vport *ent);
+    virtual bool writeAppId(DRW_AppId *ent);
+    virtual bool writePoint(DRW_Point *ent);
+    virtual bool writeLine(DRW_Line *ent);
+    virtual bool writeRay(DRW_Ray *ent);
+    virtual bool writeXline(DRW_Xline *ent);
+    virtual bool writeCircle(DRW_Circle *ent);
+    virtual bool writeArc(DRW_Arc *ent);
+    virtual bool writeEllipse(DRW_Ellipse *ent);
+    virtual bool writeTrace(DRW_Trace *ent);
+    virtual bool writeSolid(DRW_Solid *ent);
+    virtual bool write3dface(DRW_3Dface *ent);
+    virtual bool writeLWPolyline(DRW_LWPolyline *ent);
+    virtual bool writePolyline(DRW_Polyline *ent);
+    virtual bool writeSpline(DRW_Spline *ent);
+    virtual bool writeBlockRecord(std::string name);
+    virtual bool writeBlock(DRW_Block *ent);
+    virtual bool writeInsert(DRW_Insert *ent);
+    virtual bool writeMText(DRW_MText *ent);
+    virtual bool writeText(DRW_Text *ent);
+    virtual bool writeHatch(DRW_Hatch *ent);
+    virtual bool writeViewport(DRW_Viewport *ent);
+    virtual DRW_ImageDef *writeImage(DRW_Image *ent, std::string name);
+    virtual bool writeLeader(DRW_Leader *ent);
+    virtual bool writeDimension(DRW_Dimension *ent);
     void setEllipseParts(int parts){elParts = parts;} /*!< set parts munber when convert ellipse to polyline */
-    bool writePlotSettings(DRW_PlotSettings *ent);
+    virtual bool writePlotSettings(DRW_PlotSettings *ent);
 
 private:
     /// used by read() to parse the content of the file
@@ -88,6 +97,7 @@ private:
     bool processTextStyle();
     bool processVports();
     bool processAppId();
+    bool processBlockRecord();
 
     bool processPoint();
     bool processLine();
@@ -138,6 +148,7 @@ private:
     bool wlayer0;
     bool dimstyleStd;
     bool applyExt;
+    bool probeOnly;  /*!< stop reading after TABLES section, used by probe() */
     bool writingBlock;
     int elParts;  /*!< parts munber when convert ellipse to polyline */
     std::map<std::string,int> blockMap;
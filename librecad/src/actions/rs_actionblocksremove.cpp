@@ -99,6 +99,7 @@ void RS_ActionBlocksRemove::trigger() {
 
         // Now remove block from the block list, but do not delete:
         block->setUndoState(true);
+        block->setChanged(true);
         document->addUndoable(block);
     }
     document->endUndoCycle();
@@ -30,6 +30,7 @@
 #include "rs_dialogfactory.h"
 #include "rs_graphicview.h"
 #include "rs_graphic.h"
+#include "rs_block.h"
 
 /**
  * Constructor.
@@ -70,6 +71,12 @@ void RS_ActionEditUndo::trigger()
 
     graphic->addBlockNotification();
     graphic->setModified(true);
+    if (document->rtti()==RS2::EntityBlock) {
+        static_cast<RS_Block*>(document)->setChanged(true);
+    } else {
+        // undo may restore or remove blocks, update all inserts:
+        graphic->getBlockList()->setAllChanged(true);
+    }
     document->updateInserts();
     graphicView->redraw(RS2::RedrawDrawing);
     finish(false);
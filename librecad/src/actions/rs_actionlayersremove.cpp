@@ -49,6 +49,7 @@ void RS_ActionLayersRemove::trigger() {
             for (auto name: names) {
                 graphic->removeLayer(ll->find(name));
             }
+            graphic->getBlockList()->setAllChanged(true);
             graphic->updateInserts();
             container->calculateBorders();
             graphic->getLayerList()->getLayerWitget()->slotUpdateLayerList();
@@ -60,6 +60,8 @@ void RS_ActionLayersToggleView::trigger() {
         if (!cnt) {
             graphic->toggleLayer(a_layer);
         }
+        // block borders depend on layer visibility:
+        graphic->getBlockList()->setAllChanged(true);
         graphic->updateInserts();
         container->calculateBorders();
     }
@@ -0,0 +1,51 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU General Public License version 2 as published by the Free Software
+** Foundation and appearing in the file gpl-2.0.txt included in the
+** packaging of this file.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+
+#include "rs_actionselectcrossings.h"
+
+#include <QAction>
+#include "rs_dialogfactory.h"
+#include "rs_selection.h"
+
+RS_ActionSelectCrossings::RS_ActionSelectCrossings(RS_EntityContainer& container,
+												   RS_GraphicView& graphicView)
+		:RS_ActionInterface("Select Crossing Entities",
+							container, graphicView) {
+	actionType=RS2::ActionSelectCrossings;
+}
+
+void RS_ActionSelectCrossings::init(int status) {
+	RS_ActionInterface::init(status);
+	trigger();
+	finish(false);
+}
+
+void RS_ActionSelectCrossings::trigger() {
+	RS_Selection s(*container, graphicView);
+	size_t const found = s.selectCrossings();
+
+	RS_DIALOGFACTORY->commandMessage(tr("%1 intersections found").arg(found));
+	RS_DIALOGFACTORY->updateSelectionWidget(container->countSelected(),container->totalSelectedLength());
+}
+
+// EOF
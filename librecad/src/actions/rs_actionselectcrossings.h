@@ -0,0 +1,43 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU General Public License version 2 as published by the Free Software
+** Foundation and appearing in the file gpl-2.0.txt included in the
+** packaging of this file.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+
+#ifndef RS_ACTIONSELECTCROSSINGS_H
+#define RS_ACTIONSELECTCROSSINGS_H
+
+#include "rs_actioninterface.h"
+
+
+/**
+ * This action class selects all entities which intersect each other.
+ */
+class RS_ActionSelectCrossings : public RS_ActionInterface {
+	Q_OBJECT
+public:
+	RS_ActionSelectCrossings(RS_EntityContainer& container,
+							 RS_GraphicView& graphicView);
+
+	void init(int status) override;
+	void trigger() override;
+};
+
+#endif
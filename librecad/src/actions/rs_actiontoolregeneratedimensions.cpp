@@ -32,6 +32,7 @@
 #include "rs_information.h"
 #include "rs_dimension.h"
 #include "rs_debug.h"
+#include "lc_regenscheduler.h"
 
 
 
@@ -52,17 +53,18 @@ void RS_ActionToolRegenerateDimensions::trigger() {
 
     RS_DEBUG->print("RS_ActionToolRegenerateDimensions::trigger()");
 
-	int num = 0;
+	LC_RegenScheduler regen(true);
 	for(auto e: *container){
 
         if (RS_Information::isDimension(e->rtti()) && e->isVisible()) {
-			num++;
 			if (((RS_Dimension*)e)->getLabel()==";;") {
 				((RS_Dimension*)e)->setLabel("");
 			}
-            ((RS_Dimension*)e)->updateDim(true);
+            regen.add(e);
         }
     }
+	int num = regen.count();
+	regen.run();
 
     if (num>0) {
     	graphicView->redraw();
@@ -25,6 +25,7 @@
 **********************************************************************/
 
 
+#include<algorithm>
 #include<cmath>
 #include<QMouseEvent>
 #include "rs_snapper.h"
@@ -309,7 +310,13 @@ RS_Vector RS_Snapper::snapPoint(QMouseEvent* e)
         }
     }
     if (snapMode.snapIntersection) {
-        t = snapIntersection(mouseCoord);
+        // only an intersection closer than the current snap point is used,
+        // with free snap alone farther ones are dropped below anyway:
+        double range = sqrt(ds2Min);
+        if (snapMode.snapFree && !snapMode.snapOnEntity && !snapMode.snapGrid) {
+            range = std::min(range, (graphicView->getGrid()->getCellVector()*0.5).magnitude());
+        }
+        t = snapIntersection(mouseCoord, range);
 		double ds2=mouseCoord.squaredTo(t);
         if (ds2 < ds2Min){
             ds2Min=ds2;
@@ -521,13 +528,14 @@ RS_Vector RS_Snapper::snapDist(const RS_Vector& coord) {
  * Snaps to the closest intersection point.
  *
  * @param coord The mouse coordinate.
+ * @param range Intersections farther away from coord are ignored.
  * @return The coordinates of the point or an invalid vector.
  */
-RS_Vector RS_Snapper::snapIntersection(const RS_Vector& coord) {
+RS_Vector RS_Snapper::snapIntersection(const RS_Vector& coord, double range) {
 	RS_Vector vec{};
 
     vec = container->getNearestIntersection(coord,
-											nullptr);
+											nullptr, range);
     return vec;
 }
 
@@ -161,7 +161,7 @@ public:
     RS_Vector snapCenter(const RS_Vector& coord);
     RS_Vector snapMiddle(const RS_Vector& coord);
     RS_Vector snapDist(const RS_Vector& coord);
-    RS_Vector snapIntersection(const RS_Vector& coord);
+    RS_Vector snapIntersection(const RS_Vector& coord, double range = RS_MAXDOUBLE);
     //RS_Vector snapDirect(RS_Vector coord, bool abs);
     RS_Vector snapToAngle(const RS_Vector &coord, const RS_Vector &ref_coord, const double ang_res);
 
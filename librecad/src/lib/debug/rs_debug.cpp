@@ -30,12 +30,19 @@
 #include <iostream>
 #include <cstdio>
 #include <cstdarg>
+#include <mutex>
 #include <QString>
 
 #include <QDateTime>
 #include <QDebug>
 
-RS_Debug* RS_Debug::uniqueInstance = nullptr;
+std::atomic<RS_Debug*> RS_Debug::uniqueInstance {nullptr};
+
+namespace {
+//! Guards creation of the instance and the output stream
+std::mutex debugMutex;
+}
+
 void debugHeader(char const* file, char const* func, int line)
 {
 	std::cout<<file<<" : "<<func<<" : line "<<line<<std::endl;
@@ -49,6 +56,12 @@ void debugHeader(char const* file, char const* func, int line)
  * singleton class
  */
 RS_Debug* RS_Debug::instance() {
+	RS_Debug* debug = uniqueInstance.load();
+	if (debug) {
+		return debug;
+	}
+
+	std::lock_guard<std::mutex> lock(debugMutex);
 	if(!uniqueInstance) {
         QDateTime now = QDateTime::currentDateTime();
         QString nowStr;
@@ -60,11 +73,12 @@ RS_Debug* RS_Debug::instance() {
                 QString fName = QString("debug_%1.log")
 			.arg(nowStr);
 
-        uniqueInstance = new RS_Debug;
-        //uniqueInstance->stream = fopen(fName.latin1(), "wt");
-        uniqueInstance->stream = stderr;
+        debug = new RS_Debug;
+        //debug->stream = fopen(fName.latin1(), "wt");
+        debug->stream = stderr;
+        uniqueInstance = debug;
     }
-    return uniqueInstance;
+    return uniqueInstance.load();
 }
 
 
@@ -73,9 +87,11 @@ RS_Debug* RS_Debug::instance() {
  */
 void
 RS_Debug::deleteInstance() {
-    if (uniqueInstance) {
-        fclose(uniqueInstance->stream);
-        delete uniqueInstance;
+    std::lock_guard<std::mutex> lock(debugMutex);
+    RS_Debug* debug = uniqueInstance.exchange(nullptr);
+    if (debug) {
+        fclose(debug->stream);
+        delete debug;
     }
 }
 
@@ -86,6 +102,14 @@ RS_Debug::RS_Debug() {
     debugLevel = D_DEBUGGING;
 }
 
+/**
+ * Sets the stream for all following messages.
+ */
+void RS_Debug::setStream(FILE* s) {
+    std::lock_guard<std::mutex> lock(debugMutex);
+    stream = s;
+}
+
 /**
  * Sets the debugging level.
  */
@@ -117,6 +141,7 @@ void RS_Debug::print(const char* format ...) {
     if(debugLevel==D_DEBUGGING) {
         va_list ap;
         va_start(ap, format);
+        std::lock_guard<std::mutex> lock(debugMutex);
         vfprintf(stream, format, ap);
         fprintf(stream, "\n");
         va_end(ap);
@@ -136,6 +161,7 @@ void RS_Debug::print(RS_DebugLevel level, const char* format ...) {
     if(debugLevel>=level) {
         va_list ap;
         va_start(ap, format);
+        std::lock_guard<std::mutex> lock(debugMutex);
         vfprintf(stream, format, ap);
         fprintf(stream, "\n");
         va_end(ap);
@@ -153,6 +179,7 @@ void RS_Debug::timestamp() {
     QString nowStr;
 
 	nowStr = now.toString("yyyyMMdd_hh:mm:ss:zzz ");
+    std::lock_guard<std::mutex> lock(debugMutex);
     fprintf(stream, "%s", nowStr.toLatin1().data());
     fprintf(stream, "\n");
     fflush(stream);
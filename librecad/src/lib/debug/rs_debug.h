@@ -29,6 +29,7 @@
 #define RS_DEBUG_H
 
 #include <iosfwd>
+#include <atomic>
 #ifdef __hpux
 #include <sys/_size_t.h>
 #endif
@@ -45,6 +46,10 @@ void debugHeader(char const* file, char const* func, int line);
 /**
  * Debugging facilities.
  *
+ * Messages may be printed from any thread, for example by hatches
+ * and dimensions regenerated by LC_RegenScheduler. Output is
+ * serialized, so messages of different threads are not mixed.
+ *
  * @author Andrew Mustun
  */
 class RS_Debug {
@@ -88,14 +93,12 @@ public:
     void print(const char* format ...);
     void printUnicode(const QString& text);
     void timestamp();
-    void setStream(FILE* s) {
-        stream = s;
-    }
+    void setStream(FILE* s);
 
 private:
-    static RS_Debug* uniqueInstance;
+    static std::atomic<RS_Debug*> uniqueInstance;
 
-    RS_DebugLevel debugLevel;
+    std::atomic<RS_DebugLevel> debugLevel;
     FILE* stream;
 };
 
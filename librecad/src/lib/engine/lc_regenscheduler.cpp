@@ -0,0 +1,218 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU General Public License version 2 as published by the Free Software
+** Foundation and appearing in the file gpl-2.0.txt included in the
+** packaging of this file.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+
+#include <atomic>
+#include <QObject>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QElapsedTimer>
+
+#include "lc_regenscheduler.h"
+#include "rs_block.h"
+#include "rs_dialogfactory.h"
+#include "rs_dimension.h"
+#include "rs_fontlist.h"
+#include "rs_hatch.h"
+#include "rs_information.h"
+#include "rs_patternlist.h"
+#include "rs_debug.h"
+
+namespace {
+//! Below this number of entities they are updated directly
+const int minParallel = 16;
+//! Runs taking longer than this (ms) report their progress
+const int progressDelay = 500;
+
+/**
+ * Regenerates one detached copy in a worker thread.
+ */
+class RegenJob : public QRunnable {
+public:
+    RegenJob(RS_EntityContainer* copy, bool autoText, std::atomic<int>& done):
+        copy(copy)
+      , autoText(autoText)
+      , done(done)
+    {}
+
+    void run() override {
+        if (autoText && RS_Information::isDimension(copy->rtti())) {
+            static_cast<RS_Dimension*>(copy)->updateDim(true);
+        } else {
+            copy->update();
+        }
+        ++done;
+    }
+
+private:
+    RS_EntityContainer* copy;
+    bool autoText;
+    std::atomic<int>& done;
+};
+}
+
+/**
+ * @param autoText true: regenerate the labels of dimensions, see
+ *        RS_Dimension::updateDim().
+ */
+LC_RegenScheduler::LC_RegenScheduler(bool autoText):
+    autoText(autoText)
+{
+}
+
+/**
+ * Schedules the given entity for regeneration. Entities other than
+ * hatches and dimensions are ignored. Shared resources the entity
+ * needs (patterns, fonts, dimension variables) are loaded here.
+ * Hatch copies get their own copy of the pattern in run(), letters
+ * of fonts are generated under the lock of the font.
+ */
+void LC_RegenScheduler::add(RS_Entity* e) {
+    if (!e) {
+        return;
+    }
+
+    // the inserts of a block with regenerated entities need an update:
+    for (RS_EntityContainer* p = e->getParent(); p; p = p->getParent()) {
+        if (p->rtti()==RS2::EntityBlock) {
+            static_cast<RS_Block*>(p)->setChanged(true);
+            break;
+        }
+    }
+
+    if (e->rtti()==RS2::EntityHatch) {
+        RS_Hatch* h = static_cast<RS_Hatch*>(e);
+        if (h->isSolid()) {
+            // nothing to generate:
+            h->update();
+            return;
+        }
+        RS_PATTERNLIST->requestPattern(h->getPattern());
+        entities.push_back(h);
+    } else if (RS_Information::isDimension(e->rtti())) {
+        RS_Dimension* d = static_cast<RS_Dimension*>(e);
+        d->addMissingVariables();
+        RS_FONTLIST->requestFont(d->getTextStyle());
+        entities.push_back(d);
+    }
+}
+
+/**
+ * Schedules all hatches and dimensions in the given container and
+ * its sub containers.
+ */
+void LC_RegenScheduler::addAll(RS_EntityContainer* container) {
+    if (!container) {
+        return;
+    }
+
+    for (RS_Entity* e: *container) {
+        if (e->rtti()==RS2::EntityHatch || RS_Information::isDimension(e->rtti())) {
+            add(e);
+        } else if (e->isContainer() && e->rtti()!=RS2::EntityInsert) {
+            addAll(static_cast<RS_EntityContainer*>(e));
+        }
+    }
+}
+
+/**
+ * @return Number of scheduled entities.
+ */
+int LC_RegenScheduler::count() const {
+    return static_cast<int>(entities.size());
+}
+
+/**
+ * Regenerates all scheduled entities and returns when they are done.
+ */
+void LC_RegenScheduler::run() {
+    RS_DEBUG->print("LC_RegenScheduler::run: %d entities", count());
+
+    const int threads = QThread::idealThreadCount();
+    if (count() < minParallel || threads < 2) {
+        for (RS_EntityContainer* e: entities) {
+            regenerate(e);
+        }
+        entities.clear();
+        return;
+    }
+
+    // the copies are made here, cloning reads the drawing:
+    std::vector<RS_EntityContainer*> copies;
+    copies.reserve(entities.size());
+    for (RS_EntityContainer* e: entities) {
+        copies.push_back(detachedCopy(e));
+    }
+
+    std::atomic<int> done {0};
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (RS_EntityContainer* c: copies) {
+        pool.start(new RegenJob(c, autoText, done));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    bool progress = false;
+    const QString message = QObject::tr("Regenerating");
+    while (!pool.waitForDone(100)) {
+        if (timer.elapsed() > progressDelay) {
+            progress = true;
+            RS_DIALOGFACTORY->updateProgress(message, done, count());
+        }
+    }
+
+    for (size_t i=0; i<entities.size(); ++i) {
+        entities[i]->adoptEntities(copies[i]);
+        delete copies[i];
+    }
+    if (progress) {
+        RS_DIALOGFACTORY->updateProgress(message, count(), count());
+    }
+
+    RS_DEBUG->print("LC_RegenScheduler::run: OK, %d ms", (int)timer.elapsed());
+    entities.clear();
+}
+
+/**
+ * Regenerates the given entity in place.
+ */
+void LC_RegenScheduler::regenerate(RS_EntityContainer* e) const {
+    if (autoText && RS_Information::isDimension(e->rtti())) {
+        static_cast<RS_Dimension*>(e)->updateDim(true);
+    } else {
+        e->update();
+    }
+}
+
+/**
+ * @return Copy of the given entity which is not part of the drawing.
+ * Hatches are copied without their pattern lines, but with a copy of
+ * the pattern, see RS_Hatch::cloneContour().
+ */
+RS_EntityContainer* LC_RegenScheduler::detachedCopy(RS_EntityContainer* e) const {
+    if (e->rtti()==RS2::EntityHatch) {
+        return static_cast<RS_Hatch*>(e)->cloneContour();
+    }
+    return static_cast<RS_EntityContainer*>(e->clone());
+}
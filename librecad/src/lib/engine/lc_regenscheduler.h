@@ -0,0 +1,65 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU General Public License version 2 as published by the Free Software
+** Foundation and appearing in the file gpl-2.0.txt included in the
+** packaging of this file.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+
+#ifndef LC_REGENSCHEDULER_H
+#define LC_REGENSCHEDULER_H
+
+#include <vector>
+
+class RS_Entity;
+class RS_EntityContainer;
+
+/** \brief Regenerates hatches and dimensions on a thread pool.
+ *
+ * Every entity is regenerated on a detached copy in a worker thread,
+ * so the drawing itself is never modified concurrently. When all
+ * copies are done, the generated sub-entities are attached to the
+ * original entities in the calling thread.
+ * Small batches are updated directly without copies.
+ * Long runs report their progress through the dialog factory.
+ *
+ * Inserts are not scheduled, they only calculate their borders from
+ * the block and depend on the order of block updates, see
+ * RS_Graphic::updateInserts().
+ */
+class LC_RegenScheduler
+{
+public:
+    LC_RegenScheduler(bool autoText = false);
+    ~LC_RegenScheduler() = default;
+
+    void add(RS_Entity* e);
+    void addAll(RS_EntityContainer* container);
+    int count() const;
+    void run();
+
+private:
+    void regenerate(RS_EntityContainer* e) const;
+    RS_EntityContainer* detachedCopy(RS_EntityContainer* e) const;
+
+    //! Update dimension labels too
+    bool autoText {false};
+    std::vector<RS_EntityContainer*> entities;
+};
+
+#endif // LC_REGENSCHEDULER_H
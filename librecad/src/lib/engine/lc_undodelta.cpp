@@ -0,0 +1,224 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU General Public License version 2 as published by the Free Software
+** Foundation and appearing in the file gpl-2.0.txt included in the
+** packaging of this file.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+
+#include <set>
+
+#include "lc_undodelta.h"
+#include "rs_entity.h"
+#include "rs_entitycontainer.h"
+#include "rs_insert.h"
+
+
+/**
+ * @return true if rotating, scaling and mirroring the entity are
+ * undone exactly by the inverse transformation. Moving can always
+ * be undone. Texts and dimensions adjust their angles and alignment
+ * and are copied instead.
+ */
+bool LC_UndoDelta::isInvertible(RS_Entity* e) {
+	if (!e) {
+		return false;
+	}
+	switch (e->rtti()) {
+	case RS2::EntityPoint:
+	case RS2::EntityLine:
+	case RS2::EntityPolyline:
+	case RS2::EntityArc:
+	case RS2::EntityCircle:
+	case RS2::EntityEllipse:
+	case RS2::EntitySolid:
+	case RS2::EntitySpline:
+	case RS2::EntitySplinePoints:
+	case RS2::EntityInsert:
+	case RS2::EntityHatch:
+		return true;
+	default:
+		return false;
+	}
+}
+
+
+
+/**
+ * Adds an entity to be transformed. Entities have to be added
+ * before the transformations.
+ */
+void LC_UndoDelta::addEntity(RS_Entity* e) {
+	if (e) {
+		entities.push_back(e);
+	}
+}
+
+
+
+/**
+ * @return true if the delta doesn't change anything.
+ */
+bool LC_UndoDelta::isEmpty() const {
+	return (entities.empty() || steps.empty()) && attributes.empty();
+}
+
+
+
+/**
+ * @return Bytes used by this delta.
+ */
+size_t LC_UndoDelta::getMemoryUsage() const {
+	return sizeof(LC_UndoDelta)
+			+ entities.capacity()*sizeof(RS_Entity*)
+			+ steps.capacity()*sizeof(Step)
+			+ attributes.capacity()*sizeof(Attributes);
+}
+
+
+
+/**
+ * Moves all entities and keeps the offset for undo.
+ */
+void LC_UndoDelta::move(const RS_Vector& offset) {
+	addStep({Move, offset, RS_Vector(false), 0.});
+}
+
+
+
+/**
+ * Rotates all entities and keeps the rotation for undo.
+ */
+void LC_UndoDelta::rotate(const RS_Vector& center, double angle) {
+	addStep({Rotate, center, RS_Vector(false), angle});
+}
+
+
+
+/**
+ * Scales all entities and keeps the factor for undo.
+ * The factor must not be zero.
+ */
+void LC_UndoDelta::scale(const RS_Vector& center, const RS_Vector& factor) {
+	addStep({Scale, center, factor, 0.});
+}
+
+
+
+/**
+ * Mirrors all entities and keeps the axis for undo.
+ */
+void LC_UndoDelta::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
+	addStep({Mirror, axisPoint1, axisPoint2, 0.});
+}
+
+
+
+/**
+ * Sets layer and pen of the given entity and keeps the old ones for undo.
+ */
+void LC_UndoDelta::setAttributes(RS_Entity* e, RS_Layer* layer, const RS_Pen& pen) {
+	if (!e) {
+		return;
+	}
+	attributes.push_back({e, e->getLayer(false), layer, e->getPen(false), pen});
+	e->setLayer(layer);
+	e->setPen(pen);
+}
+
+
+
+/**
+ * Applies the inverse transformations in reverse order and restores
+ * the old attributes on undo, the transformations and the new
+ * attributes on redo.
+ */
+void LC_UndoDelta::undoStateChanged(bool undone) {
+	for (RS_Entity* e: entities) {
+		if (undone) {
+			for (auto it = steps.rbegin(); it != steps.rend(); ++it) {
+				apply(e, *it, true);
+			}
+		} else {
+			for (Step const& step: steps) {
+				apply(e, step, false);
+			}
+		}
+		if (e->rtti()==RS2::EntityInsert) {
+			static_cast<RS_Insert*>(e)->update();
+		}
+		e->setSelected(false);
+	}
+
+	for (Attributes const& a: attributes) {
+		a.entity->setLayer(undone ? a.oldLayer : a.newLayer);
+		a.entity->setPen(undone ? a.oldPen : a.newPen);
+		a.entity->setSelected(false);
+	}
+
+	calculateBorders();
+}
+
+
+
+void LC_UndoDelta::addStep(const Step& step) {
+	steps.push_back(step);
+	for (RS_Entity* e: entities) {
+		apply(e, step, false);
+		if (e->rtti()==RS2::EntityInsert) {
+			static_cast<RS_Insert*>(e)->update();
+		}
+	}
+	calculateBorders();
+}
+
+
+
+void LC_UndoDelta::apply(RS_Entity* e, const Step& step, bool inverse) const {
+	switch (step.type) {
+	case Move:
+		e->move(inverse ? -step.v1 : step.v1);
+		break;
+	case Rotate:
+		e->rotate(step.v1, inverse ? -step.angle : step.angle);
+		break;
+	case Scale:
+		e->scale(step.v1, inverse ? RS_Vector(1./step.v2.x, 1./step.v2.y) : step.v2);
+		break;
+	case Mirror:
+		e->mirror(step.v1, step.v2);
+		break;
+	}
+}
+
+
+
+/**
+ * Updates the borders of the containers of the transformed entities.
+ */
+void LC_UndoDelta::calculateBorders() {
+	std::set<RS_EntityContainer*> parents;
+	for (RS_Entity* e: entities) {
+		if (e->getParent()) {
+			parents.insert(e->getParent());
+		}
+	}
+	for (RS_EntityContainer* p: parents) {
+		p->calculateBorders();
+	}
+}
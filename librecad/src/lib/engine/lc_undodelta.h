@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU General Public License version 2 as published by the Free Software
+** Foundation and appearing in the file gpl-2.0.txt included in the
+** packaging of this file.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+
+#ifndef LC_UNDODELTA_H
+#define LC_UNDODELTA_H
+
+#include <vector>
+#include "rs_undoable.h"
+#include "rs_pen.h"
+#include "rs_vector.h"
+
+class RS_Entity;
+class RS_Layer;
+
+/**
+ * Undoable for entities which are modified in place. Instead of
+ * keeping the old entities, only the transformations and the old
+ * and new attributes are stored. Undo applies the inverse
+ * transformations in reverse order and restores the old attributes.
+ *
+ * Deltas are owned by the undo cycle they are added to.
+ */
+class LC_UndoDelta : public RS_Undoable {
+public:
+	LC_UndoDelta() = default;
+
+	RS2::UndoableType undoRtti() const override {
+		return RS2::UndoableDelta;
+	}
+
+	static bool isInvertible(RS_Entity* e);
+
+	void addEntity(RS_Entity* e);
+	const std::vector<RS_Entity*>& getEntities() const {
+		return entities;
+	}
+	bool isEmpty() const;
+	size_t getMemoryUsage() const;
+
+	void move(const RS_Vector& offset);
+	void rotate(const RS_Vector& center, double angle);
+	void scale(const RS_Vector& center, const RS_Vector& factor);
+	void mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2);
+	void setAttributes(RS_Entity* e, RS_Layer* layer, const RS_Pen& pen);
+
+	void undoStateChanged(bool undone) override;
+
+private:
+	enum StepType {
+		Move,
+		Rotate,
+		Scale,
+		Mirror
+	};
+
+	//! One transformation of all entities
+	struct Step {
+		StepType type;
+		RS_Vector v1;
+		RS_Vector v2;
+		double angle;
+	};
+
+	//! Attributes of an entity before and after the change
+	struct Attributes {
+		RS_Entity* entity;
+		RS_Layer* oldLayer;
+		RS_Layer* newLayer;
+		RS_Pen oldPen;
+		RS_Pen newPen;
+	};
+
+	void addStep(const Step& step);
+	void apply(RS_Entity* e, const Step& step, bool inverse) const;
+	void calculateBorders();
+
+	std::vector<RS_Entity*> entities;
+	std::vector<Step> steps;
+	std::vector<Attributes> attributes;
+};
+
+#endif
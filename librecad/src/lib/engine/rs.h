@@ -225,6 +225,7 @@ public:
         ActionSelectIntersected,
         ActionDeselectIntersected,
         ActionSelectInvert,
+        ActionSelectCrossings,
         ActionSelectLayer,
         ActionSelectDouble,
         ActionGetSelect,
@@ -435,7 +436,8 @@ public:
     enum UndoableType {
         UndoableUnknown,    /**< Unknown undoable */
         UndoableEntity,     /**< Entity */
-        UndoableLayer       /**< Layer */
+        UndoableLayer,      /**< Layer */
+        UndoableDelta       /**< In place modification of entities */
     };
 
     /**
@@ -896,8 +896,8 @@ void RS_Arc::draw(RS_Painter* painter, RS_GraphicView* view,
 	if (!( painter && view)) return;
 
     //only draw the visible portion of line
-    RS_Vector vpMin(view->toGraph(0,view->getHeight()));
-    RS_Vector vpMax(view->toGraph(view->getWidth(),0));
+    RS_Vector vpMin, vpMax;
+    view->getVisibleArea(vpMin, vpMax);
     QPolygonF visualBox(QRectF(vpMin.x,vpMin.y,vpMax.x-vpMin.x, vpMax.y-vpMin.y));
 
     RS_Vector vpStart(isReversed()?getEndpoint():getStartpoint());
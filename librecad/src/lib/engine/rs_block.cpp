@@ -66,6 +66,38 @@ RS_Entity* RS_Block::clone() const {
 
 
 
+void RS_Block::addEntity(RS_Entity* entity) {
+    RS_Document::addEntity(entity);
+    changed = true;
+}
+
+void RS_Block::appendEntity(RS_Entity* entity) {
+    RS_Document::appendEntity(entity);
+    changed = true;
+}
+
+void RS_Block::prependEntity(RS_Entity* entity) {
+    RS_Document::prependEntity(entity);
+    changed = true;
+}
+
+void RS_Block::insertEntity(int index, RS_Entity* entity) {
+    RS_Document::insertEntity(index, entity);
+    changed = true;
+}
+
+bool RS_Block::removeEntity(RS_Entity* entity) {
+    changed = true;
+    return RS_Document::removeEntity(entity);
+}
+
+void RS_Block::clear() {
+    RS_Document::clear();
+    changed = true;
+}
+
+
+
 RS_LayerList* RS_Block::getLayerList() {
     RS_Graphic* g = getGraphic();
     if (g) {
@@ -117,6 +149,9 @@ void RS_Block::setModified(bool m) {
         p->setModified(m);
     }
     modified = m;
+    if (m) {
+        changed = true;
+    }
 }
 
 
@@ -175,6 +175,7 @@ public:
 	
     /**
      * Sets the parent documents modified status to 'm'.
+     * Setting it also marks the block as changed.
      */
 	virtual void setModified(bool m);
 
@@ -184,6 +185,25 @@ public:
      */
     void setModifiedFlag(bool m) { modified = m; }
 
+    /**
+     * Marks the inserts of this block as outdated. Cleared by
+     * RS_Graphic::updateInserts() once they are regenerated.
+     */
+    void setChanged(bool c) { changed = c; }
+
+    /**
+     * @retval true inserts of this block need to be updated.
+     */
+    bool isChanged() const { return changed; }
+
+    // adding or removing entities marks the block as changed:
+    void addEntity(RS_Entity* entity) override;
+    void appendEntity(RS_Entity* entity) override;
+    void prependEntity(RS_Entity* entity) override;
+    void insertEntity(int index, RS_Entity* entity) override;
+    bool removeEntity(RS_Entity* entity) override;
+    void clear() override;
+
     /**
      * Sets the visibility of the Block in block list
      *
@@ -222,6 +242,8 @@ public:
 protected:
 	//! Block data
 	RS_BlockData data;
+	//! Set if the content changed since the last update of the inserts
+	bool changed {true};
 };
 
 
@@ -28,10 +28,29 @@
 #include <iostream>
 #include <QString>
 #include <QRegExp>
+#include <QHash>
+#include <QSet>
 #include "rs_debug.h"
 #include "rs_blocklist.h"
 #include "rs_block.h"
 #include "rs_blocklistlistener.h"
+#include "rs_insert.h"
+
+namespace {
+/**
+ * Collects the names of all blocks inserted directly into the
+ * given container. Inserts of inserts are not followed.
+ */
+void collectInsertNames(RS_EntityContainer* container, QSet<QString>& names) {
+	for (RS_Entity* e: *container) {
+		if (e->rtti()==RS2::EntityInsert) {
+			names.insert(static_cast<RS_Insert*>(e)->getName());
+		} else if (e->isContainer() && e->rtti()!=RS2::EntityHatch) {
+			collectInsertNames(static_cast<RS_EntityContainer*>(e), names);
+		}
+	}
+}
+}
 
 /**
  * Constructor.
@@ -53,6 +72,7 @@ RS_BlockList::RS_BlockList(bool owner) {
  */
 void RS_BlockList::clear() {
     blocks.clear();
+    blockIndex.clear();
 	activeBlock = nullptr;
 	setModified(true);
 }
@@ -98,6 +118,7 @@ bool RS_BlockList::add(RS_Block* block, bool notify) {
     RS_Block* b = find(block->getName());
 	if (!b) {
         blocks.append(block);
+        blockIndex.insert(block->getName(), block);
 
         if (notify) {
             addNotification();
@@ -140,6 +161,20 @@ void RS_BlockList::remove(RS_Block* block) {
 
     // here the block is removed from the list but not deleted
     blocks.removeOne(block);
+	if (block && blockIndex.value(block->getName())==block) {
+		blockIndex.remove(block->getName());
+	}
+
+    // blocks inserting the removed block have to be regenerated:
+	if (block) {
+		for (RS_Block* b: blocks) {
+			QSet<QString> names;
+			collectInsertNames(b, names);
+			if (names.contains(block->getName())) {
+				b->setChanged(true);
+			}
+		}
+	}
 
 	for(auto l: blockListListeners){
 		l->blockRemoved(block);
@@ -173,6 +208,10 @@ void RS_BlockList::remove(RS_Block* block) {
 bool RS_BlockList::rename(RS_Block* block, const QString& name) {
 	if (block) {
 		if (!find(name)) {
+			if (blockIndex.value(block->getName())==block) {
+				blockIndex.remove(block->getName());
+				blockIndex.insert(name, block);
+			}
 			block->setName(name);
 			setModified(true);
 			return true;
@@ -205,22 +244,7 @@ void RS_BlockList::editBlock(RS_Block* block, const RS_Block& source) {
  * \p nullptr if no such block was found.
  */
 RS_Block* RS_BlockList::find(const QString& name) {
-    try {
-        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): %s", name.toLatin1().constData());
-    }
-    catch(...) {
-        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): wrong name to find");
-        return nullptr;
-    }
-	// Todo : reduce this from O(N) to O(log(N)) complexity based on sorted list or hash
-	//DFS
-	for(RS_Block* b: blocks) {
-		if (b->getName()==name) {
-			return b;
-		}
-	}
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): bad");
-	return nullptr;
+	return blockIndex.value(name, nullptr);
 }
 
 /**
@@ -300,6 +324,102 @@ void RS_BlockList::freezeAll(bool freeze) {
 }
 
 
+/**
+ * Marks all blocks as changed (or unchanged). Used to force a
+ * complete update of all inserts.
+ */
+void RS_BlockList::setAllChanged(bool c) {
+	for (RS_Block* b: blocks) {
+		b->setChanged(c);
+	}
+}
+
+
+/**
+ * @return The blocks whose inserts have to be updated: all changed
+ * blocks and all blocks that insert them directly or indirectly.
+ * Every block is listed once and after all blocks it inserts, so
+ * the list can be processed front to back. Cyclic references are
+ * broken at an arbitrary block.
+ */
+QList<RS_Block*> RS_BlockList::getChangedBlocks() const {
+	QList<RS_Block*> ret;
+
+	bool any = false;
+	for (RS_Block* b: blocks) {
+		if (b->isChanged()) {
+			any = true;
+			break;
+		}
+	}
+	if (!any) {
+		return ret;
+	}
+
+	// dependency graph, edges from a block to the blocks it inserts:
+	QHash<RS_Block*, QList<RS_Block*>> inserted;
+	QHash<RS_Block*, QList<RS_Block*>> insertedBy;
+	for (RS_Block* b: blocks) {
+		QSet<QString> names;
+		collectInsertNames(b, names);
+		for (const QString& n: names) {
+			RS_Block* dep = blockIndex.value(n, nullptr);
+			if (dep) {
+				inserted[b].append(dep);
+				insertedBy[dep].append(b);
+			}
+		}
+	}
+
+	// changed blocks and everything depending on them:
+	QSet<RS_Block*> affected;
+	QList<RS_Block*> queue;
+	for (RS_Block* b: blocks) {
+		if (b->isChanged()) {
+			affected.insert(b);
+			queue.append(b);
+		}
+	}
+	while (!queue.isEmpty()) {
+		RS_Block* b = queue.takeFirst();
+		for (RS_Block* user: insertedBy.value(b)) {
+			if (!affected.contains(user)) {
+				affected.insert(user);
+				queue.append(user);
+			}
+		}
+	}
+
+	// post order depth first search, inserted blocks first:
+	QSet<RS_Block*> visited;
+	for (RS_Block* start: blocks) {
+		if (!affected.contains(start) || visited.contains(start)) {
+			continue;
+		}
+		QList<QPair<RS_Block*, int>> stack;
+		stack.append(qMakePair(start, 0));
+		visited.insert(start);
+		while (!stack.isEmpty()) {
+			RS_Block* b = stack.last().first;
+			const QList<RS_Block*> deps = inserted.value(b);
+			int& i = stack.last().second;
+			if (i < deps.size()) {
+				RS_Block* dep = deps.at(i++);
+				if (affected.contains(dep) && !visited.contains(dep)) {
+					visited.insert(dep);
+					stack.append(qMakePair(dep, 0));
+				}
+			} else {
+				ret.append(b);
+				stack.removeLast();
+			}
+		}
+	}
+
+	return ret;
+}
+
+
 /**
  * Switches on / off the given block. 
  * Listeners are notified.
@@ -30,8 +30,9 @@
 
 
 #include <QList>
+#include <QHash>
+#include <QString>
 
-class QString;
 class RS_Block;
 class RS_BlockListListener;
 
@@ -81,6 +82,9 @@ public:
     void toggle(RS_Block* block);
     void freezeAll(bool freeze);
 
+    void setAllChanged(bool c);
+    QList<RS_Block*> getChangedBlocks() const;
+
     void addListener(RS_BlockListListener* listener);
     void removeListener(RS_BlockListListener* listener);
 
@@ -105,6 +109,8 @@ private:
     bool owner;
     //! Blocks in the graphic
     QList<RS_Block*> blocks;
+    //! Blocks by name, kept in sync with 'blocks'
+    QHash<QString, RS_Block*> blockIndex;
     //! List of registered BlockListListeners
     QList<RS_BlockListListener*> blockListListeners;
     //! Currently active block
@@ -748,8 +748,8 @@ void RS_Circle::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2)
 bool RS_Circle::isVisibleInWindow(RS_GraphicView* view) const
 {
 
-    RS_Vector vpMin(view->toGraph(0,view->getHeight()));
-    RS_Vector vpMax(view->toGraph(view->getWidth(),0));
+    RS_Vector vpMin, vpMax;
+    view->getVisibleArea(vpMin, vpMax);
     QPolygonF visualBox(QRectF(vpMin.x,vpMin.y,vpMax.x-vpMin.x, vpMax.y-vpMin.y));
 	std::vector<RS_Vector> vps;
     for(unsigned short i=0;i<4;i++){
@@ -679,13 +679,12 @@ double RS_Dimension::getTextHeight() {
  * @return Dimension labels alignment text true= horizontal, false= aligned.
  */
 bool RS_Dimension::getInsideHorizontalText() {
-    int v = getGraphicVariableInt("$DIMTIH", 1);
-    if (v>0) {
+    int v = getGraphicVariableInt("$DIMTIH", -1);
+    if (v<0) {
         addGraphicVariable("$DIMTIH", 1, 70);
-        getGraphicVariableInt("$DIMTIH", 1);
-		return true;
+        v = 1;
     }
-	return false;
+	return v>0;
 }
 
 
@@ -693,13 +692,7 @@ bool RS_Dimension::getInsideHorizontalText() {
  * @return Dimension fixed length for extension lines true= fixed, false= not fixed.
  */
 bool RS_Dimension::getFixedLengthOn() {
-    int v = getGraphicVariableInt("$DIMFXLON", 0);
-    if (v == 1) {
-        addGraphicVariable("$DIMFXLON", 1, 70);
-        getGraphicVariableInt("$DIMFXLON", 0);
-		return true;
-    }
-	return false;
+	return getGraphicVariableInt("$DIMFXLON", 0) == 1;
 }
 
 /**
@@ -757,6 +750,25 @@ QString RS_Dimension::getTextStyle() {
 }
 
 
+/**
+ * Adds the dimension variables which are missing in the graphic with
+ * their default values. Afterwards updating a dimension only reads
+ * graphic variables.
+ */
+void RS_Dimension::addMissingVariables() {
+    getGeneralFactor();
+    getGeneralScale();
+    getArrowSize();
+    getTickSize();
+    getExtensionLineExtension();
+    getExtensionLineOffset();
+    getDimensionLineGap();
+    getTextHeight();
+    getInsideHorizontalText();
+    getFixedLength();
+}
+
+
 /**
  * @return the given graphic variable or the default value given in mm
  * converted to the graphic unit.
@@ -889,4 +901,15 @@ void RS_Dimension::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoin
     data.middleOfText.mirror(axisPoint1, axisPoint2);
 }
 
+/**
+ * Takes over the entities of a dimension copy which was updated
+ * detached from the drawing, including the text position set by the update.
+ */
+void RS_Dimension::adoptEntities(RS_EntityContainer* other) {
+	RS_EntityContainer::adoptEntities(other);
+	if (RS_Information::isDimension(other->rtti())) {
+		data.middleOfText = static_cast<RS_Dimension*>(other)->data.middleOfText;
+	}
+}
+
 // EOF
@@ -186,6 +186,7 @@ public:
     RS_Color getExtensionLineColor();
     RS_Color getTextColor();
     QString getTextStyle();
+    void addMissingVariables();
 
         double getGraphicVariable(const QString& key, double defMM, int code);
         static QString stripZerosAngle(QString angle, int zeros=0);
@@ -200,6 +201,7 @@ public:
 		void rotate(const RS_Vector& center, const RS_Vector& angleVector) override;
 		void scale(const RS_Vector& center, const RS_Vector& factor) override;
 		void mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) override;
+		void adoptEntities(RS_EntityContainer* other) override;
 
 private:
     static RS_VectorSolutions  getIntersectionsLineContainer(
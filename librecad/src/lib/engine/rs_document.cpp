@@ -26,10 +26,31 @@
 **********************************************************************/
 
 
+#include <cassert>
+
 #include "rs_document.h"
+#include "rs_information.h"
 #include "rs_debug.h"
 
 
+namespace {
+
+/**
+ * @return true for copies of block entities made by an insert, which
+ *  are released after use and get new ids every time.
+ */
+bool isInsertCopy(RS_Entity const* e) {
+    for (RS_EntityContainer const* p = e->getParent(); p; p = p->getParent()) {
+        if (p->rtti()==RS2::EntityInsert) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+
 /**
  * Constructor.
  *
@@ -58,8 +79,55 @@ void RS_Document::endUndoCycle()
 {
     if (hasUndoable()) {
         setModified(true);
+        intersections.clear();
     }
 
     RS_Undo::endUndoCycle();
 }
 
+bool RS_Document::undo()
+{
+    intersections.clear();
+    return RS_Undo::undo();
+}
+
+bool RS_Document::redo()
+{
+    intersections.clear();
+    return RS_Undo::redo();
+}
+
+/**
+ * Entities are modified in place only within undo cycles, which clear
+ * the cache. Debug builds check every result taken from the cache.
+ */
+RS_VectorSolutions RS_Document::getCachedIntersection(RS_Entity const* e1,
+                                                      RS_Entity const* e2)
+{
+    if (isInsertCopy(e1) || isInsertCopy(e2)) {
+        return RS_Information::getIntersection(e1, e2, true);
+    }
+
+    auto const key = std::make_pair(e1->getId(), e2->getId());
+    auto it = intersections.find(key);
+    if (it != intersections.end()) {
+#ifndef NDEBUG
+        RS_VectorSolutions const sol = RS_Information::getIntersection(e1, e2, true);
+        assert(sol.size()==it->second.size());
+        for (size_t i = 0; i < sol.size(); ++i) {
+            assert(sol.get(i)==it->second.get(i)
+                   || (!sol.get(i).valid && !it->second.get(i).valid));
+        }
+#endif
+        return it->second;
+    }
+
+    // hovering over a large drawing should not grow the cache for ever:
+    if (intersections.size() >= 100000) {
+        intersections.clear();
+    }
+    RS_VectorSolutions const sol = RS_Information::getIntersection(e1, e2, true);
+    intersections.emplace(key, sol);
+    return sol;
+}
+
@@ -29,6 +29,7 @@
 #ifndef RS_DOCUMENT_H
 #define RS_DOCUMENT_H
 
+#include <map>
 #include "rs_layerlist.h"
 #include "rs_entitycontainer.h"
 #include "rs_undo.h"
@@ -67,12 +68,18 @@ public:
     }
 
     /**
-     * Removes an entity from the entiy container. Implementation
-     * from RS_Undo.
+     * Removes an entity from the entiy container it belongs to.
+     * Implementation from RS_Undo.
      */
     virtual void removeUndoable(RS_Undoable* u) {
         if (u && u->undoRtti()==RS2::UndoableEntity && u->isUndone()) {
-			removeEntity(static_cast<RS_Entity*>(u));
+			RS_Entity* e = static_cast<RS_Entity*>(u);
+			RS_EntityContainer* parent = e->getParent();
+			if (parent && parent!=this) {
+				parent->removeEntity(e);
+			} else {
+				removeEntity(e);
+			}
         }
     }
 
@@ -132,6 +139,19 @@ public:
      * Overwritten to set modified flag when undo cycle finished with undoable(s).
      */
     virtual void endUndoCycle() override;
+    bool undo() override;
+    bool redo() override;
+
+    /**
+     * @return Intersections of e1 with e2 on the entities, see
+     * RS_Information::getIntersection(). The results are kept until
+     * the end of the next undo cycle which changes the document, or
+     * the next undo or redo, so every geometry change of entities of
+     * the document must be done within an undo cycle. Copies made by
+     * inserts are not cached.
+     */
+    RS_VectorSolutions getCachedIntersection(RS_Entity const* e1,
+                                             RS_Entity const* e2);
 
     void setGraphicView(RS_GraphicView * g) {gv = g;}
     RS_GraphicView* getGraphicView() {return gv;}
@@ -149,6 +169,10 @@ protected:
 	RS2::FormatType formatType;
     RS_GraphicView * gv;//used to read/save current view
 
+private:
+    //! Intersections by entity ids, see getCachedIntersection()
+    std::map<std::pair<unsigned long, unsigned long>, RS_VectorSolutions> intersections;
+
 };
 
 
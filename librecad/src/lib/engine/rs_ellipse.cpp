@@ -1542,8 +1542,8 @@ void RS_Ellipse::moveRef(const RS_Vector& ref, const RS_Vector& offset) {
 */
 bool RS_Ellipse::isVisibleInWindow(RS_GraphicView* view) const
 {
-    RS_Vector vpMin(view->toGraph(0,view->getHeight()));
-    RS_Vector vpMax(view->toGraph(view->getWidth(),0));
+    RS_Vector vpMin, vpMax;
+    view->getVisibleArea(vpMin, vpMax);
     //viewport
     QRectF visualRect(vpMin.x,vpMin.y,vpMax.x-vpMin.x, vpMax.y-vpMin.y);
     QPolygonF visualBox(visualRect);
@@ -1704,8 +1704,8 @@ void RS_Ellipse::draw(RS_Painter* painter, RS_GraphicView* view, double& pattern
         return;
     }
     //only draw the visible portion of line
-    RS_Vector vpMin(view->toGraph(0,view->getHeight()));
-    RS_Vector vpMax(view->toGraph(view->getWidth(),0));
+    RS_Vector vpMin, vpMax;
+    view->getVisibleArea(vpMin, vpMax);
     QPolygonF visualBox(QRectF(vpMin.x,vpMin.y,vpMax.x-vpMin.x, vpMax.y-vpMin.y));
 
     RS_Vector vpStart(isReversed()?getEndpoint():getStartpoint());
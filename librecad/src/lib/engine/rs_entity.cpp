@@ -28,6 +28,7 @@
 
 #include <iostream>
 #include <utility>
+#include <atomic>
 #include <QPolygon>
 #include <QString>
 
@@ -96,7 +97,8 @@ void RS_Entity::init() {
  * Gives this entity a new unique id.
  */
 void RS_Entity::initId() {
-    static unsigned long int idCounter=0;
+    // entities are also created in worker threads, see LC_RegenScheduler:
+    static std::atomic<unsigned long int> idCounter {0};
     id = idCounter++;
 }
 
@@ -290,8 +292,8 @@ bool RS_Entity::isArc() const
 /** whether the entity's bounding box intersects with visible portion of graphic view */
 bool RS_Entity::isVisibleInWindow(RS_GraphicView* view) const
 {
-    RS_Vector vpMin(view->toGraph(0,view->getHeight()));
-    RS_Vector vpMax(view->toGraph(view->getWidth(),0));
+    RS_Vector vpMin, vpMax;
+    view->getVisibleArea(vpMin, vpMax);
     if( getStartpoint().isInWindowOrdered(vpMin, vpMax) ) return true;
     if( getEndpoint().isInWindowOrdered(vpMin, vpMax) ) return true;
     QPolygonF visualBox(QRectF(vpMin.x,vpMin.y,vpMax.x-vpMin.x, vpMax.y-vpMin.y));
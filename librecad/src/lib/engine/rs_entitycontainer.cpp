@@ -25,9 +25,13 @@
 **********************************************************************/
 
 #include <iostream>
+#include <algorithm>
 #include <cmath>
+#include <map>
 #include <set>
+#include <vector>
 #include <QObject>
+#include <QSet>
 
 #include "rs_dialogfactory.h"
 #include "qg_dialogfactory.h"
@@ -45,6 +49,8 @@
 #include "rs_information.h"
 #include "rs_graphicview.h"
 #include "rs_constructionline.h"
+#include "rs_document.h"
+#include "lc_rect.h"
 
 bool RS_EntityContainer::autoUpdateBorders = true;
 
@@ -85,6 +91,8 @@ RS_EntityContainer::~RS_EntityContainer() {
     if (autoDelete) {
         while (!entities.isEmpty())
             delete entities.takeFirst();
+        for (RS_Entity* e: undoneEntities.keys())
+            delete e;
     } else
         entities.clear();
 }
@@ -127,8 +135,9 @@ void RS_EntityContainer::detach() {
         }
     }
 
-    // clear shared pointers:
+    // clear shared pointers, undone entities are not copied:
     entities.clear();
+    undoneEntities.clear();
     setOwner(autoDel);
 
     // point to new deep copies:
@@ -430,6 +439,9 @@ bool RS_EntityContainer::removeEntity(RS_Entity* entity) {
 	//    in LibreCAD is never called with nullptr
     bool ret;
     ret = entities.removeOne(entity);
+    if (!ret) {
+        ret = undoneEntities.remove(entity) > 0;
+    }
 
     if (autoDelete && ret) {
         delete entity;
@@ -442,6 +454,91 @@ bool RS_EntityContainer::removeEntity(RS_Entity* entity) {
 
 
 
+/**
+ * Moves entities of this container which have been undone from the
+ * entity list to the undone entities and entities which have been
+ * redone back to the position they were taken from, so iterating the
+ * container visits live entities only. Called by the undo cycles
+ * with their entities after changing their undo state.
+ *
+ * Only the given entities are moved. Undone entities are looked up
+ * from the end of the list, where the entities added by the latest
+ * cycle are, and taken out in decreasing order of their index. Redone
+ * entities are then put back in increasing order of their index. With
+ * undo and redo happening in reverse order, they find the list as it
+ * was when they were taken out.
+ */
+void RS_EntityContainer::moveUndoneEntities(const std::vector<RS_Entity*>& changed) {
+    std::vector<std::pair<int, RS_Entity*>> undone;
+    std::vector<std::pair<int, RS_Entity*>> redone;
+    for (RS_Entity* e: changed) {
+        auto it = undoneEntities.find(e);
+        if (e->getFlag(RS2::FlagUndone)) {
+            if (it == undoneEntities.end()) {
+                int const index = entities.lastIndexOf(e);
+                if (index >= 0) {
+                    undone.emplace_back(index, e);
+                }
+            }
+        } else if (it != undoneEntities.end()) {
+            redone.emplace_back(it.value(), e);
+            undoneEntities.erase(it);
+        }
+    }
+
+    std::sort(undone.begin(), undone.end(),
+              [](std::pair<int, RS_Entity*> const& a, std::pair<int, RS_Entity*> const& b) {
+        return a.first > b.first;
+    });
+    for (auto const& u: undone) {
+        entities.removeAt(u.first);
+        undoneEntities.insert(u.second, u.first);
+    }
+
+    std::sort(redone.begin(), redone.end(),
+              [](std::pair<int, RS_Entity*> const& a, std::pair<int, RS_Entity*> const& b) {
+        return a.first < b.first;
+    });
+    for (auto const& r: redone) {
+        entities.insert(std::min(r.first, int(entities.size())), r.second);
+    }
+}
+
+
+
+/**
+ * @return Entities which are undone and kept out of the entity list.
+ */
+std::vector<RS_Entity*> RS_EntityContainer::getUndoneEntities() const {
+    std::vector<RS_Entity*> ret;
+    ret.reserve(undoneEntities.size());
+    for (auto it = undoneEntities.cbegin(); it != undoneEntities.cend(); ++it) {
+        ret.push_back(it.key());
+    }
+    return ret;
+}
+
+
+
+/**
+ * Replaces the entities of this container by the entities of 'other'
+ * and takes over its borders. 'other' is left empty.
+ * Used to attach entities which were generated on a detached copy
+ * of this container, see LC_RegenScheduler.
+ */
+void RS_EntityContainer::adoptEntities(RS_EntityContainer* other) {
+    clear();
+    for (RS_Entity* e: other->entities) {
+        e->setParent(this);
+        entities.append(e);
+    }
+    other->entities.clear();
+    minV = other->minV;
+    maxV = other->maxV;
+}
+
+
+
 /**
  * Erases all entities in this container and resets the borders..
  */
@@ -449,8 +546,11 @@ void RS_EntityContainer::clear() {
     if (autoDelete) {
         while (!entities.isEmpty())
             delete entities.takeFirst();
+        for (RS_Entity* e: undoneEntities.keys())
+            delete e;
     } else
         entities.clear();
+    undoneEntities.clear();
     resetBorders();
 }
 
@@ -688,6 +788,24 @@ void RS_EntityContainer::updateInserts() {
 
 
 
+/**
+ * Updates only the inserts of the blocks with the given names.
+ */
+void RS_EntityContainer::updateInserts(const QSet<QString>& names) {
+    for (RS_Entity* e: entities){
+        if (e->rtti()==RS2::EntityInsert) {
+            RS_Insert* i = static_cast<RS_Insert*>(e);
+            if (names.contains(i->getName())) {
+                i->update();
+            }
+        } else if (e->isContainer() && e->rtti()!=RS2::EntityHatch) {
+            static_cast<RS_EntityContainer*>(e)->updateInserts(names);
+        }
+    }
+}
+
+
+
 /**
  * Renames all inserts with name 'oldName' to 'newName'. This is
  *   called after a block was rename to update the inserts.
@@ -700,7 +818,11 @@ void RS_EntityContainer::renameInserts(const QString& oldName,
 	//        e;
     //        e=nextEntity(RS2::ResolveNone)) {
 
-	for (RS_Entity* e: entities){
+	// undone inserts as well, they might be restored:
+	QList<RS_Entity*> all = entities;
+	all.append(undoneEntities.keys());
+
+	for (RS_Entity* e: all){
         if (e->rtti()==RS2::EntityInsert) {
             RS_Insert* i = ((RS_Insert*)e);
             if (i->getName()==oldName) {
@@ -1298,11 +1420,57 @@ RS_Vector RS_EntityContainer::getNearestDist(double distance,
 
 
 
+namespace {
+/**
+ * Calls f for the entities below container, resolved like
+ * RS2::ResolveAllButTextImage, which can have a point in all the given
+ * areas. Sub-containers outside an area are skipped without resolving
+ * them. Construction lines are infinite and are never skipped.
+ * Copies made by inserts for f are released afterwards, f must not
+ * keep pointers to them.
+ */
+template<class F>
+void forEntitiesInAreas(RS_EntityContainer const* container,
+						std::vector<LC_Rect> const& areas, F const& f) {
+	for (RS_Entity* e: *container) {
+		if (!e->isConstruction()) {
+			LC_Rect const rect{e->getMin(), e->getMax()};
+			if (std::any_of(areas.cbegin(), areas.cend(), [&rect](LC_Rect const& area) {
+							return !area.intersects(rect, RS_TOLERANCE);
+							})) {
+				continue;
+			}
+		}
+		if (e->isContainer() && e->rtti()!=RS2::EntityText && e->rtti()!=RS2::EntityMText) {
+			// inserts hold no entities until they are materialized:
+			RS_Insert* insert = e->rtti()==RS2::EntityInsert ? static_cast<RS_Insert*>(e) : nullptr;
+			bool const copied = insert && !insert->isMaterialized();
+			if (copied) {
+				insert->materialize();
+			}
+			// and splines create their lines on first use:
+			if (e->rtti()==RS2::EntitySpline) {
+				static_cast<RS_Spline*>(e)->materialize();
+			}
+			forEntitiesInAreas(static_cast<RS_EntityContainer*>(e), areas, f);
+			if (copied) {
+				insert->release();
+			}
+		} else {
+			f(e);
+		}
+	}
+}
+}
+
 /**
  * @return The intersection which is closest to 'coord'
+ *
+ * @param range Only intersections closer than range to coord are
+ *        looked for, entities farther away are not tested.
  */
 RS_Vector RS_EntityContainer::getNearestIntersection(const RS_Vector& coord,
-                                                     double* dist) {
+                                                     double* dist, double range) {
 
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist = RS_MAXDOUBLE;  // currently measured distance
@@ -1314,27 +1482,31 @@ RS_Vector RS_EntityContainer::getNearestIntersection(const RS_Vector& coord,
 	closestEntity = getNearestEntity(coord, nullptr, RS2::ResolveAllButTextImage);
 
 	if (closestEntity) {
-        for (RS_Entity* en = firstEntity(RS2::ResolveAllButTextImage);
-             en;
-             en = nextEntity(RS2::ResolveAllButTextImage)) {
+		// an intersection is on both entities and within range:
+		std::vector<LC_Rect> areas{{coord - RS_Vector{range, range},
+									coord + RS_Vector{range, range}}};
+		if (!closestEntity->isConstruction()) {
+			areas.emplace_back(closestEntity->getMin(), closestEntity->getMax());
+		}
+		RS_Document* document = getDocument();
+
+		forEntitiesInAreas(this, areas, [&](RS_Entity* en) {
             if (
                     !en->isVisible()
 					|| en->getParent()->ignoredSnap()
                     ){
-                continue;
+                return;
             }
 
-            sol = RS_Information::getIntersection(closestEntity,
-                                                  en,
-                                                  true);
+			sol = document ? document->getCachedIntersection(closestEntity, en)
+						   : RS_Information::getIntersection(closestEntity, en, true);
 
 			point=sol.getClosest(coord,&curDist,nullptr);
             if(sol.getNumber()>0 && curDist<minDist){
                 closestPoint=point;
                 minDist=curDist;
             }
-
-        }
+		});
     }
 	if(dist && closestPoint.valid) {
         *dist = minDist;
@@ -1445,6 +1617,10 @@ double RS_EntityContainer::getDistanceToPoint(const RS_Vector& coord,
     double curDist;                     // currently measured distance
 	RS_Entity* closestEntity = nullptr;    // closest entity found
 	RS_Entity* subEntity = nullptr;
+	// an insert has to copy its block to return an entity inside it,
+	// only the closest insert is asked for that entity:
+	bool const resolveInserts = level==RS2::ResolveAll || level==RS2::ResolveAllButTextImage;
+	RS_Entity* closestInsert = nullptr;
 
 	for(auto e: entities){
 
@@ -1453,7 +1629,10 @@ double RS_EntityContainer::getDistanceToPoint(const RS_Vector& coord,
             RS_DEBUG->print("entity: %d", e->rtti());
             // bug#426, need to ignore Images to find nearest intersections
             if(level==RS2::ResolveAllButTextImage && e->rtti()==RS2::EntityImage) continue;
-            curDist = e->getDistanceToPoint(coord, &subEntity, level, solidDist);
+            bool const deferred = resolveInserts && e->rtti()==RS2::EntityInsert;
+            subEntity = nullptr;
+            curDist = e->getDistanceToPoint(coord, deferred ? nullptr : &subEntity,
+                                            level, solidDist);
 
             RS_DEBUG->print("entity: getDistanceToPoint: OK");
 
@@ -1476,11 +1655,15 @@ double RS_EntityContainer::getDistanceToPoint(const RS_Vector& coord,
                 default:
                     closestEntity = e;
                 }
+                closestInsert = deferred ? e : nullptr;
                 minDist = curDist;
             }
         }
     }
 
+	if (entity && closestInsert) {
+        closestInsert->getDistanceToPoint(coord, &closestEntity, level, solidDist);
+    }
 	if (entity) {
         *entity = closestEntity;
     }
@@ -1533,122 +1716,170 @@ RS_Entity* RS_EntityContainer::getNearestEntity(const RS_Vector& coord,
  * to do: find closed contour by flood-fill
  */
 bool RS_EntityContainer::optimizeContours() {
-//    std::cout<<"RS_EntityContainer::optimizeContours: begin"<<std::endl;
-
-//    DEBUG_HEADER
-//    std::cout<<"loop with count()="<<count()<<std::endl;
     RS_DEBUG->print("RS_EntityContainer::optimizeContours");
 
-    RS_EntityContainer tmp;
-    tmp.setAutoUpdateBorders(false);
     bool closed=true;
 
     /** accept all full circles **/
-    QList<RS_Entity*> enList;
-	for(auto e1: entities){
+    std::vector<RS_Entity*> sorted;
+    std::vector<RS_Entity*> edges;
+    for(auto e1: entities){
         if (!e1->isEdge() || e1->isContainer() ) {
-            enList<<e1;
+            /** remove unsupported entities */
+            if (autoDelete) {
+                delete e1;
+            }
             continue;
         }
 
         //detect circles and whole ellipses
         switch(e1->rtti()){
         case RS2::EntityEllipse:
-			if(static_cast<RS_Ellipse*>(e1)->isEllipticArc())
-                continue;
+            if(static_cast<RS_Ellipse*>(e1)->isEllipticArc()) {
+                edges.push_back(e1);
+                break;
+            }
             // fall-through
         case RS2::EntityCircle:
             //directly detect circles, bug#3443277
-            tmp.addEntity(e1->clone());
-            enList<<e1;
-            // fall-through
+            sorted.push_back(e1);
+            break;
         default:
-            continue;
+            edges.push_back(e1);
+            break;
         }
+    }
+    entities.clear();
 
+    if (edges.empty() && sorted.empty()) {
+        if (autoUpdateBorders) {
+            calculateBorders();
+        }
+        return false;
     }
-    //    std::cout<<"RS_EntityContainer::optimizeContours: 1"<<std::endl;
 
-    /** remove unsupported entities */
-    for(RS_Entity* it: enList)
-        removeEntity(it);
+    /** index the endpoints by grid cell, cells are larger than the gap tolerance **/
+    std::vector<RS_Vector> starts;
+    std::vector<RS_Vector> ends;
+    double maxCoord = 0.;
+    for (RS_Entity* e: edges) {
+        starts.push_back(e->getStartpoint());
+        ends.push_back(e->getEndpoint());
+        maxCoord = std::max({maxCoord, fabs(starts.back().x), fabs(starts.back().y),
+                             fabs(ends.back().x), fabs(ends.back().y)});
+    }
+    const double cellSize = std::max(1e-6, maxCoord*1e-12);
+    auto const cellOf = [cellSize](const RS_Vector& p) {
+        return std::make_pair(static_cast<long long>(floor(p.x/cellSize)),
+                              static_cast<long long>(floor(p.y/cellSize)));
+    };
+    std::map<std::pair<long long, long long>, std::vector<size_t>> grid;
+    for (size_t i = 0; i < edges.size(); ++i) {
+        grid[cellOf(starts[i])].push_back(i);
+        if (cellOf(ends[i])!=cellOf(starts[i])) {
+            grid[cellOf(ends[i])].push_back(i);
+        }
+    }
+    std::vector<bool> used(edges.size(), false);
+
+    // nearest endpoint of an edge not used yet, searched in the cells around p:
+    auto const findNext = [&](const RS_Vector& p, double& dist) {
+        const auto c = cellOf(p);
+        size_t next = edges.size();
+        dist = RS_MAXDOUBLE;
+        for (long long x = c.first - 1; x <= c.first + 1; ++x) {
+            for (long long y = c.second - 1; y <= c.second + 1; ++y) {
+                auto it = grid.find(std::make_pair(x, y));
+                if (it == grid.end()) {
+                    continue;
+                }
+                for (size_t i: it->second) {
+                    if (used[i]) {
+                        continue;
+                    }
+                    const double d = std::min(p.distanceTo(starts[i]), p.distanceTo(ends[i]));
+                    if (d < dist || (d == dist && i < next)) {
+                        dist = d;
+                        next = i;
+                    }
+                }
+            }
+        }
+        return next;
+    };
 
-    /** check and form a closed contour **/
-//    std::cout<<"RS_EntityContainer::optimizeContours: 2"<<std::endl;
     /** the first entity **/
-	RS_Entity* current(nullptr);
-    if(count()>0) {
-        current=entityAt(0)->clone();
-        tmp.addEntity(current);
-        removeEntity(entityAt(0));
-    }else {
-        if(tmp.count()==0) return false;
-    }
-//    std::cout<<"RS_EntityContainer::optimizeContours: 3"<<std::endl;
+    size_t first = 0;
     RS_Vector vpStart;
     RS_Vector vpEnd;
-	if(current){
-        vpStart=current->getStartpoint();
-        vpEnd=current->getEndpoint();
+    if (!edges.empty()) {
+        used[0] = true;
+        sorted.push_back(edges[0]);
+        vpStart = starts[0];
+        vpEnd = ends[0];
     }
-	RS_Entity* next(nullptr);
-//    std::cout<<"RS_EntityContainer::optimizeContours: 4"<<std::endl;
+
     /** connect entities **/
     const QString errMsg=QObject::tr("Hatch failed due to a gap=%1 between (%2, %3) and (%4, %5)");
 
-    while(count()>0) {
+    for (size_t n = 1; n < edges.size(); ++n) {
         double dist(0.);
-        RS_Vector&& vpTmp=getNearestEndpoint(vpEnd,&dist,&next);
-        if(dist>1e-8) {
+        size_t next = findNext(vpEnd, dist);
+        if (next == edges.size() || dist>1e-8) {
             if(vpEnd.squaredTo(vpStart) < 1e-8) {
-                RS_Entity* e2=entityAt(0);
-                tmp.addEntity(e2->clone());
-                vpStart=e2->getStartpoint();
-                vpEnd=e2->getEndpoint();
-                removeEntity(e2);
+                // contour closed, start the next one:
+                while (used[first]) {
+                    ++first;
+                }
+                used[first] = true;
+                sorted.push_back(edges[first]);
+                vpStart = starts[first];
+                vpEnd = ends[first];
                 continue;
             }
-            else {
-                QG_DIALOGFACTORY->commandMessage(
-                            errMsg.arg(dist).arg(vpTmp.x).arg(vpTmp.y).arg(vpEnd.x).arg(vpEnd.y)
-                            );
-                RS_DEBUG->print(RS_Debug::D_ERROR, "RS_EntityContainer::optimizeContours: hatch failed due to a gap");
-                closed=false;
-                break;
+
+            // the nearest endpoint is only needed for the message:
+            RS_Vector vpTmp(false);
+            dist = RS_MAXDOUBLE;
+            for (size_t i = 0; i < edges.size(); ++i) {
+                if (used[i]) {
+                    continue;
+                }
+                for (const RS_Vector& p: {starts[i], ends[i]}) {
+                    if (vpEnd.distanceTo(p) < dist) {
+                        dist = vpEnd.distanceTo(p);
+                        vpTmp = p;
+                    }
+                }
             }
+            QG_DIALOGFACTORY->commandMessage(
+                        errMsg.arg(dist).arg(vpTmp.x).arg(vpTmp.y).arg(vpEnd.x).arg(vpEnd.y)
+                        );
+            RS_DEBUG->print(RS_Debug::D_ERROR, "RS_EntityContainer::optimizeContours: hatch failed due to a gap");
+            closed=false;
+            break;
         }
-        if(!next) { 	    //workaround if next is nullptr
-//      	    std::cout<<"RS_EntityContainer::optimizeContours: next is nullptr" <<std::endl;
-            RS_DEBUG->print("RS_EntityContainer::optimizeContours: next is nullptr");
-//			closed=false;	//workaround if next is nullptr
-            break;			//workaround if next is nullptr
-        } 					//workaround if next is nullptr
-        if(closed) {
-            next->setProcessed(true);
-            RS_Entity* eTmp = next->clone();
-            if(vpEnd.squaredTo(eTmp->getStartpoint())>vpEnd.squaredTo(eTmp->getEndpoint()))
-                eTmp->revertDirection();
-            vpEnd=eTmp->getEndpoint();
-            tmp.addEntity(eTmp);
-        	removeEntity(next);
-        }
-    }
-//    DEBUG_HEADER
-//    if(vpEnd.valid && vpEnd.squaredTo(vpStart) > 1e-8) {
-//		QG_DIALOGFACTORY->commandMessage(errMsg.arg(vpEnd.distanceTo(vpStart))
-//											 .arg(vpStart.x).arg(vpStart.y).arg(vpEnd.x).arg(vpEnd.y));
-//        RS_DEBUG->print("RS_EntityContainer::optimizeContours: hatch failed due to a gap");
-//        closed=false;
-//    }
-//    std::cout<<"RS_EntityContainer::optimizeContours: 5"<<std::endl;
 
+        RS_Entity* e = edges[next];
+        if(vpEnd.squaredTo(starts[next])>vpEnd.squaredTo(ends[next]))
+            e->revertDirection();
+        vpEnd=e->getEndpoint();
+        used[next] = true;
+        sorted.push_back(e);
+    }
 
-    // add new sorted entities:
-	for(auto en: tmp){
-		en->setProcessed(false);
-        addEntity(en->clone());
+    // entities left by a gap stay in front of the sorted ones:
+    for (size_t i = 0; i < edges.size(); ++i) {
+        if (!used[i]) {
+            entities.append(edges[i]);
+        }
+    }
+    for (RS_Entity* e: sorted) {
+        entities.append(e);
+    }
+    if (autoUpdateBorders) {
+        calculateBorders();
     }
-//    std::cout<<"RS_EntityContainer::optimizeContours: 6"<<std::endl;
 
     if(closed) {
         RS_DEBUG->print("RS_EntityContainer::optimizeContours: OK");
@@ -1656,8 +1887,6 @@ bool RS_EntityContainer::optimizeContours() {
     else {
         RS_DEBUG->print("RS_EntityContainer::optimizeContours: bad");
     }
-//    std::cout<<"RS_EntityContainer::optimizeContours: end: count()="<<count()<<std::endl;
-//    std::cout<<"RS_EntityContainer::optimizeContours: closed="<<closed<<std::endl;
     return closed;
 }
 
@@ -29,8 +29,11 @@
 #define RS_ENTITYCONTAINER_H
 
 #include <vector>
+#include <QHash>
 #include "rs_entity.h"
 
+template <class T> class QSet;
+
 /**
  * Class representing a tree of entities.
  * Typical entity containers are graphics, polylines, groups, texts, ...)
@@ -88,6 +91,8 @@ public:
 	virtual void moveEntity(int index, QList<RS_Entity *>& entList);
     virtual void insertEntity(int index, RS_Entity* entity);
     virtual bool removeEntity(RS_Entity* entity);
+	void moveUndoneEntities(const std::vector<RS_Entity*>& changed);
+	std::vector<RS_Entity*> getUndoneEntities() const;
 
 	//!
 	//! \brief addRectangle add four lines to form a rectangle by
@@ -131,9 +136,11 @@ public:
     }
     virtual void adjustBorders(RS_Entity* entity);
 	void calculateBorders() override;
-	void forcedCalculateBorders();
+	virtual void forcedCalculateBorders();
 	void updateDimensions( bool autoText=true);
     virtual void updateInserts();
+	void updateInserts(const QSet<QString>& names);
+	virtual void adoptEntities(RS_EntityContainer* other);
     virtual void updateSplines();
 	void update() override;
 	virtual void renameInserts(const QString& oldName,
@@ -163,7 +170,7 @@ public:
                                      const RS_Vector& coord,
 									 double* dist = nullptr) const override;
 	RS_Vector getNearestIntersection(const RS_Vector& coord,
-			double* dist = nullptr);
+			double* dist = nullptr, double range = RS_MAXDOUBLE);
     RS_Vector getNearestVirtualIntersection(const RS_Vector& coord,
                                             const double& angle,
                                             double* dist);
@@ -217,6 +224,9 @@ public:
 
 	/**
 	 * @brief begin/end to support range based loop
+	 * Only the entities held by this container are iterated. An
+	 * RS_Insert and RS_Spline hold no entities until materialize() is
+	 * called, firstEntity() / nextEntity() do that.
 	 * @return iterator
 	 */
 	QList<RS_Entity *>::const_iterator begin() const;
@@ -237,6 +247,13 @@ protected:
     /** entities in the container */
     QList<RS_Entity *> entities;
 
+    /**
+     * Entities which are undone, kept out of the entity list for the
+     * undo system, with the index they were taken from, see
+     * moveUndoneEntities().
+     */
+    QHash<RS_Entity*, int> undoneEntities;
+
     /** sub container used only temporarily for iteration. */
     RS_EntityContainer* subContainer;
 
@@ -29,6 +29,15 @@
 #include <iostream>
 #include <QTextStream>
 #include <QTextCodec>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QVector>
 
 #include "rs_font.h"
 #include "rs_arc.h"
@@ -39,6 +48,129 @@
 #include "rs_math.h"
 #include "rs_debug.h"
 
+namespace {
+//! "LFFC", identifies the binary cache of a lff font
+const quint32 lffCacheMagic = 0x4c464643;
+const quint16 lffCacheVersion = 1;
+
+/**
+ * @return The line starting at pos without the line end.
+ *         pos is moved to the next line.
+ */
+QByteArray nextLffLine(const QByteArray& data, int& pos) {
+    int end = data.indexOf('\n', pos);
+    if (end < 0) {
+        end = data.size();
+    }
+    int length = end - pos;
+    if (length > 0 && data.at(end - 1)=='\r') {
+        --length;
+    }
+    QByteArray line = data.mid(pos, length);
+    pos = end + 1;
+    return line;
+}
+
+/**
+ * Parses the lines of a lff letter into the binary form of the cache:
+ * 'C' and the code of a letter to include or 'P', the number of
+ * vertices and x, y and bulge of each vertex of a polyline.
+ */
+QByteArray parseLffGlyph(const QByteArray& text) {
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    int pos = 0;
+    while (pos < text.size()) {
+        QByteArray line = nextLffLine(text, pos);
+
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        // Defined char:
+        if (line.at(0)=='C') {
+            out << quint8('C') << quint16(line.mid(1).trimmed().toInt(nullptr, 16));
+            continue;
+        }
+
+        //sequence:
+        QList<QByteArray> vertex = line.split(';');
+        vertex.removeAll(QByteArray());
+        //at least is required two vertex
+        if (vertex.size()<2) {
+            continue;
+        }
+        QVector<double> values;
+        for (QByteArray const& v: vertex) {
+            QList<QByteArray> coords = v.split(',');
+            coords.removeAll(QByteArray());
+            //at least X,Y is required
+            if (coords.size()<2) {
+                continue;
+            }
+            double bulge = 0;
+            //check presence of bulge
+            if (coords.size() == 3 && coords.at(2).at(0) == 'A') {
+                bulge = coords.at(2).mid(1).toDouble();
+            }
+            values << coords.at(0).toDouble() << coords.at(1).toDouble() << bulge;
+        }
+        out << quint8('P') << quint32(values.size()/3);
+        for (double v: values) {
+            out << v;
+        }
+    }
+    return record;
+}
+
+/**
+ * Parses all letters of a lff font and writes the cache.
+ */
+class LffCacheJob : public QRunnable {
+public:
+    LffCacheJob(const QString& cachePath, const QByteArray& header,
+                const QByteArray& data,
+                const QHash<QChar, RS_Font::LffGlyphRef>& index):
+        cachePath(cachePath), header(header), data(data), index(index) {}
+
+    void run() override {
+        QByteArray records;
+        QHash<QChar, RS_Font::LffGlyphRef> recordIndex;
+        for (auto it = index.constBegin(); it != index.constEnd(); ++it) {
+            RS_Font::LffGlyphRef ref;
+            ref.offset = records.size();
+            records += parseLffGlyph(data.mid(it->offset, it->length));
+            ref.length = records.size() - ref.offset;
+            recordIndex.insert(it.key(), ref);
+        }
+
+        QSaveFile f(cachePath);
+        if (!f.open(QIODevice::WriteOnly)) {
+            RS_DEBUG->print(RS_Debug::D_WARNING,
+                            "LffCacheJob: cannot write %s", qPrintable(cachePath));
+            return;
+        }
+        f.write(header);
+        QDataStream out(&f);
+        out.setVersion(QDataStream::Qt_5_0);
+        out << quint32(recordIndex.size());
+        for (auto it = recordIndex.constBegin(); it != recordIndex.constEnd(); ++it) {
+            out << quint16(it.key().unicode()) << qint32(it->offset) << qint32(it->length);
+        }
+        out << records;
+        f.commit();
+    }
+
+private:
+    QString cachePath;
+    QByteArray header;
+    QByteArray data;
+    QHash<QChar, RS_Font::LffGlyphRef> index;
+};
+}
+
 /**
  * Constructor.
  *
@@ -51,7 +183,7 @@ RS_Font::RS_Font(const QString& fileName, bool owner)
     letterSpacing = 3.0;
     wordSpacing = 6.75;
     lineSpacingFactor = 1.0;
-    rawLffFontList.clear();
+    lffBinary = false;
 }
 
 
@@ -277,23 +409,41 @@ void RS_Font::readCXF(QString path) {
     f.close();
 }
 
+/**
+ * Indexes the letters of a lff font file. The letters are parsed
+ * by generateLffFont() when they are needed. A binary cache of the
+ * parsed letters is written in the background for later sessions.
+ */
 void RS_Font::readLFF(QString path) {
-    QString line;
+    QFileInfo source(path);
+    QString cachePath = getLffCachePath(source);
+    if (readLffCache(cachePath, source)) {
+        RS_DEBUG->print("RS_Font::readLFF: using cache %s", qPrintable(cachePath));
+        return;
+    }
+
     QFile f(path);
     encoding = "UTF-8";
-    f.open(QIODevice::ReadOnly);
-    QTextStream ts(&f);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    lffData = f.readAll();
+    lffBinary = false;
+    f.close();
+
+    QTextCodec* codec = QTextCodec::codecForName("UTF-8");
+    int pos = 0;
 
     // Read line by line until we find a new letter:
-    while (!ts.atEnd()) {
-        line = ts.readLine();
+    while (pos < lffData.size()) {
+        QByteArray line = nextLffLine(lffData, pos);
 
         if (line.isEmpty())
             continue;
 
         // Read font settings:
         if (line.at(0)=='#') {
-            QStringList lst =line.remove(0,1).split(':', QString::SkipEmptyParts);
+            QStringList lst = codec->toUnicode(line).remove(0,1).split(':', QString::SkipEmptyParts);
             //if size is < 2 is a comentary not parameter
             if (lst.size()<2)
                 continue;
@@ -314,7 +464,10 @@ void RS_Font::readLFF(QString path) {
             } else if (identifier.toLower()=="license") {
                 fileLicense = value;
             } else if (identifier.toLower()=="encoding") {
-                ts.setCodec(QTextCodec::codecForName(value.toLatin1()));
+                QTextCodec* c = QTextCodec::codecForName(value.toLatin1());
+                if (c) {
+                    codec = c;
+                }
                 encoding = value;
             } else if (identifier.toLower()=="created") {
                 fileCreate = value;
@@ -324,49 +477,152 @@ void RS_Font::readLFF(QString path) {
         // Add another letter to this font:
         else if (line.at(0)=='[') {
 
-            // uniode character:
-            QChar ch;
-
             // read unicode:
             QRegExp regexp("[0-9A-Fa-f]{1,5}");
-            regexp.indexIn(line);
-            QString cap = regexp.cap();
-            if (!cap.isNull()) {
-				int uCode = cap.toInt(nullptr, 16);
-                ch = QChar(uCode);
-            }
-            // only unicode allowed
-            else {
-                RS_DEBUG->print(RS_Debug::D_WARNING,"Ignoring code from LFF font file: %s",qPrintable(line));
+            if (regexp.indexIn(QString::fromLatin1(line)) < 0) {
+                // only unicode allowed
+                RS_DEBUG->print(RS_Debug::D_WARNING,"Ignoring code from LFF font file: %s", line.constData());
                 continue;
             }
+            QChar ch = QChar(regexp.cap().toInt(nullptr, 16));
 
-            QStringList fontData;
-            do {
-                line = ts.readLine();
-                if(line.isEmpty()) break;
-                fontData.push_back(line);
-            } while(true);
-            if(fontData.size()>0) {
-                rawLffFontList[QString(ch)]=fontData;
+            // the letter ends with an empty line:
+            LffGlyphRef ref;
+            ref.offset = pos;
+            while (pos < lffData.size() && !nextLffLine(lffData, pos).isEmpty()) {
+                ref.length = pos - ref.offset;
             }
+            if (ref.length > 0) {
+                lffIndex[ch] = ref;
+            }
+        }
+    }
 
+    writeLffCache(cachePath, source);
+}
 
-        }
+/**
+ * @return Path of the binary cache for the given lff font file or
+ *         an empty string if there is no cache directory.
+ */
+QString RS_Font::getLffCachePath(const QFileInfo& source) {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty()) {
+        return QString();
     }
-    f.close();
+    dir += QDir::separator() + QString("fonts") + QDir::separator();
+    return dir + source.completeBaseName() + "_"
+            + QString::number(qHash(source.absoluteFilePath()), 16) + ".lffc";
+}
+
+/**
+ * Writes the header of the cache: the source file, to see if the
+ * cache is still valid, and the settings of the font.
+ */
+void RS_Font::writeLffCacheHeader(QDataStream& out, const QFileInfo& source) const {
+    out << lffCacheMagic << lffCacheVersion
+        << source.absoluteFilePath() << source.size()
+        << source.lastModified().toMSecsSinceEpoch()
+        << letterSpacing << wordSpacing << lineSpacingFactor
+        << names << authors << fileLicense << fileCreate << encoding;
+}
+
+/**
+ * Reads the letters from the binary cache.
+ *
+ * @retval false there is no valid cache for the source file.
+ */
+bool RS_Font::readLffCache(const QString& cachePath, const QFileInfo& source) {
+    QFile f(cachePath);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    QString sourcePath;
+    qint64 size = 0;
+    qint64 modified = 0;
+    in >> magic >> version;
+    if (magic!=lffCacheMagic || version!=lffCacheVersion) {
+        return false;
+    }
+    in >> sourcePath >> size >> modified;
+    if (sourcePath!=source.absoluteFilePath() || size!=source.size()
+            || modified!=source.lastModified().toMSecsSinceEpoch()) {
+        return false;
+    }
+
+    double spacing[3];
+    QStringList cachedNames;
+    QStringList cachedAuthors;
+    QString strings[3];
+    in >> spacing[0] >> spacing[1] >> spacing[2]
+       >> cachedNames >> cachedAuthors >> strings[0] >> strings[1] >> strings[2];
+
+    quint32 count = 0;
+    in >> count;
+    QHash<QChar, LffGlyphRef> index;
+    for (quint32 i=0; i<count && in.status()==QDataStream::Ok; ++i) {
+        quint16 code;
+        LffGlyphRef ref;
+        in >> code >> ref.offset >> ref.length;
+        index.insert(QChar(code), ref);
+    }
+    QByteArray data;
+    in >> data;
+
+    if (in.status()!=QDataStream::Ok) {
+        RS_DEBUG->print(RS_Debug::D_WARNING,
+                        "RS_Font::readLffCache: corrupt cache %s", qPrintable(cachePath));
+        return false;
+    }
+
+    letterSpacing = spacing[0];
+    wordSpacing = spacing[1];
+    lineSpacingFactor = spacing[2];
+    names = cachedNames;
+    authors = cachedAuthors;
+    fileLicense = strings[0];
+    fileCreate = strings[1];
+    encoding = strings[2];
+    lffIndex = index;
+    lffData = data;
+    lffBinary = true;
+    return true;
+}
+
+/**
+ * Starts writing the binary cache of this font in the background.
+ * The letters are parsed by the job, not by this font.
+ */
+void RS_Font::writeLffCache(const QString& cachePath, const QFileInfo& source) const {
+    if (cachePath.isEmpty()) {
+        return;
+    }
+    RS_SYSTEM->createPaths(QFileInfo(cachePath).absolutePath());
+
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_0);
+    writeLffCacheHeader(out, source);
+
+    QThreadPool::globalInstance()->start(
+                new LffCacheJob(cachePath, header, lffData, lffIndex));
 }
 
 void RS_Font::generateAllFonts(){
-    QMap<QString, QStringList>::const_iterator i = rawLffFontList.constBegin();
-    while (i != rawLffFontList.constEnd()) {
-        generateLffFont(i.key());
-        ++i;
+    for (auto it = lffIndex.constBegin(); it != lffIndex.constEnd(); ++it) {
+        if (!letterList.find(it.key())) {
+            generateLffFont(it.key());
+        }
     }
 }
 
 RS_Block* RS_Font::generateLffFont(const QString& ch){
-        if(rawLffFontList.contains(ch) == false ){
+        if(ch.size()!=1 || !lffIndex.contains(ch.at(0))){
                 RS_DEBUG->print("RS_Font::generateLffFont(QChar %s ) : can not find the letter in given lff font file",qPrintable(ch));
 				return nullptr;
         }
@@ -375,27 +631,24 @@ RS_Block* RS_Font::generateLffFont(const QString& ch){
 			new RS_FontChar(nullptr, ch, RS_Vector(0.0, 0.0));
 
     // Read entities of this letter:
-    QStringList vertex;
-    QStringList coords;
-    QStringList fontData=rawLffFontList[ch];
-    QString line;
-
-    while(fontData.isEmpty() == false) {
-        line = fontData.takeFirst();
+    LffGlyphRef const ref = lffIndex.value(ch.at(0));
+    QByteArray const raw = lffData.mid(ref.offset, ref.length);
+    QByteArray const record = lffBinary ? raw : parseLffGlyph(raw);
+    QDataStream in(record);
+    in.setVersion(QDataStream::Qt_5_0);
 
-        if (line.isEmpty()) {
-            continue;
-        }
+    while (!in.atEnd() && in.status()==QDataStream::Ok) {
+        quint8 type;
+        in >> type;
 
         // Defined char:
-        if (line.at(0)=='C') {
-            line.remove(0,1);
-			int uCode = line.toInt(nullptr, 16);
+        if (type=='C') {
+            quint16 uCode;
+            in >> uCode;
             QChar ch = QChar(uCode);
             RS_Block* bk = letterList.find(ch);
-			if (!bk && rawLffFontList.contains(ch)) {
-                generateLffFont(ch);
-                bk = letterList.find(ch);
+			if (!bk && lffIndex.contains(ch)) {
+                bk = generateLffFont(ch);
             }
 			if (bk) {
                 RS_Entity* bk2 = bk->clone();
@@ -406,28 +659,14 @@ RS_Block* RS_Font::generateLffFont(const QString& ch){
         }
         //sequence:
         else {
-            vertex = line.split(';', QString::SkipEmptyParts);
-            //at least is required two vertex
-            if (vertex.size()<2)
-                continue;
+            quint32 count;
+            in >> count;
             RS_Polyline* pline = new RS_Polyline(letter, RS_PolylineData());
             pline->setPen(RS_Pen(RS2::FlagInvalid));
 			pline->setLayer(nullptr);
-            for (int i = 0; i < vertex.size(); ++i) {
-                double x1, y1;
-                double bulge = 0;
-
-                coords = vertex.at(i).split(',', QString::SkipEmptyParts);
-                //at least X,Y is required
-                if (coords.size()<2)
-                    continue;
-                x1 = coords.at(0).toDouble();
-                y1 = coords.at(1).toDouble();
-                //check presence of bulge
-                if (coords.size() == 3 && coords.at(2).at(0) == QChar('A')){
-                    QString bulgeStr = coords.at(2);
-                    bulge = bulgeStr.remove(0,1).toDouble();
-                }
+            for (quint32 i = 0; i < count && in.status()==QDataStream::Ok; ++i) {
+                double x1, y1, bulge;
+                in >> x1 >> y1 >> bulge;
                 pline->setNextBulge(bulge);
                 pline->addVertex(RS_Vector(x1, y1), bulge);
             }
@@ -447,11 +686,43 @@ RS_Block* RS_Font::generateLffFont(const QString& ch){
 }
 
 RS_Block* RS_Font::findLetter(const QString& name) {
+    QMutexLocker lock(&letterMutex);
     RS_Block* ret= letterList.find(name);
 	if (ret) return ret;
     return generateLffFont(name);
 
 }
+
+/**
+ * @return The cached letter for the given character. Missing
+ * letters are replaced by QChar(0xfffd).
+ */
+RS_FontGlyph RS_Font::findGlyph(const QChar& ch) {
+    QMutexLocker lock(&letterMutex);
+    auto it = glyphs.constFind(ch);
+    if (it != glyphs.constEnd()) {
+        return it.value();
+    }
+
+    RS_Block* letter = letterList.find(ch);
+	if (!letter) {
+        letter = generateLffFont(ch);
+    }
+	if (!letter) {
+        RS_DEBUG->print("RS_Font::findGlyph: missing font for letter( %s ), replaced it with QChar(0xfffd)",
+                        qPrintable(QString(ch)));
+        letter = letterList.find(QChar(0xfffd));
+    }
+
+    RS_FontGlyph glyph;
+	if (letter) {
+        glyph.letter = letter;
+        glyph.name = letter->getName();
+        glyph.width = letter->getMax().x - letter->getBasePoint().x;
+    }
+    glyphs.insert(ch, glyph);
+    return glyph;
+}
 /**
  * Dumps the fonts data to stdout.
  */
@@ -31,8 +31,26 @@
 #include <iosfwd>
 #include <QStringList>
 #include <QMap>
+#include <QHash>
+#include <QMutex>
 #include "rs_blocklist.h"
 
+class QDataStream;
+class QFileInfo;
+
+/**
+ * Letter of a font as used by texts. All characters of all texts
+ * showing the same letter share its block and name.
+ */
+struct RS_FontGlyph {
+	//! Letter block, nullptr if neither the letter nor a replacement exist
+	RS_Block* letter {nullptr};
+	//! Name of the letter block
+	QString name;
+	//! Right border of the letter at height 9.0
+	double width {0.0};
+};
+
 /**
  * Class for representing a font. This is implemented as a RS_Graphic
  * with a name (the font name) and several blocks, one for each letter
@@ -99,6 +117,7 @@ public:
 		return &letterList;
 	}
     RS_Block* findLetter(const QString& name);
+    RS_FontGlyph findGlyph(const QChar& ch);
 //    RS_Block* findLetter(const QString& name) {
 //		return letterList.find(name);
 //	}
@@ -112,15 +131,35 @@ public:
     friend std::ostream& operator << (std::ostream& os, const RS_Font& l);
 
     friend class RS_FontList;
+    //! Tests the lff cache, see LC_SimpleTests::slotTestLffCache()
+    friend class LC_SimpleTests;
+
+    //! Position of a letter in the lff font file or the cache
+    struct LffGlyphRef {
+        int offset {0};
+        int length {0};
+    };
 
 private:
     void readCXF(QString path);
     void readLFF(QString path);
+    static QString getLffCachePath(const QFileInfo& source);
+    bool readLffCache(const QString& cachePath, const QFileInfo& source);
+    void writeLffCache(const QString& cachePath, const QFileInfo& source) const;
+    void writeLffCacheHeader(QDataStream& out, const QFileInfo& source) const;
     RS_Block* generateLffFont(const QString& ch);
 
 private:
-    //raw lff font file list, not processed into blocks yet
-    QMap<QString, QStringList> rawLffFontList;
+    //! lff font file or, if lffBinary is set, letters parsed by the cache
+    QByteArray lffData;
+    bool lffBinary;
+    //! letters of lffData, not processed into blocks yet
+    QHash<QChar, LffGlyphRef> lffIndex;
+
+    //! Letters requested by texts, including replaced missing letters
+    QHash<QChar, RS_FontGlyph> glyphs;
+    //! Guards letter generation, texts are also updated by worker threads
+    QMutex letterMutex;
 
         //! block list (letters)
         RS_BlockList letterList;
@@ -0,0 +1,93 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2010 R. van Twisk (librecad@rvt.dds.nl)
+** Copyright (C) 2001-2003 RibbonSoft. All rights reserved.
+**
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU General Public License version 2 as published by the Free Software
+** Foundation and appearing in the file gpl-2.0.txt included in the
+** packaging of this file.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "rs_fontchar.h"
+#include "rs_arc.h"
+#include "rs_line.h"
+#include "rs_math.h"
+
+
+/**
+ * Calculates the borders of the letter and collects its outline.
+ * Letters are not changed once the font is loaded, so the outline
+ * is shared by all texts using the letter.
+ */
+void RS_FontChar::calculateBorders() {
+	RS_Block::calculateBorders();
+
+	outline.clear();
+	addOutline(this);
+}
+
+
+
+/**
+ * Adds the end points of lines and a polygon around every arc of
+ * the given container to the outline.
+ */
+void RS_FontChar::addOutline(RS_EntityContainer* container) {
+	for (RS_Entity* e: *container) {
+		switch (e->rtti()) {
+		case RS2::EntityLine: {
+			RS_Line* l = static_cast<RS_Line*>(e);
+			outline.push_back(l->getStartpoint());
+			outline.push_back(l->getEndpoint());
+			break;
+		}
+
+		case RS2::EntityArc: {
+			// corners of the tangents at the ends of arc segments of
+			// at most 22.5 degrees:
+			RS_Arc* a = static_cast<RS_Arc*>(e);
+			double const len = a->getAngleLength();
+			int const n = std::max(1, static_cast<int>(std::ceil(len/(M_PI/8.))));
+			double const step = (a->isReversed() ? -len : len)/n;
+			double const r = a->getRadius()/cos(0.5*step);
+			outline.push_back(a->getStartpoint());
+			for (int i=0; i<n; ++i) {
+				outline.push_back(a->getCenter()
+								  + RS_Vector::polar(r, a->getAngle1() + (i+0.5)*step));
+			}
+			outline.push_back(a->getEndpoint());
+			break;
+		}
+
+		default:
+			if (e->isContainer()) {
+				addOutline(static_cast<RS_EntityContainer*>(e));
+			} else {
+				outline.push_back(e->getMin());
+				outline.push_back(e->getMax());
+				outline.push_back(RS_Vector(e->getMin().x, e->getMax().y));
+				outline.push_back(RS_Vector(e->getMax().x, e->getMin().y));
+			}
+			break;
+		}
+	}
+}
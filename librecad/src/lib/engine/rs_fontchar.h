@@ -28,6 +28,7 @@
 #ifndef RS_FONTCHAR_H
 #define RS_FONTCHAR_H
 
+#include <vector>
 #include "rs_block.h"
 
 
@@ -47,7 +48,10 @@ public:
     RS_FontChar(RS_EntityContainer* parent,
                 const QString& name,
                 RS_Vector basePoint)
-            : RS_Block(parent, RS_BlockData(name, basePoint, false)) {}
+            : RS_Block(parent, RS_BlockData(name, basePoint, false)) {
+		// letters don't change once the font is loaded
+		setChanged(false);
+	}
 
     virtual ~RS_FontChar() {}
 
@@ -56,6 +60,15 @@ public:
         return RS2::EntityFontChar;
     }
 
+	void calculateBorders() override;
+
+	/**
+	 * @return Points around the letter. Transformed with the letter,
+	 *         they enclose it at any angle.
+	 */
+	const std::vector<RS_Vector>& getOutline() const {
+		return outline;
+	}
 
     /*friend std::ostream& operator << (std::ostream& os, const RS_FontChar& b) {
        	os << " name: " << b.getName().latin1() << "\n";
@@ -65,6 +78,10 @@ public:
 
 
 protected:
+	void addOutline(RS_EntityContainer* container);
+
+	//! Points enclosing the letter
+	std::vector<RS_Vector> outline;
 };
 
 
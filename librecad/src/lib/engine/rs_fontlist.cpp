@@ -26,11 +26,17 @@
 
 #include <iostream>
 #include <QHash>
+#include <QMutex>
 #include "rs_fontlist.h"
 #include "rs_debug.h"
 #include "rs_font.h"
 #include "rs_system.h"
 
+namespace {
+//! Fonts are also requested from worker threads, see LC_RegenScheduler
+QMutex fontMutex;
+}
+
 RS_FontList* RS_FontList::uniqueInstance = nullptr;
 
 RS_FontList* RS_FontList::instance() {
@@ -107,15 +113,18 @@ RS_Font* RS_FontList::requestFont(const QString& name) {
     RS_DEBUG->print("name2: %s", name2.toLatin1().data());
 
 	// Search our list of available fonts:
-	for( auto const& f: fonts){
-
-        if (f->getFileName()==name2) {
-            // Make sure this font is loaded into memory:
-            f->loadFont();
-			foundFont = f.get();
-            break;
-        }
-    }
+	{
+		QMutexLocker lock(&fontMutex);
+		for( auto const& f: fonts){
+
+			if (f->getFileName()==name2) {
+				// Make sure this font is loaded into memory:
+				f->loadFont();
+				foundFont = f.get();
+				break;
+			}
+		}
+	}
 
 	if (!foundFont && name!="standard") {
         foundFont = requestFont("standard");
@@ -27,6 +27,7 @@
 #include <iostream>
 #include <cmath>
 #include <QDir>
+#include <QSet>
 //#include <QDebug>
 
 #include "rs_graphic.h"
@@ -124,6 +125,37 @@ unsigned long int RS_Graphic::countLayerEntities(RS_Layer* layer) {
 
 
 
+/**
+ * Updates the inserts of changed blocks. Blocks inserting a changed
+ * block are regenerated as well, each block only once and after the
+ * blocks it depends on. Only inserts of the graphic referencing one
+ * of these blocks are updated.
+ * Callers which need a complete refresh (e.g. after layer or window
+ * changes) mark all blocks with RS_BlockList::setAllChanged() first.
+ */
+void RS_Graphic::updateInserts() {
+    RS_DEBUG->print("RS_Graphic::updateInserts");
+
+    QList<RS_Block*> changed = blockList.getChangedBlocks();
+    if (changed.isEmpty()) {
+        return;
+    }
+
+    QSet<QString> names;
+    for (RS_Block* b: changed) {
+        // all blocks inserted by b are up to date at this point:
+        b->updateInserts(names);
+        b->calculateBorders();
+        b->setChanged(false);
+        names.insert(b->getName());
+    }
+    RS_EntityContainer::updateInserts(names);
+
+    RS_DEBUG->print("RS_Graphic::updateInserts: %d blocks OK", changed.size());
+}
+
+
+
 /**
  * Removes the given layer and undoes all entities on it.
  */
@@ -168,6 +200,21 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
 			e->setLayer("0");
 		}
 
+		// entities which are already undone keep their state, but must
+		// not refer to the removed layer when they are restored:
+		std::vector<RS_Entity*> undone = getUndoneEntities();
+		for(RS_Block* blk: blockList){
+			if(!blk) continue;
+			std::vector<RS_Entity*> blkUndone = blk->getUndoneEntities();
+			undone.insert(undone.end(), blkUndone.begin(), blkUndone.end());
+		}
+		for(auto e: undone){
+			if (e->getLayer() &&
+					e->getLayer()->getName()==layer->getName()) {
+				e->setLayer("0");
+			}
+		}
+
         layerList.remove(layer);
     }
 }
@@ -96,6 +96,8 @@ public:
         layerList.add(layer);
     }
     virtual void addEntity(RS_Entity* entity);
+    using RS_EntityContainer::updateInserts;
+    virtual void updateInserts();
     virtual void removeLayer(RS_Layer* layer);
     virtual void editLayer(RS_Layer* layer, const RS_Layer& source) {
         layerList.edit(layer, source);
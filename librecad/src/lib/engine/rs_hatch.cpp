@@ -23,11 +23,16 @@
 ** This copyright notice MUST APPEAR in all copies of the script!
 **
 **********************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <climits>
 #include <iostream>
 #include <cmath>
 #include <memory>
+#include <vector>
 #include <QPainterPath>
 #include <QBrush>
+#include <QTransform>
 #include <QString>
 #include "rs_hatch.h"
 
@@ -46,6 +51,10 @@
 #include "rs_math.h"
 #include "rs_debug.h"
 
+namespace {
+//! Read by worker threads, see LC_RegenScheduler
+std::atomic<bool> renderPatterns {false};
+}
 
 RS_HatchData::RS_HatchData(bool _solid,
 						   double _scale,
@@ -80,6 +89,20 @@ RS_Hatch::RS_Hatch(RS_EntityContainer* parent,
 
 
 
+/**
+ * Line patterns are drawn at paint time when on. Patterns with
+ * curves always create pattern entities.
+ */
+void RS_Hatch::setRenderPatterns(bool on) {
+    renderPatterns = on;
+}
+
+bool RS_Hatch::getRenderPatterns() {
+    return renderPatterns;
+}
+
+
+
 /**
  * Validates the hatch.
  */
@@ -114,6 +137,28 @@ RS_Entity* RS_Hatch::clone() const{
 }
 
 
+/**
+ * @return Copy of this hatch without the pattern lines. The copy is
+ * not updated, unlike clone(). It gets its own copy of the pattern,
+ * so it can be updated in a worker thread without the pattern list.
+ */
+RS_Hatch* RS_Hatch::cloneContour() const {
+    RS_Hatch* t = new RS_Hatch(*this);
+    t->setOwner(isOwner());
+    t->initId();
+    t->detach();
+    t->hatch = nullptr;
+    t->updateRunning = false;
+    if (!data.solid) {
+        const RS_Pattern* pattern = RS_PATTERNLIST->requestPattern(data.pattern);
+        if (pattern) {
+            t->detachedPattern.reset(static_cast<RS_Pattern*>(pattern->clone()));
+        }
+    }
+    return t;
+}
+
+
 /**
  * @return Number of loops.
  */
@@ -157,6 +202,7 @@ void RS_Hatch::update() {
 
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update");
 
+    boundaryValid = false;
     updateError = HATCH_OK;
     if (updateRunning) {
         RS_DEBUG->print(RS_Debug::D_NOTICE, "RS_Hatch::update: skip hatch in updating process");
@@ -186,6 +232,8 @@ void RS_Hatch::update() {
         removeEntity(hatch);
 		hatch = nullptr;
     }
+    patternRendered = false;
+    patternLines.clear();
 
     if (isUndone()) {
         RS_DEBUG->print(RS_Debug::D_NOTICE, "RS_Hatch::update: skip undone hatch");
@@ -202,42 +250,30 @@ void RS_Hatch::update() {
 
     // search for pattern
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: requesting pattern");
-    RS_Pattern* pat = RS_PATTERNLIST->requestPattern(data.pattern);
-	if (!pat) {
+    const RS_Pattern* pattern = detachedPattern ? detachedPattern.get()
+                                                : RS_PATTERNLIST->requestPattern(data.pattern);
+	if (!pattern) {
         updateRunning = false;
         RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: requesting pattern: not found");
         updateError = HATCH_PATTERN_NOT_FOUND;
         return;
-    } else {
-        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: requesting pattern: OK");
-        // make a working copy of hatch pattern
-        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cloning pattern");
-        pat = (RS_Pattern*)pat->clone();
-        if (pat) {
-            RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cloning pattern: OK");
-        } else {
-            RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: error while cloning hatch pattern");
-            return;
-        }
     }
-
-    // scale pattern
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: scaling pattern");
-    pat->scale(RS_Vector(0.0,0.0), RS_Vector(data.scale, data.scale));
-    pat->calculateBorders();
+    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: requesting pattern: OK");
     forcedCalculateBorders();
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: scaling pattern: OK");
+
+    // scaled pattern tile:
+    const RS_Vector tile1 = pattern->getMin()*data.scale;
+    const RS_Vector tile2 = pattern->getMax()*data.scale;
 
     // find out how many pattern-instances we need in x/y:
     int px1, py1, px2, py2;
-    double f;
     RS_Hatch* copy = (RS_Hatch*)this->clone();
     copy->rotate(RS_Vector(0.0,0.0), -data.angle);
     copy->forcedCalculateBorders();
 
     // create a pattern over the whole contour.
-    RS_Vector pSize = pat->getSize();
-    RS_Vector rot_center=pat->getMin();
+    RS_Vector pSize = RS_Vector::maximum(tile1, tile2) - RS_Vector::minimum(tile1, tile2);
+    RS_Vector rot_center = RS_Vector::minimum(tile1, tile2);
 //    RS_Vector cPos = getMin();
     RS_Vector cSize = getSize();
 
@@ -249,60 +285,492 @@ void RS_Hatch::update() {
             pSize.x<1.0e-6 || pSize.y<1.0e-6 ||
             cSize.x>RS_MAXDOUBLE-1 || cSize.y>RS_MAXDOUBLE-1 ||
             pSize.x>RS_MAXDOUBLE-1 || pSize.y>RS_MAXDOUBLE-1) {
-        delete pat;
         delete copy;
         updateRunning = false;
         RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: contour size or pattern size too small");
         updateError = HATCH_TOO_SMALL;
         return;
     }
-    // avoid huge memory consumption:
-    else if ( cSize.x* cSize.y/(pSize.x*pSize.y)>1e4) {
+
+    // lines are trimmed per line family, curves are still copied for
+    // every pattern instance:
+    const bool hasCurves = pattern->hasCurves();
+
+    // pattern lines, scaled and rotated like the pattern tile:
+    std::vector<std::pair<RS_Vector, RS_Vector>> lines;
+    double length = 0.;
+    for (const RS_PatternLine& l: pattern->getLines()) {
+        RS_Vector start = l.origin*data.scale;
+        RS_Vector end = (l.origin + RS_Vector(l.angle)*l.length)*data.scale;
+        start.rotate(rot_center, data.angle);
+        end.rotate(rot_center, data.angle);
+        lines.emplace_back(start - rot_center, end - rot_center);
+        length += l.length*fabs(data.scale);
+    }
+
+    // line patterns can be drawn from the lines of one tile:
+    if (renderPatterns && !hasCurves && !keepPattern) {
+        delete copy;
+        patternLines = std::move(lines);
+        patternDx = RS_Vector(data.angle)*pSize.x;
+        patternDy = RS_Vector(data.angle+M_PI*0.5)*pSize.y;
+        patternDensity = length/(pSize.x*pSize.y);
+        patternRendered = true;
+
+        forcedCalculateBorders();
+        activateContour(false);
+        updateRunning = false;
+        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: pattern drawn at paint time");
+        return;
+    }
+
+    // calculate pattern pieces quantity
+    double const px1f = floor(copy->getMin().x/pSize.x);
+    double const py1f = floor(copy->getMin().y/pSize.y);
+    double const px2f = ceil(copy->getMax().x/pSize.x);
+    double const py2f = ceil(copy->getMax().y/pSize.y);
+
+    // lines are trimmed row by row and are not limited, but curves are
+    // still copied and intersected with the contour for every tile:
+    double const tiles = cSize.x*cSize.y/(pSize.x*pSize.y);
+    if ((hasCurves && tiles>1e4)
+            || std::max(fabs(px1f), fabs(px2f)) > INT_MAX/2
+            || std::max(fabs(py1f), fabs(py2f)) > INT_MAX/2) {
         RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: contour size too large or pattern size too small");
-        delete pat;
         delete copy;
+        updateRunning = false;
         updateError = HATCH_AREA_TOO_BIG;
         return;
     }
 
-    // calculate pattern pieces quantity
-    f = copy->getMin().x/pSize.x;
-    px1 = (int)floor(f);
-    f = copy->getMin().y/pSize.y;
-    py1 = (int)floor(f);
-    f = copy->getMax().x/pSize.x;
-    px2 = (int)ceil(f);
-    f = copy->getMax().y/pSize.y;
-    py2 = (int)ceil(f);
+    px1 = (int)px1f;
+    py1 = (int)py1f;
+    px2 = (int)px2f;
+    py2 = (int)py2f;
     RS_Vector dvx=RS_Vector(data.angle)*pSize.x;
     RS_Vector dvy=RS_Vector(data.angle+M_PI*0.5)*pSize.y;
-    pat->rotate(rot_center, data.angle);
-    pat->move(-rot_center);
 
-    RS_EntityContainer tmp;   // container for untrimmed lines
+    delete copy;
+    copy = nullptr;
+
+    // add the hatch pattern entities
+    hatch = new RS_EntityContainer(this);
+    hatch->setPen(hatch_pen);
+    hatch->setLayer(hatch_layer);
+    hatch->setFlag(RS2::FlagTemp);
+
+    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: trimming pattern lines");
+    for (const auto& l: lines) {
+        addPatternLine(l.first, l.second, dvx, dvy, px1, px2, py1, py2);
+    }
+    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: trimming pattern lines: OK");
+
+    // only curves need a working copy of the pattern:
+    if (hasCurves) {
+        std::unique_ptr<RS_EntityContainer> pat(static_cast<RS_EntityContainer*>(pattern->clone()));
+        pat->scale(RS_Vector(0.0,0.0), RS_Vector(data.scale, data.scale));
+        pat->rotate(rot_center, data.angle);
+        pat->move(-rot_center);
+        addPatternCurves(pat.get(), dvx, dvy, px1, px2, py1, py2);
+    }
+
+    addEntity(hatch);
+    //getGraphic()->addEntity(rubbish);
+
+    forcedCalculateBorders();
+
+    // deactivate contour:
+    activateContour(false);
+
+    updateRunning = false;
+
+    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: OK");
+}
+
+
+
+namespace {
+
+/**
+ * Line at offset c across the pattern lines with dashes starting at
+ * t + m*period along the line, or a single dash at t if period is 0.
+ */
+struct PatternRow {
+    double c;
+    double t;
+    double period;
+};
+
+/**
+ * Part of a contour edge which is monotone across the pattern lines.
+ * Lines run from point to point + u, arcs and ellipses are at
+ * point + u*cos(a) + v*sin(a) for angles a from a1 to a2.
+ */
+struct ScanEdge {
+    bool line;
+    RS_Vector point;
+    RS_Vector u;
+    RS_Vector v;
+    double a1;
+    double a2;
+    //! offsets of the ends across the lines
+    double c1;
+    double c2;
+    //! start of the half turn holding the angles, sign of cos(a - psi) in it
+    double base;
+    double sign;
+
+    double lo() const {
+        return std::min(c1, c2);
+    }
+    double hi() const {
+        return std::max(c1, c2);
+    }
+
+    /**
+     * Half open crossing test, an end on the line only counts on one
+     * side of it. Vertices and tangent points are so counted once or
+     * twice for each pair of edges meeting there, which keeps the
+     * parity of the crossings right.
+     */
+    bool crosses(double c) const {
+        return (c1 > c) != (c2 > c);
+    }
+
+    //! @return position along the lines of the crossing with the line at c
+    double crossing(double c, const RS_Vector& n, const RS_Vector& d) const {
+        if (line) {
+            return RS_Vector::dotP(d, point + u*((c - c1)/(c2 - c1)));
+        }
+        double const nu = RS_Vector::dotP(n, u);
+        double const nv = RS_Vector::dotP(n, v);
+        double const w = (c - RS_Vector::dotP(n, point))/std::hypot(nu, nv);
+        double const a = base + acos(std::max(-1., std::min(1., sign*w)));
+        return RS_Vector::dotP(d, point + u*cos(a) + v*sin(a));
+    }
+};
+
+/**
+ * Splits a contour edge into parts monotone across the pattern lines
+ * with normal n.
+ */
+void addScanEdges(RS_Entity* edge, const RS_Vector& n, std::vector<ScanEdge>& edges) {
+    RS_Vector center, u, v;
+    double start = 0., length = 2.*M_PI;
+    switch (edge->rtti()) {
+    case RS2::EntityLine: {
+        RS_Vector const p1 = edge->getStartpoint();
+        RS_Vector const p2 = edge->getEndpoint();
+        double const c1 = RS_Vector::dotP(n, p1);
+        double const c2 = RS_Vector::dotP(n, p2);
+        edges.push_back({true, p1, p2 - p1, {}, 0., 0., c1, c2, 0., 1.});
+        return;
+    }
+    case RS2::EntityArc: {
+        auto arc = static_cast<RS_Arc*>(edge);
+        center = arc->getCenter();
+        u = RS_Vector(arc->getRadius(), 0.);
+        v = RS_Vector(0., arc->getRadius());
+        start = arc->isReversed() ? arc->getAngle2() : arc->getAngle1();
+        length = arc->getAngleLength();
+        break;
+    }
+    case RS2::EntityCircle: {
+        auto circle = static_cast<RS_Circle*>(edge);
+        center = circle->getCenter();
+        u = RS_Vector(circle->getRadius(), 0.);
+        v = RS_Vector(0., circle->getRadius());
+        break;
+    }
+    case RS2::EntityEllipse: {
+        auto ellipse = static_cast<RS_Ellipse*>(edge);
+        center = ellipse->getCenter();
+        u = ellipse->getMajorP();
+        v = RS_Vector(-u.y, u.x)*ellipse->getRatio();
+        if (ellipse->isEllipticArc()) {
+            start = ellipse->isReversed() ? ellipse->getAngle2() : ellipse->getAngle1();
+            length = ellipse->getAngleLength();
+        }
+        break;
+    }
+    default:
+        RS_DEBUG->print(RS_Debug::D_WARNING, "RS_Hatch: unsupported contour edge %d", edge->rtti());
+        return;
+    }
+
+    // offset across the lines is n.center + cos(a - psi)*|(n.u, n.v)|,
+    // monotone between multiples of pi from psi:
+    double const psi = atan2(RS_Vector::dotP(n, v), RS_Vector::dotP(n, u));
+    auto const offset = [&](double a) {
+        return RS_Vector::dotP(n, center + u*cos(a) + v*sin(a));
+    };
+    double const end = start + length;
+    double k = floor((start - psi)/M_PI);
+    double a1 = start;
+    while (a1 < end && k < floor((end - psi)/M_PI) + 1.) {
+        double const base = psi + k*M_PI;
+        double const a2 = std::min(base + M_PI, end);
+        if (a2 > a1) {
+            double const sign = fmod(k, 2.) == 0. ? 1. : -1.;
+            edges.push_back({false, center, u, v, a1, a2, offset(a1), offset(a2), base, sign});
+            a1 = a2;
+        }
+        k += 1.;
+    }
+}
+
+//! @return x, y with a*x + b*y == gcd(a, b)
+int extendedGcd(int a, int b, int& x, int& y) {
+    if (b == 0) {
+        x = a < 0 ? -1 : 1;
+        y = 0;
+        return std::abs(a);
+    }
+    int x1, y1;
+    int const g = extendedGcd(b, a % b, x1, y1);
+    x = y1;
+    y = x1 - (a / b)*y1;
+    return g;
+}
+
+}
+
+
+
+/**
+ * Adds the parts of all instances of a pattern line which are inside
+ * the contour to the hatch.
+ *
+ * All instances are parallel. If a combination p*dvx + q*dvy of the
+ * tile offsets is parallel to the pattern line, the instances form
+ * rows at equidistant offsets, with dashes repeated by that
+ * combination along each row. Otherwise every instance is a row on
+ * its own. The rows are processed in the order of their offset,
+ * sweeping over the contour edges, split into parts monotone across
+ * the rows and sorted by their extent, so only edges which can cross
+ * a row are intersected with it. The parts of a row inside the
+ * contour follow from the parity of the sorted crossings, the dashes
+ * of the row are calculated for each of them.
+ */
+void RS_Hatch::addPatternLine(const RS_Vector& a, const RS_Vector& b,
+                              const RS_Vector& dvx, const RS_Vector& dvy,
+                              int px1, int px2, int py1, int py2) {
+    double const length = a.distanceTo(b);
+    // dots get the direction of the pattern rows:
+    RS_Vector const d = length > RS_TOLERANCE ? (b - a)/length
+                                              : dvx/dvx.magnitude();
+    RS_Vector const n(-d.y, d.x);
+
+    // extent of the contour edges across (c) and along (t) the lines:
+    std::vector<ScanEdge> edges;
+    double cMin = RS_MAXDOUBLE, cMax = -RS_MAXDOUBLE;
+    double tMin = RS_MAXDOUBLE, tMax = -RS_MAXDOUBLE;
+    for (RS_Entity* loop: entities) {
+        if (!loop->isContainer()) {
+            continue;
+        }
+        for (RS_Entity* edge: *static_cast<RS_EntityContainer*>(loop)) {
+            RS_Vector const v1 = edge->getMin();
+            RS_Vector const v2 = edge->getMax();
+            for (RS_Vector const& corner: {v1, v2, RS_Vector(v1.x, v2.y), RS_Vector(v2.x, v1.y)}) {
+                double const t = RS_Vector::dotP(d, corner);
+                tMin = std::min(tMin, t);
+                tMax = std::max(tMax, t);
+            }
+            addScanEdges(edge, n, edges);
+        }
+    }
+    for (ScanEdge const& e: edges) {
+        cMin = std::min(cMin, e.lo());
+        cMax = std::max(cMax, e.hi());
+    }
+    if (edges.empty()) {
+        return;
+    }
+    double const tolC = 1.0e-9*(1.0 + std::max(fabs(cMin), fabs(cMax)));
+    double const tolT = 1.0e-9*(1.0 + std::max(fabs(tMin), fabs(tMax)));
+
+    // instance (px, py) is at offset c0 + px*cx + py*cy, from
+    // t0 + px*tx + py*ty along the line:
+    double const c0 = RS_Vector::dotP(n, a);
+    double const t0 = RS_Vector::dotP(d, a);
+    double const cx = RS_Vector::dotP(n, dvx);
+    double const cy = RS_Vector::dotP(n, dvy);
+    double const tx = RS_Vector::dotP(d, dvx);
+    double const ty = RS_Vector::dotP(d, dvy);
+
+    // smallest p*dvx + q*dvy along the line, its offset across the
+    // line may not add up to more than tolC over the contour:
+    const int maxStep = 32;
+    int p = 0, q = 0;
+    double const span = tMax - tMin + length;
+    for (int i = 0; i <= maxStep && p == 0 && q == 0; ++i) {
+        for (int j = -i; j <= i; ++j) {
+            for (auto const& pq: {std::make_pair(i, j), std::make_pair(j, i)}) {
+                if (pq.first == 0 && pq.second == 0) {
+                    continue;
+                }
+                double const period = fabs(pq.first*tx + pq.second*ty);
+                double const drift = fabs(pq.first*cx + pq.second*cy);
+                if (period > tolT && drift*(span/period + 1.0) < tolC) {
+                    p = pq.first;
+                    q = pq.second;
+                    break;
+                }
+            }
+            if (p != 0 || q != 0) {
+                break;
+            }
+        }
+    }
+
+    std::vector<PatternRow> rows;
+    int r = 0, s = 0;
+    if ((p != 0 || q != 0) && extendedGcd(p, q, s, r) == 1) {
+        // (r, s) completes (p, q) to a basis of all tiles, rows are at
+        // c0 + k*dc with dashes from t0 + k*dt every period:
+        r = -r;
+        double const dc = r*cx + s*cy;
+        double const dt = r*tx + s*ty;
+        double const period = fabs(p*tx + q*ty);
+        double k1 = ceil((cMin - tolC - c0)/dc);
+        double k2 = floor((cMax + tolC - c0)/dc);
+        if (dc < 0.) {
+            k1 = ceil((cMax + tolC - c0)/dc);
+            k2 = floor((cMin - tolC - c0)/dc);
+        }
+        for (double k = k1; k <= k2; k += 1.) {
+            rows.push_back({c0 + k*dc, t0 + k*dt, period});
+        }
+    } else {
+        for (int px=px1; px<px2; px++) {
+            for (int py=py1; py<py2; py++) {
+                double const c = c0 + px*cx + py*cy;
+                double const t = t0 + px*tx + py*ty;
+                if (c >= cMin - tolC && c <= cMax + tolC
+                        && t <= tMax && t + length >= tMin) {
+                    rows.push_back({c, t, 0.});
+                }
+            }
+        }
+    }
+    std::sort(rows.begin(), rows.end(),
+              [](PatternRow const& r1, PatternRow const& r2) {
+        return r1.c < r2.c;
+    });
+    std::sort(edges.begin(), edges.end(),
+              [](ScanEdge const& e1, ScanEdge const& e2) {
+        return e1.lo() < e2.lo();
+    });
+
+    auto addDash = [this, &d](RS_Vector const& p0, double s0, double s1) {
+        RS_Line* te = new RS_Line{hatch, p0 + d*s0, p0 + d*s1};
+        te->setPen(hatch->getPen(false));
+        te->setLayer(hatch->getLayer(false));
+        hatch->addEntity(te);
+    };
+
+    std::vector<ScanEdge> active;
+    size_t nextEdge = 0;
+    std::vector<double> crossings;
+    std::vector<std::pair<double, double>> inside;
+    size_t i = 0;
+    while (i < rows.size()) {
+        // rows [i, j) are on the line at offset c:
+        double const c = rows[i].c;
+        size_t j = i + 1;
+        while (j < rows.size() && rows[j].c - c < tolC) {
+            ++j;
+        }
+
+        while (nextEdge < edges.size() && edges[nextEdge].lo() <= c + tolC) {
+            active.push_back(edges[nextEdge++]);
+        }
+        active.erase(std::remove_if(active.begin(), active.end(),
+                                    [c, tolC](ScanEdge const& e) {
+            return e.hi() < c - tolC;
+        }), active.end());
+
+        // crossings of the line with the contour:
+        RS_Vector const p0 = n*c;
+        crossings.clear();
+        for (ScanEdge const& e: active) {
+            if (e.crosses(c)) {
+                crossings.push_back(e.crossing(c, n, d));
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        // parts of the line inside the contour, by even-odd parity:
+        inside.clear();
+        for (size_t k = 1; k < crossings.size(); k += 2) {
+            if (crossings[k] - crossings[k-1] < tolT) {
+                continue;
+            }
+            if (!inside.empty() && crossings[k-1] - inside.back().second < tolT) {
+                inside.back().second = crossings[k];
+            } else {
+                inside.emplace_back(crossings[k-1], crossings[k]);
+            }
+        }
+
+        // trim the dashes of the rows to the parts inside:
+        for (; i < j; ++i) {
+            PatternRow const& row = rows[i];
+            for (auto const& part: inside) {
+                if (row.period <= 0.) {
+                    double const s0 = std::max(row.t, part.first);
+                    double const s1 = std::min(row.t + length, part.second);
+                    if (s1 >= s0) {
+                        addDash(p0, s0, s1);
+                    }
+                    continue;
+                }
+                double const m1 = ceil((part.first - length - row.t)/row.period);
+                double const m2 = floor((part.second - row.t)/row.period);
+                for (double m = m1; m <= m2; m += 1.) {
+                    double const t = row.t + m*row.period;
+                    double const s0 = std::max(t, part.first);
+                    double const s1 = std::min(t + length, part.second);
+                    if (s1 >= s0) {
+                        addDash(p0, s0, s1);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+
+/**
+ * Adds the parts of all instances of the curves of the pattern which
+ * are inside the contour to the hatch. Every instance is intersected
+ * with the contour.
+ */
+void RS_Hatch::addPatternCurves(RS_EntityContainer* pat, const RS_Vector& dvx, const RS_Vector& dvy,
+                                int px1, int px2, int py1, int py2) {
+    RS_EntityContainer tmp;   // container for untrimmed curves
 
     // adding array of patterns to tmp:
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: creating pattern carpet");
     for (int px=px1; px<px2; px++) {
 		for (int py=py1; py<py2; py++) {
 			for(auto e: *pat){
+                if (e->rtti()==RS2::EntityLine) {
+                    continue;
+                }
                 RS_Entity* te=e->clone();
                 te->move(dvx*px + dvy*py);
                 tmp.addEntity(te);
             }
         }
     }
-
-    // clean memory
-    delete pat;
-    pat = nullptr;
-    delete copy;
-    copy = nullptr;
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: creating pattern carpet: OK");
 
     // cut pattern to contour shape
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cutting pattern carpet");
-    RS_EntityContainer tmp2;   // container for small cut lines
+    RS_EntityContainer tmp2;   // container for small cut arcs
 	RS_Line* line = nullptr;
 	RS_Arc* arc = nullptr;
 	RS_Circle* circle = nullptr;
@@ -471,15 +939,6 @@ void RS_Hatch::update() {
     // updating hatch / adding entities that are inside
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cutting pattern carpet: OK");
 
-    //RS_EntityContainer* rubbish = new RS_EntityContainer(getGraphic());
-
-    // add the hatch pattern entities
-    hatch = new RS_EntityContainer(this);
-    hatch->setPen(hatch_pen);
-    hatch->setLayer(hatch_layer);
-    hatch->setFlag(RS2::FlagTemp);
-
-    //calculateBorders();
 	for(auto e: tmp2){
 
         RS_Vector middlePoint;
@@ -508,25 +967,49 @@ void RS_Hatch::update() {
                     RS_Information::isPointInsideContour(middlePoint2, this)) {
 
                 RS_Entity* te = e->clone();
-                te->setPen(hatch_pen);
-                te->setLayer(hatch_layer);
+                te->setPen(hatch->getPen(false));
+                te->setLayer(hatch->getLayer(false));
                 te->reparent(hatch);
                 hatch->addEntity(te);
             }
         }
     }
+}
 
-    addEntity(hatch);
-    //getGraphic()->addEntity(rubbish);
-
-    forcedCalculateBorders();
 
-    // deactivate contour:
-    activateContour(false);
 
-    updateRunning = false;
+/**
+ * Takes over the pattern of a hatch copy which was updated
+ * detached from the drawing. The contour of this hatch is kept.
+ */
+void RS_Hatch::adoptEntities(RS_EntityContainer* other) {
+    if (other->rtti()!=RS2::EntityHatch) {
+        RS_EntityContainer::adoptEntities(other);
+        return;
+    }
+    RS_Hatch* h = static_cast<RS_Hatch*>(other);
 
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: OK");
+    if (hatch) {
+        removeEntity(hatch);
+        hatch = nullptr;
+    }
+    updateError = h->updateError;
+    boundaryValid = false;
+    patternRendered = h->patternRendered;
+    patternLines = std::move(h->patternLines);
+    patternDx = h->patternDx;
+    patternDy = h->patternDy;
+    patternDensity = h->patternDensity;
+
+    if (h->hatch) {
+        h->entities.removeOne(h->hatch);
+        hatch = h->hatch;
+        h->hatch = nullptr;
+        hatch->setParent(this);
+        entities.append(hatch);
+        activateContour(false);
+    }
+    forcedCalculateBorders();
 }
 
 
@@ -553,13 +1036,33 @@ void RS_Hatch::activateContour(bool on) {
         RS_DEBUG->print("RS_Hatch::activateContour: OK");
 }
 
+
+
+/**
+ * Creates the pattern entities of a hatch whose pattern is drawn at
+ * paint time, e.g. before it is exploded.
+ */
+void RS_Hatch::materializePattern() {
+    if (!patternRendered) {
+        return;
+    }
+    keepPattern = true;
+    update();
+    keepPattern = false;
+}
+
 //#include<QDebug>
 /**
- * Overrides drawing of subentities. This is only ever called for solid fills.
+ * Overrides drawing of subentities. Solid fills and patterns drawn at
+ * paint time are drawn here, pattern entities by the view.
  */
 void RS_Hatch::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patternOffset*/) {
 
     if (!data.solid) {
+        if (patternRendered) {
+            drawPattern(painter, view);
+            return;
+        }
         foreach (auto se, entities){
 
             view->drawEntity(painter,se);
@@ -567,11 +1070,41 @@ void RS_Hatch::draw(RS_Painter* painter, RS_GraphicView* view, double& /*pattern
         return;
     }
 
-    //area of solid fill. Use polygon approximation, except trivial cases
-    QPainterPath path;
-    QList<QPolygon> paClosed;
-    QPolygon pa;
-//    QPolygon jp;   // jump points
+    const QPainterPath path = toGui(view).map(getBoundaryPath());
+
+    //bug#474, restore brush after solid fill
+    const QBrush brush(painter->brush());
+    const RS_Pen pen=painter->getPen();
+    painter->setBrush(pen.getColor());
+    painter->disablePen();
+    painter->drawPath(path);
+    painter->setBrush(brush);
+    painter->setPen(pen);
+}
+
+
+
+/**
+ * @return Transformation from drawing to screen coordinates.
+ */
+QTransform RS_Hatch::toGui(const RS_GraphicView* view) {
+    return QTransform(view->getFactor().x, 0., 0., -view->getFactor().y,
+                      view->toGuiX(0.), view->toGuiY(0.));
+}
+
+
+
+/**
+ * @return Contour of the hatch in drawing coordinates. The path is
+ * kept until the next update(), arcs and ellipses are added as curves
+ * so the path is exact at any zoom.
+ */
+const QPainterPath& RS_Hatch::getBoundaryPath() {
+    if (boundaryValid) {
+        return boundaryPath;
+    }
+    boundaryPath = QPainterPath();
+    boundaryValid = true;
 
     // loops:
     if (needOptimization==true) {
@@ -586,137 +1119,163 @@ void RS_Hatch::draw(RS_Painter* painter, RS_GraphicView* view, double& /*pattern
         needOptimization = false;
     }
 
+    // QPainterPath angles run clockwise in drawing coordinates:
+    auto const arcRect = [](const RS_Vector& c, double rx, double ry) {
+        return QRectF(c.x - rx, c.y - ry, 2.*rx, 2.*ry);
+    };
+    // edges are joined by lines, like gaps in the polygons before:
+    auto const connect = [](QPainterPath& path, const RS_Vector& p) {
+        if (path.elementCount()==0) {
+            path.moveTo(p.x, p.y);
+        } else if (path.currentPosition()!=QPointF(p.x, p.y)) {
+            path.lineTo(p.x, p.y);
+        }
+    };
+
     // loops:
     foreach (auto l, entities){
         l->setLayer(getLayer());
 
-        if (l->rtti()==RS2::EntityContainer) {
-            RS_EntityContainer* loop = (RS_EntityContainer*)l;
+        if (l->rtti()!=RS2::EntityContainer) {
+            continue;
+        }
+        RS_EntityContainer* loop = (RS_EntityContainer*)l;
+        QPainterPath path;
 
-            // edges:
-			for(auto e: *loop){
-
-                e->setLayer(getLayer());
-                switch (e->rtti()) {
-                case RS2::EntityLine: {
-                    QPoint pt1(RS_Math::round(view->toGuiX(e->getStartpoint().x)),
-                               RS_Math::round(view->toGuiY(e->getStartpoint().y)));
-                    QPoint pt2(RS_Math::round(view->toGuiX(e->getEndpoint().x)),
-                               RS_Math::round(view->toGuiY(e->getEndpoint().y)));
-
-//                    if (! (pa.size()>0 && (pa.last() - pt1).manhattanLength()<=2)) {
-//                        jp<<pt1;
-//                    }
-                    if(pa.size() && (pa.last()-pt1).manhattanLength()>=1)
-                        pa<<pt1;
-                    pa<<pt2;
-                }
-                    break;
+        // edges:
+        for(auto e: *loop){
 
-                case RS2::EntityArc: {
-//                    QPoint pt1(RS_Math::round(view->toGuiX(e->getStartpoint().x)),
-//                               RS_Math::round(view->toGuiY(e->getStartpoint().y)));
-//                    if (! (pa.size()>0 && (pa.last() - pt1).manhattanLength()<=2)) {
-//                        jp<<pt1;
-//                    }
+            e->setLayer(getLayer());
 
-                    QPolygon pa2;
-                    RS_Arc* arc=static_cast<RS_Arc*>(e);
+            switch (e->rtti()) {
+            case RS2::EntityLine: {
+                connect(path, e->getStartpoint());
+                const RS_Vector end = e->getEndpoint();
+                path.lineTo(end.x, end.y);
+            }
+                break;
 
-                    painter->createArc(pa2, view->toGui(arc->getCenter()),
-                                       view->toGuiDX(arc->getRadius())
-                                       ,arc->getAngle1(),arc->getAngle2(),arc->isReversed());
-                    if(pa.size() &&pa2.size()&&(pa.last()-pa2.first()).manhattanLength()<1)
-                        pa2.remove(0,1);
-                    pa<<pa2;
+            case RS2::EntityArc: {
+                connect(path, e->getStartpoint());
+                RS_Arc* arc=static_cast<RS_Arc*>(e);
+                const double sweep = arc->isReversed() ? -arc->getAngleLength()
+                                                       : arc->getAngleLength();
+                path.arcTo(arcRect(arc->getCenter(), arc->getRadius(), arc->getRadius()),
+                           -RS_Math::rad2deg(arc->getAngle1()),
+                           -RS_Math::rad2deg(sweep));
+            }
+                break;
 
-                }
-                    break;
+            case RS2::EntityCircle: {
+                RS_Circle* circle = static_cast<RS_Circle*>(e);
+                const RS_Vector c = circle->getCenter();
+                boundaryPath.addEllipse(QPointF(c.x, c.y),
+                                        circle->getRadius(), circle->getRadius());
+            }
+                break;
 
-                case RS2::EntityCircle: {
-                    RS_Circle* circle = static_cast<RS_Circle*>(e);
-//                    QPoint pt1(RS_Math::round(view->toGuiX(circle->getCenter().x+circle->getRadius())),
-//                               RS_Math::round(view->toGuiY(circle->getCenter().y)));
-//                    if (! (pa.size()>0 && (pa.last() - pt1).manhattanLength()<=2)) {
-//                        jp<<pt1;
-//                    }
-
-                    RS_Vector c=view->toGui(circle->getCenter());
-                    double r=view->toGuiDX(circle->getRadius());
-                    path.addEllipse(QPoint(c.x,c.y),r,r);
-//                    QPolygon pa2;
-//                    painter->createArc(pa2, view->toGui(circle->getCenter()),
-//                                       view->toGuiDX(circle->getRadius()),
-//                                       0.0,
-//                                       2*M_PI,
-//                                       false);
-//                    pa<<pa2;
-                }
-                    break;
-                case RS2::EntityEllipse:
-                if(static_cast<RS_Ellipse*>(e)->isArc()) {
-                    QPolygon pa2;
-                    auto ellipse=static_cast<RS_Ellipse*>(e);
-
-                    painter->createEllipse(pa2,
-                                           view->toGui(ellipse->getCenter()),
-                                           view->toGuiDX(ellipse->getMajorRadius()),
-                                           view->toGuiDX(ellipse->getMinorRadius()),
-                                           ellipse->getAngle()
-                                           ,ellipse->getAngle1(),ellipse->getAngle2(),ellipse->isReversed()
-                                           );
-//                    qDebug()<<"ellipse: "<<ellipse->getCenter().x<<","<<ellipse->getCenter().y;
-//                    qDebug()<<"ellipse: pa2.size()="<<pa2.size();
-//                    qDebug()<<"ellipse: pa2="<<pa2;
-                    if(pa.size() && pa2.size()&&(pa.last()-pa2.first()).manhattanLength()<1)
-                        pa2.remove(0,1);
-                    pa<<pa2;
-                }else{
-                    QPolygon pa2;
-                    auto ellipse=static_cast<RS_Ellipse*>(e);
-                    painter->createEllipse(pa2,
-                                           view->toGui(ellipse->getCenter()),
-                                           view->toGuiDX(ellipse->getMajorRadius()),
-                                           view->toGuiDX(ellipse->getMinorRadius()),
-                                           ellipse->getAngle(),
-                                           ellipse->getAngle1(), ellipse->getAngle2(),
-                                           ellipse->isReversed()
-                                           );
-                    path.addPolygon(pa2);
+            case RS2::EntityEllipse: {
+                auto ellipse=static_cast<RS_Ellipse*>(e);
+                // axis aligned at the origin, then rotated into place:
+                const RS_Vector c = ellipse->getCenter();
+                QTransform t;
+                t.translate(c.x, c.y);
+                t.rotateRadians(ellipse->getAngle());
+                const double rx = ellipse->getMajorRadius();
+                const double ry = ellipse->getMinorRadius();
+                QPainterPath local;
+                if (ellipse->isArc()) {
+                    connect(path, e->getStartpoint());
+                    const double sweep = ellipse->isReversed() ? -ellipse->getAngleLength()
+                                                               : ellipse->getAngleLength();
+                    local.arcMoveTo(arcRect(RS_Vector(0., 0.), rx, ry),
+                                    -RS_Math::rad2deg(ellipse->getAngle1()));
+                    local.arcTo(arcRect(RS_Vector(0., 0.), rx, ry),
+                                -RS_Math::rad2deg(ellipse->getAngle1()),
+                                -RS_Math::rad2deg(sweep));
+                    path.connectPath(t.map(local));
+                } else {
+                    local.addEllipse(QPointF(0., 0.), rx, ry);
+                    boundaryPath.addPath(t.map(local));
                 }
-                    break;
-                default:
-                    break;
-                }
-//                qDebug()<<"pa="<<pa;
-                if( pa.size()>2 && pa.first() == pa.last()) {
-                    paClosed<<pa;
-                    pa.clear();
-                }
-
             }
+                break;
 
+            default:
+                break;
+            }
+        }
+        if (path.elementCount()>0) {
+            path.closeSubpath();
+            boundaryPath.addPath(path);
         }
-    }
-    if(pa.size()>2){
-        pa<<pa.first();
-        paClosed<<pa;
     }
 
-    for(auto& p:paClosed){
-        path.addPolygon(p);
-    }
+    return boundaryPath;
+}
 
-    //bug#474, restore brush after solid fill
-    const QBrush brush(painter->brush());
-    const RS_Pen pen=painter->getPen();
-    painter->setBrush(pen.getColor());
-    painter->disablePen();
-    painter->drawPath(path);
-    painter->setBrush(brush);
-    painter->setPen(pen);
 
 
+/**
+ * Draws the pattern lines clipped to the contour. Patterns which are
+ * too dense for the current zoom are drawn as a tone fill instead,
+ * with the share of pixels the lines would cover.
+ */
+void RS_Hatch::drawPattern(RS_Painter* painter, RS_GraphicView* view) {
+    const QPainterPath path = toGui(view).map(getBoundaryPath());
+    const double coverage = patternDensity/view->getFactor().x;
+
+    // tiles in the visible part of the hatch:
+    RS_Vector vpMin, vpMax;
+    view->getVisibleArea(vpMin, vpMax);
+    const RS_Vector areaMin = RS_Vector::maximum(vpMin, getMin());
+    const RS_Vector areaMax = RS_Vector::minimum(vpMax, getMax());
+    if (areaMin.x > areaMax.x || areaMin.y > areaMax.y) {
+        return;
+    }
+    double iMin = RS_MAXDOUBLE, iMax = -RS_MAXDOUBLE;
+    double jMin = RS_MAXDOUBLE, jMax = -RS_MAXDOUBLE;
+    for (const RS_Vector& corner: {areaMin, areaMax,
+                                   RS_Vector(areaMin.x, areaMax.y),
+                                   RS_Vector(areaMax.x, areaMin.y)}) {
+        const double i = RS_Vector::dotP(corner, patternDx)/patternDx.squared();
+        const double j = RS_Vector::dotP(corner, patternDy)/patternDy.squared();
+        iMin = std::min(iMin, i);
+        iMax = std::max(iMax, i);
+        jMin = std::min(jMin, j);
+        jMax = std::max(jMax, j);
+    }
+    // tile lines may reach into the neighbouring tiles:
+    iMin = floor(iMin) - 1.;
+    jMin = floor(jMin) - 1.;
+    iMax = ceil(iMax);
+    jMax = ceil(jMax);
+    const double lines = (iMax - iMin + 1.)*(jMax - jMin + 1.)*patternLines.size();
+
+    if (coverage > 0.5 || lines > view->getWidth()*view->getHeight()
+            || !painter->pushClipPath(path)) {
+        const QBrush brush(painter->brush());
+        const RS_Pen pen = painter->getPen();
+        RS_Color color = pen.getColor();
+        color.setAlphaF(std::min(1., std::max(coverage, 0.1)));
+        painter->setBrush(color);
+        painter->disablePen();
+        painter->drawPath(path);
+        painter->setBrush(brush);
+        painter->setPen(pen);
+        return;
+    }
+
+    for (double i = iMin; i <= iMax; i += 1.) {
+        for (double j = jMin; j <= jMax; j += 1.) {
+            const RS_Vector offset = patternDx*i + patternDy*j;
+            for (const auto& l: patternLines) {
+                painter->drawLine(view->toGui(l.first + offset),
+                                  view->toGui(l.second + offset));
+            }
+        }
+    }
+    painter->popClipPath();
 }
 
 //must be called after update()
@@ -740,7 +1299,8 @@ double RS_Hatch::getDistanceToPoint(
     RS2::ResolveLevel level,
     double solidDist) const {
 
-    if (data.solid==true) {
+    // patterns drawn at paint time have no entities to pick:
+    if (data.solid==true || patternRendered) {
         if (entity) {
             *entity = const_cast<RS_Hatch*>(this);
         }
@@ -28,9 +28,15 @@
 #ifndef RS_HATCH_H
 #define RS_HATCH_H
 
+#include <memory>
+#include <vector>
+#include <QPainterPath>
 #include "rs_entity.h"
 #include "rs_entitycontainer.h"
 
+class QTransform;
+class RS_Pattern;
+
 /**
  * Holds the data that defines a hatch entity.
  */
@@ -82,6 +88,7 @@ public:
             const RS_HatchData& d);
 
 	RS_Entity* clone() const override;
+	RS_Hatch* cloneContour() const;
 
     /**	@return RS2::EntityHatch */
 	RS2::EntityType rtti() const override{
@@ -135,10 +142,19 @@ public:
 
 		void calculateBorders() override;
 		void update() override;
+		void adoptEntities(RS_EntityContainer* other) override;
         int getUpdateError() {
                 return updateError;
         }
         void activateContour(bool on);
+		void materializePattern();
+
+		/**
+		 * Draw line patterns at paint time instead of creating
+		 * pattern lines. Applies to hatches updated afterwards.
+		 */
+		static void setRenderPatterns(bool on);
+		static bool getRenderPatterns();
 
 		void draw(RS_Painter* painter, RS_GraphicView* view,
 						  double& patternOffset) override;
@@ -164,12 +180,39 @@ public:
 
         friend std::ostream& operator << (std::ostream& os, const RS_Hatch& p);
 
+private:
+		void addPatternLine(const RS_Vector& a, const RS_Vector& b,
+							const RS_Vector& dvx, const RS_Vector& dvy,
+							int px1, int px2, int py1, int py2);
+		void addPatternCurves(RS_EntityContainer* pat, const RS_Vector& dvx, const RS_Vector& dvy,
+							  int px1, int px2, int py1, int py2);
+		static QTransform toGui(const RS_GraphicView* view);
+		const QPainterPath& getBoundaryPath();
+		void drawPattern(RS_Painter* painter, RS_GraphicView* view);
+
 protected:
         RS_HatchData data;
         RS_EntityContainer* hatch;
         bool updateRunning;
         bool needOptimization;
         int  updateError;
+        //! Contour in drawing coordinates, see getBoundaryPath()
+        QPainterPath boundaryPath;
+        bool boundaryValid {false};
+
+        //! Pattern drawn at paint time, see setRenderPatterns()
+        bool patternRendered {false};
+        //! Create pattern lines in the next update, see materializePattern()
+        bool keepPattern {false};
+        //! Pattern lines of the tile at the origin
+        std::vector<std::pair<RS_Vector, RS_Vector>> patternLines;
+        //! Pattern tile offsets
+        RS_Vector patternDx;
+        RS_Vector patternDy;
+        //! Length of pattern lines per area
+        double patternDensity {0.};
+        //! Pattern of a copy updated in a worker thread, see cloneContour()
+        std::shared_ptr<const RS_Pattern> detachedPattern;
 };
 
 #endif
@@ -26,13 +26,17 @@
 
 #include<iostream>
 #include<cmath>
+#include<memory>
+#include <QTransform>
 #include "rs_insert.h"
 
 #include "rs_arc.h"
 #include "rs_circle.h"
 #include "rs_ellipse.h"
 #include "rs_block.h"
+#include "rs_fontchar.h"
 #include "rs_graphic.h"
+#include "rs_graphicview.h"
 #include "rs_layer.h"
 #include "rs_math.h"
 #include "rs_debug.h"
@@ -69,6 +73,7 @@ RS_Insert::RS_Insert(RS_EntityContainer* parent,
         : RS_EntityContainer(parent), data(d) {
 
 		block = nullptr;
+		materialized = false;
 
     if (data.updateMode!=RS2::NoUpdate) {
         update();
@@ -89,67 +94,188 @@ RS_Entity* RS_Insert::clone() const{
 /**
  * Updates the entity buffer of this insert entity. This method
  * needs to be called whenever the block this insert is based on changes.
+ *
+ * The block entities are not copied, the insert draws the block
+ * itself. Only the borders are calculated here.
  */
 void RS_Insert::update() {
 
         RS_DEBUG->print("RS_Insert::update");
         RS_DEBUG->print("RS_Insert::update: name: %s", data.name.toLatin1().data());
-//        RS_DEBUG->print("RS_Insert::update: insertionPoint: %f/%f",
-//                data.insertionPoint.x, data.insertionPoint.y);
 
         if (updateEnabled==false) {
                 return;
         }
 
     clear();
+    materialized = false;
 
-    RS_Block* blk = getBlockForInsert();
+    RS_Block* blk = getValidBlock();
 	if (!blk) {
-		//return nullptr;
-				RS_DEBUG->print("RS_Insert::update: Block is nullptr");
+				RS_DEBUG->print("RS_Insert::update: no block, undone or scale factor 0");
         return;
     }
 
-    if (isUndone()) {
-                RS_DEBUG->print("RS_Insert::update: Insert is in undo list");
-        return;
-    }
+        RS_DEBUG->print("RS_Insert::update: cols: %d, rows: %d",
+                data.cols, data.rows);
+        RS_DEBUG->print("RS_Insert::update: block has %d entities",
+                blk->count());
 
-        if (fabs(data.scaleFactor.x)<1.0e-6 || fabs(data.scaleFactor.y)<1.0e-6) {
-                RS_DEBUG->print("RS_Insert::update: scale factor is 0");
-                return;
+    // sub-inserts are kept up to date by RS_Graphic::updateInserts(),
+    // only blocks not yet regenerated after a change are updated here:
+    if (data.updateMode!=RS2::PreviewUpdate && blk->isChanged()) {
+        bool nested = false;
+		for(auto e: *blk){
+            if (e->rtti()==RS2::EntityInsert) {
+				static_cast<RS_Insert*>(e)->update();
+                nested = true;
+            }
         }
+        if (nested) {
+            blk->calculateBorders();
+        }
+    }
 
-    RS_Pen tmpPen;
+    calculateInstanceBorders();
 
-        /*QListIterator<RS_Entity> it = createIterator();
-    RS_Entity* e;
-	while ( (e = it.current())  ) {
-        ++it;*/
+        RS_DEBUG->print("RS_Insert::update: OK");
+}
+
+
+
+/**
+ * Copies the entities of the block into this insert, transformed
+ * for every cell of the array. Needed whenever the entities of the
+ * insert are used as entities, e.g. for exploding or for snapping
+ * to an entity inside the insert. The copies are dropped again by
+ * release() or the next update().
+ */
+void RS_Insert::materialize() {
+    if (materialized) {
+        return;
+    }
+    materialized = true;
+
+    RS_Block* blk = getValidBlock();
+	if (!blk) {
+        return;
+    }
+
+        RS_DEBUG->print("RS_Insert::materialize: name: %s", data.name.toLatin1().data());
 
-        RS_DEBUG->print("RS_Insert::update: cols: %d, rows: %d",
-                data.cols, data.rows);
-        RS_DEBUG->print("RS_Insert::update: block has %d entities",
-                blk->count());
-//int i_en_counts=0;
 		for(auto e: *blk){
         for (int c=0; c<data.cols; ++c) {
-//            RS_DEBUG->print("RS_Insert::update: col %d", c);
             for (int r=0; r<data.rows; ++r) {
-//                i_en_counts++;
-//                RS_DEBUG->print("RS_Insert::update: row %d", r);
+                appendEntity(cloneForCell(e, blk, c, r));
+            }
+        }
+    }
+    RS_EntityContainer::calculateBorders();
+}
 
-                if (e->rtti()==RS2::EntityInsert &&
-                    data.updateMode!=RS2::PreviewUpdate) {
 
-//                                        RS_DEBUG->print("RS_Insert::update: updating sub-insert");
-					static_cast<RS_Insert*>(e)->update();
-                }
 
-//                                RS_DEBUG->print("RS_Insert::update: cloning entity");
+/**
+ * Drops the copies made by materialize(). Pointers to entities of
+ * this insert are invalid afterwards.
+ */
+void RS_Insert::release() {
+    if (!materialized) {
+        return;
+    }
+    clear();
+    materialized = false;
+    calculateInstanceBorders();
+}
+
+
+
+/**
+ * Runs a query on the copies of the block entities. Copies made for
+ * the query are released again, so the query must not return
+ * pointers to entities of this insert.
+ */
+template<class F>
+auto RS_Insert::withCopies(F const& query) const -> decltype(query()) {
+    RS_Insert* self = const_cast<RS_Insert*>(this);
+    bool const keep = materialized;
+    self->materialize();
+    auto const ret = query();
+    if (!keep) {
+        self->release();
+    }
+    return ret;
+}
+
+
+
+/**
+ * @return The block of this insert or nullptr if nothing is
+ * inserted (no block, undone or scaled to zero).
+ */
+RS_Block* RS_Insert::getValidBlock() const {
+    RS_Block* blk = getBlockForInsert();
+	if (!blk || isUndone()) {
+        return nullptr;
+    }
+    if (fabs(data.scaleFactor.x)<1.0e-6 || fabs(data.scaleFactor.y)<1.0e-6) {
+        return nullptr;
+    }
+    return blk;
+}
+
+
+
+/**
+ * @return The block if a query can be answered by the block itself,
+ * i.e. the insert holds no copies and is scaled uniformly, so that
+ * distances in the block are proportional to distances in the drawing.
+ */
+RS_Block* RS_Insert::getBlockForQuery() const {
+    if (materialized ||
+            fabs(fabs(data.scaleFactor.x)-fabs(data.scaleFactor.y))>1.0e-6) {
+        return nullptr;
+    }
+    return getValidBlock();
+}
+
+
 
+/**
+ * Maps a point of the block to the drawing for the given cell of the array.
+ * Same transformation as applied to the copies in cloneForCell().
+ */
+RS_Vector RS_Insert::mapFromBlock(const RS_Vector& v, const RS_Vector& base,
+                                  int col, int row) const {
+    RS_Vector ret{(v.x-base.x)*data.scaleFactor.x + data.spacing.x*col,
+                  (v.y-base.y)*data.scaleFactor.y + data.spacing.y*row};
+    ret.rotate(data.angle);
+    return ret + data.insertionPoint;
+}
+
+
+
+/**
+ * Maps a point of the drawing to the block for the given cell of the array.
+ */
+RS_Vector RS_Insert::mapToBlock(const RS_Vector& v, const RS_Vector& base,
+                                int col, int row) const {
+    RS_Vector ret = v - data.insertionPoint;
+    ret.rotate(-data.angle);
+    return {(ret.x - data.spacing.x*col)/data.scaleFactor.x + base.x,
+            (ret.y - data.spacing.y*row)/data.scaleFactor.y + base.y};
+}
+
+
+
+/**
+ * @return A copy of the block entity e, transformed for the given
+ * cell of the array, with layer "0" and ByBlock attributes resolved
+ * from this insert.
+ */
+RS_Entity* RS_Insert::cloneForCell(RS_Entity* e, RS_Block* blk, int c, int r) {
                 RS_Entity* ne;
-                if ( (data.scaleFactor.x - data.scaleFactor.y)>1.0e-6) {
+                if ( fabs(fabs(data.scaleFactor.x) - fabs(data.scaleFactor.y))>1.0e-6) {
                     if (e->rtti()== RS2::EntityArc) {
 						RS_Arc* a= static_cast<RS_Arc*>(e);
 						ne = new RS_Ellipse{this,
@@ -179,33 +305,21 @@ void RS_Insert::update() {
                 ne->setParent(this);
                 ne->setVisible(getFlag(RS2::FlagVisible));
 
-//                                RS_DEBUG->print("RS_Insert::update: transforming entity");
-
                 // Move:
-//                                RS_DEBUG->print("RS_Insert::update: move 1");
-                if (fabs(data.scaleFactor.x)>1.0e-6 &&
-                        fabs(data.scaleFactor.y)>1.0e-6) {
-                    ne->move(data.insertionPoint +
-                             RS_Vector(data.spacing.x/data.scaleFactor.x*c,
-                                       data.spacing.y/data.scaleFactor.y*r));
-                }
-                else {
-                    ne->move(data.insertionPoint);
-                }
+                ne->move(data.insertionPoint +
+                         RS_Vector(data.spacing.x/data.scaleFactor.x*c,
+                                   data.spacing.y/data.scaleFactor.y*r));
                 // Move because of block base point:
-//                                RS_DEBUG->print("RS_Insert::update: move 2");
                 ne->move(blk->getBasePoint()*-1);
                 // Scale:
-//                                RS_DEBUG->print("RS_Insert::update: scale");
                 ne->scale(data.insertionPoint, data.scaleFactor);
                 // Rotate:
-//                                RS_DEBUG->print("RS_Insert::update: rotate");
                 ne->rotate(data.insertionPoint, data.angle);
                 // Select:
                 ne->setSelected(isSelected());
 
                 // individual entities can be on indiv. layers
-                tmpPen = ne->getPen(false);
+                RS_Pen tmpPen = ne->getPen(false);
 
                 // color from block (free floating):
                 if (tmpPen.getColor()==RS_Color(RS2::FlagByBlock)) {
@@ -233,19 +347,358 @@ void RS_Insert::update() {
                 // insert must be updated even in preview mode
                 if (data.updateMode != RS2::PreviewUpdate
                         || ne->rtti() == RS2::EntityInsert) {
-                    //RS_DEBUG->print("RS_Insert::update: updating new entity");
                     ne->update();
                 }
+                return ne;
+}
+
+
 
-//                                RS_DEBUG->print("RS_Insert::update: adding new entity");
-                appendEntity(ne);
-//                std::cout<<"done # of entity: "<<i_en_counts<<std::endl;
+/**
+ * Calculates the borders from the block without copying its entities.
+ * Exact for angles in steps of 90 degrees, where the block borders are
+ * just mapped. Letters map their outline for other angles. Otherwise
+ * the borders of each transformed entity are needed, which are taken
+ * from temporary copies.
+ */
+void RS_Insert::calculateInstanceBorders() {
+    resetBorders();
+
+    RS_Block* blk = getValidBlock();
+	if (!blk || blk->count()==0) {
+        return;
+    }
+
+    RS_Vector const& base = blk->getBasePoint();
+    double const quarter = RS_Math::correctAngle(data.angle)/M_PI_2;
+    if (fabs(quarter - RS_Math::round(quarter))<RS_TOLERANCE_ANGLE) {
+        RS_Vector const& bMin = blk->getMin();
+        RS_Vector const& bMax = blk->getMax();
+        for (RS_Vector const& v: {bMin, bMax, RS_Vector(bMin.x, bMax.y),
+             RS_Vector(bMax.x, bMin.y)}) {
+            RS_Vector const& p = mapFromBlock(v, base, 0, 0);
+            minV = RS_Vector::minimum(p, minV);
+            maxV = RS_Vector::maximum(p, maxV);
+        }
+    } else if (blk->rtti()==RS2::EntityFontChar) {
+        // letters are enclosed by their outline:
+        for (RS_Vector const& v: static_cast<RS_FontChar*>(blk)->getOutline()) {
+            RS_Vector const& p = mapFromBlock(v, base, 0, 0);
+            minV = RS_Vector::minimum(p, minV);
+            maxV = RS_Vector::maximum(p, maxV);
+        }
+    } else {
+		for(auto e: *blk){
+            if (!e->isVisible()) {
+                continue;
+            }
+            std::unique_ptr<RS_Entity> ne{cloneForCell(e, blk, 0, 0)};
+            ne->calculateBorders();
+            if (ne->isContainer() && ne->count()==0) {
+                continue;
             }
+            minV = RS_Vector::minimum(ne->getMin(), minV);
+            maxV = RS_Vector::maximum(ne->getMax(), maxV);
         }
     }
-    calculateBorders();
+    if (minV.x>maxV.x || minV.y>maxV.y) {
+        resetBorders();
+        return;
+    }
 
-        RS_DEBUG->print("RS_Insert::update: OK");
+    // the other cells are translated copies of the first one:
+    RS_Vector const& p0 = mapFromBlock(base, base, 0, 0);
+    RS_Vector offMin(0., 0.);
+    RS_Vector offMax(0., 0.);
+    for (int c: {0, data.cols-1}) {
+        for (int r: {0, data.rows-1}) {
+            RS_Vector const& off = mapFromBlock(base, base, c, r) - p0;
+            offMin = RS_Vector::minimum(off, offMin);
+            offMax = RS_Vector::maximum(off, offMax);
+        }
+    }
+    minV += offMin;
+    maxV += offMax;
+}
+
+
+
+/**
+ * Borders of an insert without copies are kept from update().
+ */
+void RS_Insert::calculateBorders() {
+    if (materialized) {
+        RS_EntityContainer::calculateBorders();
+    }
+}
+
+
+
+/**
+ * Recalculates the borders from the block for an insert without copies.
+ */
+void RS_Insert::forcedCalculateBorders() {
+    if (materialized) {
+        RS_EntityContainer::forcedCalculateBorders();
+    } else {
+        calculateInstanceBorders();
+    }
+}
+
+
+
+/**
+ * Draws the block through the transform of every cell of the array.
+ * Inserts holding copies of the block entities draw these instead.
+ */
+void RS_Insert::draw(RS_Painter* painter, RS_GraphicView* view,
+                     double& patternOffset) {
+	if (!(painter && view)) {
+        return;
+    }
+    if (materialized) {
+        RS_EntityContainer::draw(painter, view, patternOffset);
+        return;
+    }
+
+    RS_Block* blk = getValidBlock();
+	if (!blk) {
+        return;
+    }
+
+    // screen coordinates of the block for a base point and unit vectors:
+    RS_Vector const& base = blk->getBasePoint();
+    RS_Vector const& g0 = view->toGui(base);
+    double const ux = view->toGui(base + RS_Vector(1., 0.)).x - g0.x;
+    double const uy = view->toGui(base + RS_Vector(0., 1.)).y - g0.y;
+	if (fabs(ux)<RS_TOLERANCE || fabs(uy)<RS_TOLERANCE) {
+        return;
+    }
+
+    for (int c=0; c<data.cols; ++c) {
+        for (int r=0; r<data.rows; ++r) {
+            // the same points in the screen coordinates of the cell:
+            RS_Vector const& p0 = view->toGui(mapFromBlock(base, base, c, r));
+            RS_Vector const& ex = (view->toGui(mapFromBlock(base + RS_Vector(1., 0.), base, c, r)) - p0)/ux;
+            RS_Vector const& ey = (view->toGui(mapFromBlock(base + RS_Vector(0., 1.), base, c, r)) - p0)/uy;
+            QTransform t(ex.x, ex.y, ey.x, ey.y,
+                         p0.x - ex.x*g0.x - ey.x*g0.y,
+                         p0.y - ex.y*g0.x - ey.y*g0.y);
+
+            if (!view->beginInsert(painter, this, t)) {
+                // the painter can't transform, draw copies instead
+                materialize();
+                RS_EntityContainer::draw(painter, view, patternOffset);
+                release();
+                return;
+            }
+            // the visible area in block coordinates, skip cells outside:
+            RS_Vector vpMin, vpMax;
+            view->getVisibleArea(vpMin, vpMax);
+            if (blk->getMax().x>=vpMin.x && blk->getMin().x<=vpMax.x &&
+                    blk->getMax().y>=vpMin.y && blk->getMin().y<=vpMax.y) {
+				for(auto e: *blk){
+                    view->drawEntity(painter, e);
+                }
+            }
+            view->endInsert(painter);
+        }
+    }
+}
+
+
+
+RS_Entity* RS_Insert::firstEntity(RS2::ResolveLevel level) {
+    materialize();
+    return RS_EntityContainer::firstEntity(level);
+}
+
+RS_Entity* RS_Insert::lastEntity(RS2::ResolveLevel level) {
+    materialize();
+    return RS_EntityContainer::lastEntity(level);
+}
+
+RS_Entity* RS_Insert::entityAt(int index) {
+    materialize();
+    return RS_EntityContainer::entityAt(index);
+}
+
+
+
+/**
+ * @return Number of entities, copied or not.
+ */
+unsigned RS_Insert::count() const {
+    if (materialized) {
+        return RS_EntityContainer::count();
+    }
+    RS_Block* blk = getValidBlock();
+    return blk ? blk->count()*data.cols*data.rows : 0;
+}
+
+unsigned RS_Insert::countDeep() const {
+    if (materialized) {
+        return RS_EntityContainer::countDeep();
+    }
+    RS_Block* blk = getValidBlock();
+    return blk ? blk->countDeep()*data.cols*data.rows : 0;
+}
+
+double RS_Insert::getLength() const {
+    RS_Block* blk = getBlockForQuery();
+	if (blk) {
+        double const l = blk->getLength();
+        return (l<0.) ? l : l*fabs(data.scaleFactor.x)*data.cols*data.rows;
+    }
+    return withCopies([this]() {
+        return RS_EntityContainer::getLength();
+    });
+}
+
+
+
+/**
+ * Runs a nearest point query on the block for every cell of the array
+ * and maps the closest result back. Only for inserts without copies
+ * and uniform scale (see getBlockForQuery()).
+ */
+RS_Vector RS_Insert::getNearestInBlock(const RS_Vector& coord, double* dist,
+                                       std::function<RS_Vector(RS_Block*, const RS_Vector&, double*)> const& query) const {
+    double minDist = RS_MAXDOUBLE;
+    RS_Vector closestPoint(false);
+
+    RS_Block* blk = getBlockForQuery();
+	if (blk) {
+        RS_Vector const& base = blk->getBasePoint();
+        for (int c=0; c<data.cols; ++c) {
+            for (int r=0; r<data.rows; ++r) {
+                RS_Vector point = query(blk, mapToBlock(coord, base, c, r), nullptr);
+                if (!point.valid) {
+                    continue;
+                }
+                point = mapFromBlock(point, base, c, r);
+                double const curDist = coord.distanceTo(point);
+                if (curDist<minDist) {
+                    closestPoint = point;
+                    minDist = curDist;
+                }
+            }
+        }
+    }
+	if (dist) {
+        *dist = minDist;
+    }
+    return closestPoint;
+}
+
+RS_Vector RS_Insert::getNearestEndpoint(const RS_Vector& coord,
+                                        double* dist) const {
+	if (getBlockForQuery()) {
+        return getNearestInBlock(coord, dist,
+                                 [](RS_Block* b, const RS_Vector& v, double* d) {
+            return b->getNearestEndpoint(v, d);
+        });
+    }
+    return withCopies([&]() {
+        return RS_EntityContainer::getNearestEndpoint(coord, dist);
+    });
+}
+
+RS_Vector RS_Insert::getNearestPointOnEntity(const RS_Vector& coord,
+                                             bool onEntity, double* dist,
+                                             RS_Entity** entity) const {
+    // the entity found has to be a part of the drawing:
+	if (!entity && getBlockForQuery()) {
+        return getNearestInBlock(coord, dist,
+                                 [onEntity](RS_Block* b, const RS_Vector& v, double* d) {
+            return b->getNearestPointOnEntity(v, onEntity, d);
+        });
+    }
+    if (entity) {
+        const_cast<RS_Insert*>(this)->materialize();
+        return RS_EntityContainer::getNearestPointOnEntity(coord, onEntity, dist, entity);
+    }
+    return withCopies([&]() {
+        return RS_EntityContainer::getNearestPointOnEntity(coord, onEntity, dist);
+    });
+}
+
+RS_Vector RS_Insert::getNearestCenter(const RS_Vector& coord,
+                                      double* dist) const {
+	if (getBlockForQuery()) {
+        return getNearestInBlock(coord, dist,
+                                 [](RS_Block* b, const RS_Vector& v, double* d) {
+            return b->getNearestCenter(v, d);
+        });
+    }
+    return withCopies([&]() {
+        return RS_EntityContainer::getNearestCenter(coord, dist);
+    });
+}
+
+RS_Vector RS_Insert::getNearestMiddle(const RS_Vector& coord,
+                                      double* dist,
+                                      int middlePoints) const {
+	if (getBlockForQuery()) {
+        return getNearestInBlock(coord, dist,
+                                 [middlePoints](RS_Block* b, const RS_Vector& v, double* d) {
+            return b->getNearestMiddle(v, d, middlePoints);
+        });
+    }
+    return withCopies([&]() {
+        return RS_EntityContainer::getNearestMiddle(coord, dist, middlePoints);
+    });
+}
+
+RS_Vector RS_Insert::getNearestDist(double distance,
+                                    const RS_Vector& coord,
+                                    double* dist) const {
+    return withCopies([&]() {
+        return RS_EntityContainer::getNearestDist(distance, coord, dist);
+    });
+}
+
+
+
+/**
+ * Distances are measured in the block unless the entity found is
+ * requested on a level that resolves inserts, that entity has to be
+ * a copy in this insert.
+ */
+double RS_Insert::getDistanceToPoint(const RS_Vector& coord,
+                                     RS_Entity** entity,
+                                     RS2::ResolveLevel level,
+                                     double solidDist) const {
+    bool const resolve = level==RS2::ResolveAll ||
+            level==RS2::ResolveAllButTextImage;
+    RS_Block* blk = (entity && resolve) ? nullptr : getBlockForQuery();
+	if (!blk && entity) {
+        // the entity found may be a copy:
+        const_cast<RS_Insert*>(this)->materialize();
+        return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+    }
+	if (!blk) {
+        return withCopies([&]() {
+            return RS_EntityContainer::getDistanceToPoint(coord, nullptr, level, solidDist);
+        });
+    }
+
+    double const s = fabs(data.scaleFactor.x);
+    double minDist = RS_MAXDOUBLE;
+    RS_Vector const& base = blk->getBasePoint();
+    for (int c=0; c<data.cols; ++c) {
+        for (int r=0; r<data.rows; ++r) {
+            double const curDist = blk->getDistanceToPoint(mapToBlock(coord, base, c, r),
+                                                           nullptr, level, solidDist/s);
+            if (curDist<RS_MAXDOUBLE && curDist*s<minDist) {
+                minDist = curDist*s;
+            }
+        }
+    }
+	if (entity) {
+        *entity = const_cast<RS_Insert*>(this);
+    }
+    return minDist;
 }
 
 
@@ -288,6 +741,16 @@ RS_Block* RS_Insert::getBlockForInsert() const{
 }
 
 
+/**
+ * Sets the block of this insert, so that it isn't searched in the
+ * block list. Used for the letters of texts, which get their block
+ * from the glyph cache of the font.
+ */
+void RS_Insert::setBlockForInsert(RS_Block* blk) {
+    block = blk;
+}
+
+
 /**
  * Is this insert visible? (re-implementation from RS_Entity)
  *
@@ -28,6 +28,7 @@
 #ifndef RS_INSERT_H
 #define RS_INSERT_H
 
+#include <functional>
 #include "rs_entitycontainer.h"
 
 class RS_BlockList;
@@ -87,6 +88,17 @@ std::ostream& operator << (std::ostream& os, const RS_InsertData& d);
  * refer to a block. However, to the outside world they act exactly
  * like EntityContainer.
  *
+ * The block is drawn through a transform of the painter. Copies of
+ * the block entities are only made when they are needed as entities,
+ * e.g. when the insert is exploded or when an entity inside it is
+ * picked (see materialize()). Copies made for a query returning no
+ * entity are released right after the query.
+ *
+ * \warning begin() / end() and range-based for loops don't materialize
+ * the insert, they only see the copies made so far, usually none. Use
+ * firstEntity() / nextEntity() or call materialize() first, and
+ * release() when the entities aren't referenced anymore.
+ *
  * @author Andrew Mustun
  */
 class RS_Insert : public RS_EntityContainer {
@@ -116,8 +128,15 @@ public:
     }
 
 	RS_Block* getBlockForInsert() const;
+	void setBlockForInsert(RS_Block* blk);
 
     virtual void update();
+	void materialize();
+	void release();
+	/** @return true if this insert holds copies of the block entities. */
+	bool isMaterialized() const {
+		return materialized;
+	}
 
     QString getName() const {
         return data.name;
@@ -173,6 +192,34 @@ public:
 
 	virtual bool isVisible() const;
 
+	RS_Entity* firstEntity(RS2::ResolveLevel level=RS2::ResolveNone) override;
+	RS_Entity* lastEntity(RS2::ResolveLevel level=RS2::ResolveNone) override;
+	RS_Entity* entityAt(int index) override;
+	unsigned count() const override;
+	unsigned countDeep() const override;
+	double getLength() const override;
+	void calculateBorders() override;
+	void forcedCalculateBorders() override;
+
+	RS_Vector getNearestEndpoint(const RS_Vector& coord,
+								 double* dist = nullptr) const override;
+	RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
+									  bool onEntity = true,
+									  double* dist = nullptr,
+									  RS_Entity** entity=nullptr) const override;
+	RS_Vector getNearestCenter(const RS_Vector& coord,
+							   double* dist = nullptr) const override;
+	RS_Vector getNearestMiddle(const RS_Vector& coord,
+							   double* dist = nullptr,
+							   int middlePoints = 1) const override;
+	RS_Vector getNearestDist(double distance,
+							 const RS_Vector& coord,
+							 double* dist = nullptr) const override;
+	double getDistanceToPoint(const RS_Vector& coord,
+							  RS_Entity** entity,
+							  RS2::ResolveLevel level=RS2::ResolveNone,
+							  double solidDist = RS_MAXDOUBLE) const override;
+
 	virtual RS_VectorSolutions getRefPoints() const;
     virtual RS_Vector getMiddlePoint(void) const{
             return RS_Vector(false);
@@ -186,11 +233,28 @@ public:
     virtual void scale(const RS_Vector& center, const RS_Vector& factor);
     virtual void mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2);
 
+	void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) override;
+
     friend std::ostream& operator << (std::ostream& os, const RS_Insert& i);
 
 protected:
+	RS_Block* getValidBlock() const;
+	RS_Block* getBlockForQuery() const;
+	RS_Vector mapFromBlock(const RS_Vector& v, const RS_Vector& base,
+						   int col, int row) const;
+	RS_Vector mapToBlock(const RS_Vector& v, const RS_Vector& base,
+						 int col, int row) const;
+	RS_Entity* cloneForCell(RS_Entity* e, RS_Block* blk, int col, int row);
+	void calculateInstanceBorders();
+	template<class F>
+	auto withCopies(F const& query) const -> decltype(query());
+	RS_Vector getNearestInBlock(const RS_Vector& coord, double* dist,
+								std::function<RS_Vector(RS_Block*, const RS_Vector&, double*)> const& query) const;
+
     RS_InsertData data;
 	mutable RS_Block* block;
+	//! true if the block entities are copied into this insert
+	bool materialized;
 };
 
 
@@ -26,6 +26,7 @@
 **********************************************************************/
 
 #include<iostream>
+#include<algorithm>
 #include "rs_debug.h"
 #include "rs_layerlist.h"
 #include "rs_layer.h"
@@ -46,6 +47,7 @@ RS_LayerList::RS_LayerList() {
  */
 void RS_LayerList::clear() {
     layers.clear();
+    layerIndex.clear();
 	setModified(true);
 }
 
@@ -135,6 +137,18 @@ void RS_LayerList::sort()
                      });
 }
 
+/**
+ * Inserts the given layer behind all layers with a name less or
+ * equal to its name. Keeps the list sorted without sorting it again.
+ */
+void RS_LayerList::insertSorted(RS_Layer* layer)
+{
+    auto it = std::upper_bound(layers.begin(), layers.end(), layer, [](const RS_Layer* l0, const RS_Layer* l1 )->bool{
+                                   return l0->getName() < l1->getName();
+                               });
+    layers.insert(it, layer);
+}
+
 /**
  * Adds a layer to the layer list.
  * If there is already a layer with the same name, no layer is 
@@ -153,8 +167,8 @@ void RS_LayerList::add(RS_Layer* layer) {
     // check if layer already exists:
     RS_Layer* l = find(layer->getName());
     if (l==NULL) {
-        layers.append(layer);
-        this->sort();
+        insertSorted(layer);
+        layerIndex.insert(layer->getName(), layer);
         // notify listeners
         for (int i=0; i<layerListListeners.size(); ++i) {
             RS_LayerListListener* l = layerListListeners.at(i);
@@ -200,6 +214,9 @@ void RS_LayerList::remove(RS_Layer* layer) {
 
     // here the layer is removed from the list but not deleted
     layers.removeOne(layer);
+    if (layerIndex.value(layer->getName())==layer) {
+        layerIndex.remove(layer->getName());
+    }
 
     for (int i=0; i<layerListListeners.size(); ++i) {
         RS_LayerListListener* l = layerListListeners.at(i);
@@ -229,8 +246,18 @@ void RS_LayerList::edit(RS_Layer* layer, const RS_Layer& source) {
         return;
     }
 
+    QString oldName = layer->getName();
     *layer = source;
 
+    // renamed, update the index and keep the list sorted:
+    if (layer->getName()!=oldName && layers.removeOne(layer)) {
+        if (layerIndex.value(oldName)==layer) {
+            layerIndex.remove(oldName);
+        }
+        layerIndex.insert(layer->getName(), layer);
+        insertSorted(layer);
+    }
+
     for (int i=0; i<layerListListeners.size(); ++i) {
         RS_LayerListListener* l = layerListListeners.at(i);
 
@@ -247,21 +274,7 @@ void RS_LayerList::edit(RS_Layer* layer, const RS_Layer& source) {
  * \p NULL if no such layer was found.
  */
 RS_Layer* RS_LayerList::find(const QString& name) {
-    //RS_DEBUG->print("RS_LayerList::find begin");
-
-    RS_Layer* ret = NULL;
-
-    for (int i=0; i<layers.size(); ++i) {
-        RS_Layer* l = layers.at(i);
-        if (l->getName()==name) {
-            ret = l;
-            break;
-        }
-    }
-
-    //RS_DEBUG->print("RS_LayerList::find end");
-
-    return ret;
+    return layerIndex.value(name, NULL);
 }
 
 
@@ -271,22 +284,11 @@ RS_Layer* RS_LayerList::find(const QString& name) {
  * was not found.
  */
 int RS_LayerList::getIndex(const QString& name) {
-    //RS_DEBUG->print("RS_LayerList::find begin");
-
-    int ret = -1;
-
-    for (int i=0; i<layers.size(); i++) {
-        RS_Layer* l = layers.at(i);
-
-        if (l->getName()==name) {
-            ret = i;
-            break;
-        }
+    RS_Layer* l = find(name);
+    if (l==NULL) {
+        return -1;
     }
-
-    //RS_DEBUG->print("RS_LayerList::find end");
-
-    return ret;
+    return layers.indexOf(l);
 }
 
 
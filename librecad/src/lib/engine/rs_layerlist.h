@@ -30,6 +30,7 @@
 #define RS_LAYERLIST_H
 
 #include <QList>
+#include <QHash>
 #include "rs_layer.h"
 
 class RS_LayerListListener;
@@ -127,8 +128,12 @@ public:
     friend std::ostream& operator << (std::ostream& os, RS_LayerList& l);
 
 private:
-    //! layers in the graphic
+    void insertSorted(RS_Layer* layer);
+
+    //! layers in the graphic, sorted by name
     QList<RS_Layer*> layers;
+    //! layers by name, kept in sync with 'layers'
+    QHash<QString, RS_Layer*> layerIndex;
     //! List of registered LayerListListeners
     QList<RS_LayerListListener*> layerListListeners;
     QG_LayerWidget* layerWidget;
@@ -204,7 +204,7 @@ void RS_MText::setAlignment(int a) {
 /**
  * @return Number of lines in this text entity.
  */
-int RS_MText::getNumberOfLines() {
+int RS_MText::getNumberOfLines() const {
     int c=1;
 
     for (int i=0; i<(int)data.text.length(); ++i) {
@@ -228,8 +228,18 @@ void RS_MText::update()
 {
     RS_DEBUG->print("RS_MText::update");
 
+    // lines of the last layout are kept where the text didn't change:
+    std::vector<LineLayout> oldLayout;
+    QList<RS_Entity*> oldLines;
+    if (layoutFits()) {
+        oldLayout.swap( layout);
+        oldLines.swap( entities);
+    }
+    layout.clear();
+
     clear();
     if (isUndone()) {
+        qDeleteAll( oldLines);
         return;
     }
 
@@ -238,6 +248,7 @@ void RS_MText::update()
 
     RS_Font* font {RS_FONTLIST->requestFont( data.style)};
     if (nullptr == font) {
+        qDeleteAll( oldLines);
         return;
     }
 
@@ -245,10 +256,14 @@ void RS_MText::update()
     RS_Vector letterSpace {RS_Vector( font->getLetterSpacing(), 0.0)};
     RS_Vector space {RS_Vector( font->getWordSpacing(), 0.0)};
     int lineCounter {0};
+    double tt {0.0};
 
     // Every single text line gets stored in this entity container
     // so we can move the whole line around easely:
-    RS_EntityContainer* oneLine {new RS_EntityContainer(this)};
+    RS_EntityContainer* oneLine {nullptr};
+    int lineStart {0};
+    RS_Font* lineFont {font};
+    bool endOfText {false};
 
     // First every text line is created with
     //   alignment: top left
@@ -260,12 +275,42 @@ void RS_MText::update()
     for (int i = 0; i < static_cast<int>(data.text.length()); ++i) {
         bool handled {false};
 
+        if (nullptr == oneLine) {
+            // take the line of the last layout if it has the same text:
+            if (lineCounter < static_cast<int>(oldLayout.size())) {
+                LineLayout const& old {oldLayout[lineCounter]};
+                if (old.font == font
+                    && data.text.midRef( i, old.text.length()) == old.text
+                    && (! old.endOfText
+                        || i + old.text.length() == data.text.length())) {
+                    addEntity( oldLines[lineCounter]);
+                    oldLines[lineCounter] = nullptr;
+                    layout.push_back( old);
+                    layout.back().reused = true;
+                    if (old.width > usedTextWidth) {
+                        usedTextWidth = old.width;
+                    }
+                    usedTextHeight += data.height * data.lineSpacingFactor * 5.0 / 3.0;
+                    tt = old.tail;
+                    font = old.endFont;
+                    endOfText = old.endOfText;
+                    ++lineCounter;
+                    i += old.text.length() - 1;
+                    continue;
+                }
+            }
+
+            oneLine = new RS_EntityContainer(this);
+            letterPos = RS_Vector( 0.0, -9.0);
+            lineStart = i;
+            lineFont = font;
+        }
+
         switch (data.text.at(i).unicode()) {
         case 0x0A:
             // line feed:
-            updateAddLine( oneLine, lineCounter++);
-            oneLine = new RS_EntityContainer(this);
-            letterPos = RS_Vector( 0.0, -9.0);
+            addLine( oneLine, lineCounter++, lineStart, i + 1, lineFont, font, false);
+            oneLine = nullptr;
             break;
 
         case 0x20:
@@ -279,9 +324,8 @@ void RS_MText::update()
             int ch {data.text.at(i).unicode()};
             switch (ch) {
             case 'P':
-                updateAddLine( oneLine, lineCounter++);
-                oneLine = new RS_EntityContainer(this);
-                letterPos = RS_Vector( 0.0, -9.0);
+                addLine( oneLine, lineCounter++, lineStart, i + 1, lineFont, font, false);
+                oneLine = nullptr;
                 handled = true;
                 break;
 
@@ -416,16 +460,14 @@ void RS_MText::update()
             // fall-through
         default: {
             // One Letter:
-            QString letterText {QString(data.text.at(i))};
-            if (nullptr == font->findLetter( letterText)) {
-                RS_DEBUG->print("RS_MText::update: missing font for letter( %s ), replaced it with QChar(0xfffd)",
-                                qPrintable( letterText));
-                letterText = QChar( 0xfffd);
+            RS_FontGlyph const glyph {font->findGlyph( data.text.at(i))};
+            if (nullptr == glyph.letter) {
+                break;
             }
 
             RS_DEBUG->print("RS_MText::update: insert a letter at pos: %f/%f", letterPos.x, letterPos.y);
 
-            RS_InsertData d( letterText,
+            RS_InsertData d( glyph.name,
                              letterPos,
                              RS_Vector( 1.0, 1.0),
                              0.0,
@@ -436,13 +478,12 @@ void RS_MText::update()
                              RS2::NoUpdate);
 
             RS_Insert* letter {new RS_Insert(this, d)};
-            RS_Vector letterWidth;
             letter->setPen( RS_Pen( RS2::FlagInvalid));
             letter->setLayer( nullptr);
+            letter->setBlockForInsert( glyph.letter);
             letter->update();
-            letter->forcedCalculateBorders();
 
-            letterWidth = RS_Vector( letter->getMax().x - letterPos.x, 0.0);
+            RS_Vector letterWidth {RS_Vector( glyph.width, 0.0)};
             if (0 > letterWidth.x) {
                 letterWidth.x = -letterSpace.x;
             }
@@ -458,15 +499,36 @@ void RS_MText::update()
         } // outer switch (data.text.at(i).unicode())
     } // for (i) loop
 
-    double tt {updateAddLine( oneLine, lineCounter)};
+    if (nullptr == oneLine && ! endOfText) {
+        // empty last line:
+        oneLine = new RS_EntityContainer(this);
+        lineStart = data.text.length();
+        lineFont = font;
+    }
+    if (nullptr != oneLine) {
+        tt = addLine( oneLine, lineCounter, lineStart, data.text.length(), lineFont, font, true);
+    }
+
+    RS_Vector ot {RS_Vector( 0.0, 0.0)};
     if (RS_MTextData::VABottom == data.valign) {
-        RS_Vector ot {RS_Vector( 0.0, -tt).rotate( data.angle)};
-        RS_EntityContainer::move( ot);
+        ot = RS_Vector( 0.0, -tt).rotate( data.angle);
+    }
+    for (size_t k = 0; k < layout.size(); ++k) {
+        // kept lines are already moved by the offset of the last layout:
+        RS_Vector const offset {layout[k].reused ? ot - layoutShift : ot};
+        if (offset.squared() > RS_TOLERANCE2) {
+            entities.at(k)->move( offset);
+        }
     }
 
     usedTextHeight -= data.height * data.lineSpacingFactor * 5.0 / 3.0 - data.height;
     forcedCalculateBorders();
 
+    qDeleteAll( oldLines);
+    layoutData = data;
+    layoutLineCount = getNumberOfLines();
+    layoutShift = ot;
+
     RS_DEBUG->print("RS_MText::update: OK");
 }
 
@@ -478,10 +540,12 @@ void RS_MText::update()
  *
  * @param textLine The text line.
  * @param lineCounter Line number.
+ * @param lineWidth Set to the width of the line if not nullptr.
  *
  * @return  distance over the text base-line
  */
-double RS_MText::updateAddLine(RS_EntityContainer* textLine, int lineCounter) {
+double RS_MText::updateAddLine(RS_EntityContainer* textLine, int lineCounter,
+                               double* lineWidth) {
     double ls =5.0/3.0;
 
     RS_DEBUG->print("RS_MText::updateAddLine: width: %f", textLine->getSize().x);
@@ -543,6 +607,9 @@ double RS_MText::updateAddLine(RS_EntityContainer* textLine, int lineCounter) {
     if (textLine->getSize().x>usedTextWidth) {
         usedTextWidth = textLine->getSize().x;
     }
+    if (lineWidth) {
+        *lineWidth = textLine->getSize().x;
+    }
 
     usedTextHeight += data.height*data.lineSpacingFactor*ls;
 
@@ -563,6 +630,65 @@ double RS_MText::updateAddLine(RS_EntityContainer* textLine, int lineCounter) {
 }
 
 
+/**
+ * Used internally by update() to add a text line and keep its layout.
+ *
+ * @param start Index of the first character of the line.
+ * @param end Index after the line break.
+ * @param font Font at the start of the line.
+ * @param endFont Font at the end of the line.
+ * @param endOfText true if the line ends the text without line break.
+ *
+ * @return  distance over the text base-line
+ */
+double RS_MText::addLine(RS_EntityContainer* textLine, int lineCounter,
+                         int start, int end, RS_Font* font, RS_Font* endFont,
+                         bool endOfText) {
+    LineLayout line;
+    line.text = data.text.mid(start, end - start);
+    line.font = font;
+    line.endFont = endFont;
+    line.endOfText = endOfText;
+    line.tail = updateAddLine(textLine, lineCounter, &line.width);
+    layout.push_back(line);
+    return line.tail;
+}
+
+
+
+/**
+ * @return true if the lines of the last layout are placed as the
+ * current data requires, so that lines with unchanged text can be kept.
+ */
+bool RS_MText::layoutFits() const {
+    return !layout.empty()
+            && static_cast<int>(layout.size()) == entities.size()
+            && layoutData.insertionPoint == data.insertionPoint
+            && layoutData.height == data.height
+            && layoutData.valign == data.valign
+            && layoutData.halign == data.halign
+            && layoutData.lineSpacingFactor == data.lineSpacingFactor
+            && layoutData.style == data.style
+            && layoutData.angle == data.angle
+            && layoutLineCount == getNumberOfLines();
+}
+
+
+
+/**
+ * Keeps the layout after the lines were moved or rotated with the
+ * data, if the layout did fit before.
+ */
+void RS_MText::keepLayout(bool fits) {
+    if (fits) {
+        layoutData = data;
+    } else {
+        layout.clear();
+    }
+}
+
+
+
 RS_Vector RS_MText::getNearestEndpoint(const RS_Vector& coord, double* dist)const {
     if (dist) {
         *dist = data.insertionPoint.distanceTo(coord);
@@ -576,8 +702,10 @@ RS_VectorSolutions RS_MText::getRefPoints() const{
 }
 
 void RS_MText::move(const RS_Vector& offset) {
+    bool const fits = layoutFits();
     RS_EntityContainer::move(offset);
     data.insertionPoint.move(offset);
+    keepLayout(fits);
 //    update();
 }
 
@@ -585,15 +713,15 @@ void RS_MText::move(const RS_Vector& offset) {
 
 void RS_MText::rotate(const RS_Vector& center, const double& angle) {
     RS_Vector angleVector(angle);
-    RS_EntityContainer::rotate(center, angleVector);
-    data.insertionPoint.rotate(center, angleVector);
-    data.angle = RS_Math::correctAngle(data.angle+angle);
-//    update();
+    rotate(center, angleVector);
 }
 void RS_MText::rotate(const RS_Vector& center, const RS_Vector& angleVector) {
+    bool const fits = layoutFits();
     RS_EntityContainer::rotate(center, angleVector);
     data.insertionPoint.rotate(center, angleVector);
     data.angle = RS_Math::correctAngle(data.angle+angleVector.angle());
+    layoutShift.rotate(angleVector);
+    keepLayout(fits);
 //    update();
 }
 
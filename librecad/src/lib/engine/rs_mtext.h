@@ -28,8 +28,11 @@
 #ifndef RS_MTEXT_H
 #define RS_MTEXT_H
 
+#include <vector>
 #include "rs_entitycontainer.h"
 
+class RS_Font;
+
 /**
  * Holds the data that defines a text entity.
  */
@@ -164,7 +167,7 @@ public:
 
     void update() override;
 
-    int getNumberOfLines();
+    int getNumberOfLines() const;
 
 
     RS_Vector getInsertionPoint() {
@@ -254,7 +257,43 @@ public:
     void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) override;
 
 private:
-    double updateAddLine(RS_EntityContainer* textLine, int lineCounter);
+    /**
+     * Layout of a line of the text. The line is the entity with the
+     * same index. Lines are kept by update() as long as their text
+     * and placement don't change.
+     */
+    struct LineLayout {
+        /** Text of the line including the line break */
+        QString text;
+        /** Font at the start of the line */
+        RS_Font* font {nullptr};
+        /** Font at the end of the line */
+        RS_Font* endFont {nullptr};
+        /** true if the line ends the text without a line break */
+        bool endOfText {false};
+        /** Width of the line after scaling */
+        double width {0.0};
+        /** Distance over the base line after scaling */
+        double tail {0.0};
+        /** true if the line was taken from the last layout */
+        bool reused {false};
+    };
+
+    double updateAddLine(RS_EntityContainer* textLine, int lineCounter,
+                         double* lineWidth = nullptr);
+    double addLine(RS_EntityContainer* textLine, int lineCounter, int start, int end,
+                   RS_Font* font, RS_Font* endFont, bool endOfText);
+    bool layoutFits() const;
+    void keepLayout(bool fits);
+
+    /** Layout of the lines */
+    std::vector<LineLayout> layout;
+    /** Data the lines were placed for */
+    RS_MTextData layoutData;
+    /** Number of lines the lines were aligned for */
+    int layoutLineCount {0};
+    /** Offset of bottom aligned lines */
+    RS_Vector layoutShift {0.0, 0.0};
 
 protected:
     RS_MTextData data;
@@ -25,13 +25,27 @@
 **********************************************************************/
 
 
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
 #include "rs_pattern.h"
 
 #include "rs_system.h"
 #include "rs_fileio.h"
 #include "rs_layer.h"
+#include "rs_line.h"
 #include "rs_debug.h"
 
+namespace {
+//! "LPTC", identifies the binary cache of a pattern
+const quint32 patternCacheMagic = 0x4c505443;
+const quint16 patternCacheVersion = 1;
+}
+
 
 /**
  * Constructor.
@@ -47,6 +61,18 @@ RS_Pattern::RS_Pattern(const QString& fileName)
 }
 
 
+/**
+ * @return Deep copy of this pattern including its line families.
+ */
+RS_Entity* RS_Pattern::clone() const {
+	RS_Pattern* p = new RS_Pattern(*this);
+	p->setOwner(isOwner());
+	p->detach();
+	p->initId();
+	return p;
+}
+
+
 /**
  * Loads the given pattern file into this pattern.
  * Entities other than lines are ignored.
@@ -61,28 +87,7 @@ bool RS_Pattern::loadPattern() {
 
     RS_DEBUG->print("RS_Pattern::loadPattern");
 
-    QString path;
-
-    // Search for the appropriate pattern if we have only the name of the pattern:
-    if (!fileName.toLower().contains(".dxf")) {
-        QStringList patterns = RS_SYSTEM->getPatternList();
-        QFileInfo file;
-        for (QStringList::Iterator it = patterns.begin();
-                it!=patterns.end();
-                it++) {
-
-            if (QFileInfo(*it).baseName().toLower()==fileName.toLower()) {
-                path = *it;
-                RS_DEBUG->print("Pattern found: %s", path.toLatin1().data());
-                break;
-            }
-        }
-    }
-
-    // We have the full path of the pattern:
-    else {
-        path = fileName;
-    }
+    QString path = findPatternFile();
 
     // No pattern paths found:
     if (path.isEmpty()) {
@@ -90,6 +95,10 @@ bool RS_Pattern::loadPattern() {
         return false;
     }
 
+    if (loadCachedPattern(path)) {
+        return true;
+    }
+
 	RS_Graphic gr;
 	RS_FileIO::instance()->fileImport(gr, path);
 	for(auto e: gr){
@@ -104,8 +113,19 @@ bool RS_Pattern::loadPattern() {
                 cl->setLayer(l->getName());
             }
             addEntity(cl);
+
+            if (e->rtti()==RS2::EntityLine) {
+                lines.push_back(RS_PatternLine{e->getStartpoint(),
+                                               e->getStartpoint().angleTo(e->getEndpoint()),
+                                               e->getLength()});
+            } else {
+                curves = true;
+            }
         }
 	}
+    if (!curves) {
+        writeCache(QFileInfo(path));
+    }
 
     loaded = true;
     RS_DEBUG->print("RS_Pattern::loadPattern: OK");
@@ -113,6 +133,142 @@ bool RS_Pattern::loadPattern() {
     return true;
 }
 
+/**
+ * Loads the pattern from the binary cache of the given pattern file.
+ *
+ * @retval false there is no valid cache for the pattern file.
+ */
+bool RS_Pattern::loadCachedPattern(const QString& path) {
+    if (loaded) {
+        return true;
+    }
+    if (!readCache(QFileInfo(path))) {
+        return false;
+    }
+    for (const RS_PatternLine& l: lines) {
+        addEntity(new RS_Line(this, l.origin, l.origin + RS_Vector(l.angle)*l.length));
+    }
+    loaded = true;
+    RS_DEBUG->print("RS_Pattern::loadCachedPattern: %s", path.toLatin1().data());
+    return true;
+}
+
+/**
+ * @return Path of the pattern file or an empty string if the
+ *         pattern is not available.
+ */
+QString RS_Pattern::findPatternFile() const {
+    // We have the full path of the pattern:
+    if (fileName.toLower().contains(".dxf")) {
+        return fileName;
+    }
+
+    // Search for the appropriate pattern if we have only the name of the pattern:
+    QStringList patterns = RS_SYSTEM->getPatternList();
+    for (QStringList::Iterator it = patterns.begin();
+            it!=patterns.end();
+            it++) {
+
+        if (QFileInfo(*it).baseName().toLower()==fileName.toLower()) {
+            RS_DEBUG->print("Pattern found: %s", it->toLatin1().data());
+            return *it;
+        }
+    }
+    return QString();
+}
+
+/**
+ * @return Path of the binary cache for the given pattern file or
+ *         an empty string if there is no cache directory.
+ */
+QString RS_Pattern::getCachePath(const QFileInfo& source) {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty()) {
+        return QString();
+    }
+    dir += QDir::separator() + QString("patterns") + QDir::separator();
+    return dir + source.completeBaseName() + "_"
+            + QString::number(qHash(source.absoluteFilePath()), 16) + ".patc";
+}
+
+/**
+ * Reads the line families from the binary cache.
+ *
+ * @retval false there is no valid cache for the source file.
+ */
+bool RS_Pattern::readCache(const QFileInfo& source) {
+    const QString cachePath = getCachePath(source);
+    if (cachePath.isEmpty()) {
+        return false;
+    }
+    QFile f(cachePath);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    QString sourcePath;
+    qint64 size = 0;
+    qint64 modified = 0;
+    in >> magic >> version;
+    if (magic!=patternCacheMagic || version!=patternCacheVersion) {
+        return false;
+    }
+    in >> sourcePath >> size >> modified;
+    if (sourcePath!=source.absoluteFilePath() || size!=source.size()
+            || modified!=source.lastModified().toMSecsSinceEpoch()) {
+        return false;
+    }
+
+    quint32 count = 0;
+    in >> count;
+    std::vector<RS_PatternLine> cached;
+    for (quint32 i=0; i<count && in.status()==QDataStream::Ok; ++i) {
+        RS_PatternLine l;
+        in >> l.origin.x >> l.origin.y >> l.angle >> l.length;
+        cached.push_back(l);
+    }
+
+    if (in.status()!=QDataStream::Ok) {
+        RS_DEBUG->print(RS_Debug::D_WARNING,
+                        "RS_Pattern::readCache: corrupt cache %s", qPrintable(cachePath));
+        return false;
+    }
+    lines = std::move(cached);
+    return true;
+}
+
+/**
+ * Writes the line families of this pattern to the binary cache.
+ */
+void RS_Pattern::writeCache(const QFileInfo& source) const {
+    const QString cachePath = getCachePath(source);
+    if (cachePath.isEmpty()) {
+        return;
+    }
+    RS_SYSTEM->createPaths(QFileInfo(cachePath).absolutePath());
+
+    QSaveFile f(cachePath);
+    if (!f.open(QIODevice::WriteOnly)) {
+        RS_DEBUG->print(RS_Debug::D_WARNING,
+                        "RS_Pattern::writeCache: cannot write %s", qPrintable(cachePath));
+        return;
+    }
+    QDataStream out(&f);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << patternCacheMagic << patternCacheVersion
+        << source.absoluteFilePath() << source.size()
+        << source.lastModified().toMSecsSinceEpoch()
+        << static_cast<quint32>(lines.size());
+    for (const RS_PatternLine& l: lines) {
+        out << l.origin.x << l.origin.y << l.angle << l.length;
+    }
+    f.commit();
+}
+
 QString RS_Pattern::getFileName() const {
 	return fileName;
 }
@@ -28,14 +28,31 @@
 #ifndef RS_PATTERN_H
 #define RS_PATTERN_H
 
+#include <vector>
 #include "rs_entitycontainer.h"
 
+class QFileInfo;
 class RS_PatternList;
 
+/**
+ * Line family of a pattern: one dash of the pattern tile, repeated
+ * with the size of the tile in x and y.
+ */
+struct RS_PatternLine {
+    RS_Vector origin;
+    double angle;
+    double length;
+};
+
 /**
  * Patterns are used for hatches. They are stored in a RS_PatternList.
  * Use RS_PatternList to access a pattern.
  *
+ * The lines of a loaded pattern are also kept as line families, which
+ * hatches use without copying the pattern. Patterns made of lines are
+ * cached in a binary file, so they are loaded without reading the DXF
+ * file again.
+ *
  * @author Andrew Mustun
  */
 class RS_Pattern : public RS_EntityContainer {
@@ -45,20 +62,41 @@ public:
 	RS2::EntityType rtti() const{
 		return RS2::EntityPattern;
 	}
+	RS_Entity* clone() const override;
 
     virtual bool loadPattern();
+    bool loadCachedPattern(const QString& path);
 	
     /** @return the fileName of this pattern. */
 	QString getFileName() const;
 
+    /** @return Line families of the pattern. */
+    const std::vector<RS_PatternLine>& getLines() const {
+        return lines;
+    }
+    /** @return true if the pattern has arcs or ellipses. */
+    bool hasCurves() const {
+        return curves;
+    }
+
+    //! Tests the pattern cache, see LC_SimpleTests::slotTestPatternCache()
+    friend class LC_SimpleTests;
+
 protected:
+    QString findPatternFile() const;
+
+    static QString getCachePath(const QFileInfo& source);
+    bool readCache(const QFileInfo& source);
+    void writeCache(const QFileInfo& source) const;
+
     //! Pattern file name
     QString fileName;
 
     //! Is this pattern currently loaded into memory?
     bool loaded;
 
-	
+    std::vector<RS_PatternLine> lines;
+    bool curves {false};
 };
 
 
@@ -26,12 +26,18 @@
 
 #include<iostream>
 #include<QString>
+#include<QMutex>
 #include "rs_patternlist.h"
 
 #include "rs_system.h"
 #include "rs_pattern.h"
 #include "rs_debug.h"
 
+namespace {
+//! Patterns are also requested from worker threads, see LC_RegenScheduler
+QMutex patternMutex;
+}
+
 RS_PatternList* RS_PatternList::instance() {
 	static RS_PatternList instance;
 	return &instance;
@@ -43,6 +49,8 @@ RS_PatternList::~RS_PatternList() = default;
 /**
  * Initializes the pattern list by creating empty RS_Pattern 
  * objects, one for each pattern that could be found.
+ * Patterns with a valid cache are loaded right away, the others
+ * when they are requested.
  */
 void RS_PatternList::init() {
     RS_DEBUG->print("RS_PatternList::initPatterns");
@@ -56,7 +64,12 @@ void RS_PatternList::init() {
 
 		QFileInfo fi(s);
 		QString const name = fi.baseName().toLower();
-		patterns[name] = std::unique_ptr<RS_Pattern>{};
+		std::unique_ptr<RS_Pattern> p{new RS_Pattern(name)};
+		if (p->loadCachedPattern(s)) {
+			patterns[name] = std::move(p);
+		} else {
+			patterns[name] = std::unique_ptr<RS_Pattern>{};
+		}
 
 		RS_DEBUG->print("base: %s", name.toLatin1().data());
     }
@@ -74,6 +87,7 @@ RS_Pattern* RS_PatternList::requestPattern(const QString& name) {
     QString name2 = name.toLower();
 
 	RS_DEBUG->print("name2: %s", name2.toLatin1().data());
+	QMutexLocker lock(&patternMutex);
 	if (patterns.count(name2)) {
 		if (!patterns[name2]) {
 			RS_Pattern* p = new RS_Pattern(name2);
@@ -81,7 +95,7 @@ RS_Pattern* RS_PatternList::requestPattern(const QString& name) {
 			patterns[name2].reset(p);
 		}
 		RS_DEBUG->print("name2: %s, size= %d", name2.toLatin1().data(),
-						patterns[name2]->countDeep());
+						patterns[name2]->count());
 		return patterns[name2].get();
 	}
 
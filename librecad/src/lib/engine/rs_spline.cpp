@@ -24,8 +24,11 @@
 **
 **********************************************************************/
 
+#include<algorithm>
+#include<array>
 #include<iostream>
 #include<cmath>
+#include<limits>
 #include<numeric>
 
 #include "rs_spline.h"
@@ -68,7 +71,9 @@ std::ostream& operator << (std::ostream& os, const RS_SplineData& ld) {
  */
 RS_Spline::RS_Spline(RS_EntityContainer* parent,
                      const RS_SplineData& d)
-        :RS_EntityContainer(parent), data(d) {
+        :RS_EntityContainer(parent), data(d)
+        ,materialized(false)
+        ,zoomBucket(std::numeric_limits<int>::min()) {
     calculateBorders();
 }
 
@@ -158,6 +163,10 @@ void RS_Spline::update() {
     RS_DEBUG->print("RS_Spline::update");
 
     clear();
+    materialized = false;
+    points.clear();
+    zoomPoints.clear();
+    zoomBucket = std::numeric_limits<int>::min();
 
     if (isUndone()) {
         return;
@@ -175,6 +184,124 @@ void RS_Spline::update() {
 
     resetBorders();
 
+    // resolution:
+	const size_t npts = data.controlPoints.size() + (data.closed ? data.degree : 0);
+	evaluate(getGraphicVariableInt("$SPLINESEGS", 8) * npts, points);
+
+	for (auto const& vp: points) {
+		minV = RS_Vector::minimum(vp, minV);
+		maxV = RS_Vector::maximum(vp, maxV);
+	}
+}
+
+/**
+ * Creates the lines between the points as child entities, for code
+ * working on the entities of the spline. They are kept until the next
+ * update().
+ */
+void RS_Spline::materialize() {
+	if (materialized) {
+		return;
+	}
+	materialized = true;
+
+	for (size_t i = 1; i < points.size(); ++i) {
+		RS_Line* line = new RS_Line{this, points[i-1], points[i]};
+		line->setLayer(nullptr);
+		line->setPen(RS2::FlagInvalid);
+		appendEntity(line);
+	}
+}
+
+RS_Entity* RS_Spline::firstEntity(RS2::ResolveLevel level) {
+	materialize();
+	return RS_EntityContainer::firstEntity(level);
+}
+
+RS_Entity* RS_Spline::lastEntity(RS2::ResolveLevel level) {
+	materialize();
+	return RS_EntityContainer::lastEntity(level);
+}
+
+RS_Entity* RS_Spline::entityAt(int index) {
+	materialize();
+	return RS_EntityContainer::entityAt(index);
+}
+
+unsigned RS_Spline::count() const {
+	return points.size() < 2 ? 0 : points.size() - 1;
+}
+
+unsigned RS_Spline::countDeep() const {
+	return count();
+}
+
+double RS_Spline::getLength() const {
+	double ret = 0.;
+	for (size_t i = 1; i < points.size(); ++i) {
+		ret += points[i-1].distanceTo(points[i]);
+	}
+	return ret;
+}
+
+/**
+ * @return Nearest point on the lines between the points, or on the
+ * extension of the nearest line if onEntity is false. The lines are
+ * only created if entity is requested.
+ */
+RS_Vector RS_Spline::getNearestPointOnEntity(const RS_Vector& coord,
+											 bool onEntity, double* dist,
+											 RS_Entity** entity) const {
+	if (entity) {
+		const_cast<RS_Spline*>(this)->materialize();
+		return RS_EntityContainer::getNearestPointOnEntity(coord, onEntity, dist, entity);
+	}
+
+	double minDist = RS_MAXDOUBLE;
+	RS_Vector ret(false);
+	for (size_t i = 1; i < points.size(); ++i) {
+		RS_Vector const dir = points[i] - points[i-1];
+		double const l2 = dir.squared();
+		double t = l2 > RS_TOLERANCE2 ? RS_Vector::dotP(coord - points[i-1], dir)/l2 : 0.;
+		double const d = (points[i-1] + dir*std::max(0., std::min(1., t))).distanceTo(coord);
+		if (d < minDist) {
+			minDist = d;
+			if (onEntity || l2 <= RS_TOLERANCE2) {
+				t = std::max(0., std::min(1., t));
+			}
+			ret = points[i-1] + dir*t;
+		}
+	}
+	if (dist) {
+		*dist = ret.valid ? ret.distanceTo(coord) : RS_MAXDOUBLE;
+	}
+	return ret;
+}
+
+/**
+ * @return Distance to the nearest line between the points. The lines
+ * are only created to return one of them for resolving levels.
+ */
+double RS_Spline::getDistanceToPoint(const RS_Vector& coord,
+									 RS_Entity** entity,
+									 RS2::ResolveLevel level,
+									 double solidDist) const {
+	if (entity && (level==RS2::ResolveAll || level==RS2::ResolveAllButTextImage)) {
+		const_cast<RS_Spline*>(this)->materialize();
+		return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+	}
+	if (entity) {
+		*entity = const_cast<RS_Spline*>(this);
+	}
+	double dist = RS_MAXDOUBLE;
+	getNearestPointOnEntity(coord, true, &dist);
+	return dist;
+}
+
+/**
+ * Evaluates p1 points of the curve, evenly spaced in the parameter.
+ */
+void RS_Spline::evaluate(size_t p1, std::vector<RS_Vector>& p) const {
 	std::vector<RS_Vector> tControlPoints = data.controlPoints;
 
     if (data.closed) {
@@ -186,39 +313,52 @@ void RS_Spline::update() {
 	const size_t npts = tControlPoints.size();
     // order:
 	const size_t  k = data.degree+1;
-    // resolution:
-	const size_t  p1 = getGraphicVariableInt("$SPLINESEGS", 8) * npts;
 
 	std::vector<double> h(npts+1, 1.);
-	std::vector<RS_Vector> p(p1, {0., 0.});
+	p.assign(p1, {0., 0.});
     if (data.closed) {
 		rbsplinu(npts,k,p1,tControlPoints,h,p);
     } else {
 		rbspline(npts,k,p1,tControlPoints,h,p);
     }
+}
 
-	RS_Vector prev{};
-	for (auto const& vp: p) {
-		if (prev.valid) {
-			RS_Line* line = new RS_Line{this, prev, vp};
-			line->setLayer(nullptr);
-			line->setPen(RS2::FlagInvalid);
-			addEntity(line);
+/**
+ * @return Number of points for which the chords deviate less than
+ * half a pixel from the curve at the given zoom factor.
+ *
+ * The second derivative of a span is bounded by degree*(degree-1)
+ * times the largest second difference of the control points (for
+ * unit knot spacing), a chord over dt deviates at most |C''|*dt^2/8.
+ */
+size_t RS_Spline::getZoomSegments(double factor) const {
+	const std::vector<RS_Vector>& cp = data.controlPoints;
+	const size_t n = cp.size();
+	double d2 = 0.;
+	if (data.closed) {
+		for (size_t i=0; i<n; ++i) {
+			d2 = std::max(d2, (cp[(i+1)%n] - cp[i]*2. + cp[(i+n-1)%n]).magnitude());
+		}
+	} else {
+		for (size_t i=1; i+1<n; ++i) {
+			d2 = std::max(d2, (cp[i+1] - cp[i]*2. + cp[i-1]).magnitude());
 		}
-		prev = vp;
-		minV = RS_Vector::minimum(prev, minV);
-		maxV = RS_Vector::maximum(prev, maxV);
 	}
+
+	const double bound = data.degree*(data.degree-1)*d2*factor;
+	const double perSpan = std::ceil(std::sqrt(bound/(8.*0.5)));
+	const size_t spans = data.closed ? n : n - data.degree;
+	return spans*static_cast<size_t>(std::min(std::max(perSpan, 1.), 256.)) + 1;
 }
 
 RS_Vector RS_Spline::getStartpoint() const {
-   if (data.closed) return RS_Vector(false);
-   return static_cast<RS_Line*>(const_cast<RS_Spline*>(this)->firstEntity())->getStartpoint();
+   if (data.closed || points.empty()) return RS_Vector(false);
+   return points.front();
 }
 
 RS_Vector RS_Spline::getEndpoint() const {
-   if (data.closed) return RS_Vector(false);
-   return static_cast<RS_Line*>(const_cast<RS_Spline*>(this)->lastEntity())->getEndpoint();
+   if (data.closed || points.empty()) return RS_Vector(false);
+   return points.back();
 }
 
 
@@ -306,6 +446,12 @@ void RS_Spline::move(const RS_Vector& offset) {
 	for (RS_Vector& vp: data.controlPoints) {
 		vp.move(offset);
     }
+	for (RS_Vector& vp: points) {
+		vp.move(offset);
+	}
+	for (RS_Vector& vp: zoomPoints) {
+		vp.move(offset);
+	}
 //    update();
 }
 
@@ -322,6 +468,12 @@ void RS_Spline::rotate(const RS_Vector& center, const RS_Vector& angleVector) {
 	for (RS_Vector& vp: data.controlPoints) {
 		vp.rotate(center, angleVector);
 	}
+	for (RS_Vector& vp: points) {
+		vp.rotate(center, angleVector);
+	}
+	for (RS_Vector& vp: zoomPoints) {
+		vp.rotate(center, angleVector);
+	}
 //    update();
 }
 
@@ -357,6 +509,8 @@ void RS_Spline::moveRef(const RS_Vector& ref, const RS_Vector& offset) {
 
 void RS_Spline::revertDirection() {
 	std::reverse(data.controlPoints.begin(), data.controlPoints.end());
+	std::reverse(points.begin(), points.end());
+	std::reverse(zoomPoints.begin(), zoomPoints.end());
 }
 
 
@@ -368,20 +522,42 @@ void RS_Spline::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patter
         return;
     }
 
+    // solid lines are drawn from points tessellated for the zoom factor,
+    // rounded up to a power of two to keep them while zooming a bit:
+    bool const drawAsSelected = isSelected() && !(view->isPrinting() || view->isPrintPreview());
+    if (!points.empty() && !drawAsSelected
+            && (getPen(true).getLineType()==RS2::SolidLine
+                || view->getDrawingMode()==RS2::ModePreview)) {
+        RS_Vector const f = view->getFactor();
+        int const bucket = static_cast<int>(std::ceil(std::log2(std::max({f.x, f.y, 1e-100}))));
+        if (bucket != zoomBucket) {
+            evaluate(getZoomSegments(std::ldexp(1., bucket)), zoomPoints);
+            zoomBucket = bucket;
+        }
+        RS_Vector prev{false};
+        for (RS_Vector const& vp: zoomPoints) {
+            RS_Vector const gui = view->toGui(vp);
+            if (prev.valid) {
+                painter->drawLine(prev, gui);
+            }
+            prev = gui;
+        }
+        return;
+    }
 
-    RS_Entity* e=firstEntity(RS2::ResolveNone);
-	if (e) {
-        RS_Pen p=this->getPen(true);
-        e->setPen(p);
-        double patternOffset(0.0);
-        view->drawEntity(painter, e, patternOffset);
-        //RS_DEBUG->print("offset: %f\nlength was: %f", offset, e->getLength());
 
-        e = nextEntity(RS2::ResolveNone);
-		while(e) {
-            view->drawEntityPlain(painter, e, patternOffset);
-            e = nextEntity(RS2::ResolveNone);
-            //RS_DEBUG->print("offset: %f\nlength was: %f", offset, e->getLength());
+    // patterns run on over the lines between the points, which are
+    // drawn without creating the child entities:
+    double patternOffset(0.0);
+    for (size_t i = 1; i < points.size(); ++i) {
+        RS_Line line{this, points[i-1], points[i]};
+        line.setLayer(nullptr);
+        if (i == 1) {
+            line.setPen(getPen(true));
+            view->drawEntity(painter, &line, patternOffset);
+        } else {
+            line.setPen(RS2::FlagInvalid);
+            view->drawEntityPlain(painter, &line, patternOffset);
         }
     }
 }
@@ -552,6 +728,72 @@ std::vector<double> rbasis(int c, double t, int npts,
 }
 
 
+/**
+ * Evaluates a rational B-spline at p.size() parameters, starting at t
+ * and step apart.
+ *
+ * The parameters increase, so the knot span of each parameter is found
+ * by moving on from the span of the previous one. Only the k basis
+ * functions which are not zero in the span are calculated (Cox-de Boor
+ * recursion as in de Boor's algorithm), into fixed size arrays without
+ * allocations per point. The results equal those of rbasis().
+ */
+namespace {
+void evaluateRBSpline(size_t k, size_t npts, const std::vector<double>& x,
+                      const std::vector<RS_Vector>& b, const std::vector<double>& h,
+                      double t, double step, std::vector<RS_Vector>& p) {
+	size_t const nplusc = npts + k;
+	// order is 4 at most, see RS_Spline::update()
+	std::array<double, 4> n;
+	std::array<double, 4> left;
+	std::array<double, 4> right;
+
+	size_t span = 0;
+	for (auto& vp: p) {
+		if (x[nplusc-1] - t < 5e-6) t = x[nplusc-1];
+
+		if (t >= x[nplusc-1]) {
+			// pick up last point
+			vp = b[npts-1];
+		} else if (t >= x[0]) {
+			while (t >= x[span+1]) ++span;
+
+			if (span+1 < k || span >= npts) {
+				// less than k basis functions of control points are in this span:
+				auto const nbasis = rbasis(k, t, npts, x, h);
+				for (size_t i = 0; i < npts; i++)
+					vp += b[i] * nbasis[i];
+			} else {
+				n[0] = 1.;
+				for (size_t j = 1; j < k; j++) {
+					left[j] = t - x[span+1-j];
+					right[j] = x[span+j] - t;
+					double saved = 0.;
+					for (size_t r = 0; r < j; r++) {
+						double const temp = n[r]/(right[r+1] + left[j-r]);
+						n[r] = saved + right[r+1]*temp;
+						saved = left[j-r]*temp;
+					}
+					n[j] = saved;
+				}
+
+				double sum = 0.;
+				RS_Vector point{0., 0.};
+				for (size_t r = 0; r < k; r++) {
+					size_t const i = span + 1 - k + r;
+					sum += n[r]*h[i];
+					point += b[i] * (n[r]*h[i]);
+				}
+				if (sum != 0.) vp = point/sum;
+			}
+		}
+
+		t += step;
+	}
+}
+}
+
+
 /**
  * Generates a rational B-spline curve using a uniform open knot vector.
  */
@@ -565,22 +807,8 @@ void RS_Spline::rbspline(size_t npts, size_t k, size_t p1,
 	auto const x = knot(npts, k);
 
     // calculate the points on the rational B-spline curve
-    double t {x[0]};
-    double const step {(x[nplusc-1] - t) / (p1-1)};
-
-	for (auto& vp: p) {
-		if (x[nplusc-1] - t < 5e-6) t = x[nplusc-1];
-
-        // generate the basis function for this value of t
-		auto const nbasis = rbasis(k, t, npts, x, h);
-
-        // generate a point on the curve
-		for (size_t i = 0; i < npts; i++)
-			vp += b[i] * nbasis[i];
-
-		t += step;
-    }
-
+    double const step {(x[nplusc-1] - x[0]) / (p1-1)};
+	evaluateRBSpline(k, npts, x, b, h, x[0], step, p);
 }
 
 
@@ -601,27 +829,12 @@ void RS_Spline::rbsplinu(size_t npts, size_t k, size_t p1,
                          const std::vector<RS_Vector>& b,
                          const std::vector<double>& h,
                          std::vector<RS_Vector>& p) const{
-	size_t const nplusc = npts + k;
-
 	/* generate the periodic knot vector */
 	std::vector<double> const x = knotu(npts, k);
 
     /*    calculate the points on the rational B-spline curve */
-	double t = k-1;
 	double const step = double(npts - k + 1)/(p1 - 1);
-
-	for (auto& vp: p) {
-		if (x[nplusc-1] - t < 5e-6) t = x[nplusc-1];
-
-		/* generate the basis function for this value of t */
-		auto const nbasis = rbasis(k, t, npts, x, h);
-		/* generate a point on the curve, for x, y, z */
-		for (size_t i = 0; i < npts; i++)
-			vp += b[i] * nbasis[i];
-
-		t += step;
-    }
-
+	evaluateRBSpline(k, npts, x, b, h, k-1, step, p);
 }
 
 
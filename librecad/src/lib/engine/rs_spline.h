@@ -57,6 +57,14 @@ std::ostream& operator << (std::ostream& os, const RS_SplineData& ld);
 /**
  * Class for a spline entity.
  *
+ * The curve is kept as an array of points. The lines between them are
+ * only created as child entities when entities of the spline are
+ * asked for (see materialize()), for intersections, trimming and
+ * exploding. Drawing, length and distance queries use the points.
+ *
+ * \warning begin() / end() and range-based for loops don't create the
+ * lines, use firstEntity() / nextEntity() or call materialize() first.
+ *
  * @author Andrew Mustun
  */
 class RS_Spline : public RS_EntityContainer {
@@ -117,6 +125,26 @@ public:
     /** Sets the startpoint */
     /** Sets the endpoint */
 	void update() override;
+	void materialize();
+	/** @return true if the lines between the points are created */
+	bool isMaterialized() const {
+		return materialized;
+	}
+
+	RS_Entity* firstEntity(RS2::ResolveLevel level=RS2::ResolveNone) override;
+	RS_Entity* lastEntity(RS2::ResolveLevel level=RS2::ResolveNone) override;
+	RS_Entity* entityAt(int index) override;
+	unsigned count() const override;
+	unsigned countDeep() const override;
+	double getLength() const override;
+	RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
+									  bool onEntity = true,
+									  double* dist = nullptr,
+									  RS_Entity** entity=nullptr) const override;
+	double getDistanceToPoint(const RS_Vector& coord,
+							  RS_Entity** entity,
+							  RS2::ResolveLevel level=RS2::ResolveNone,
+							  double solidDist = RS_MAXDOUBLE) const override;
 
 	RS_Vector getNearestEndpoint(const RS_Vector& coord,
 										 double* dist = nullptr)const override;
@@ -151,6 +179,9 @@ public:
 		void calculateBorders() override;
 
 private:
+		void evaluate(size_t p1, std::vector<RS_Vector>& p) const;
+		size_t getZoomSegments(double factor) const;
+
 		std::vector<double> knot(size_t num, size_t order) const;
 		void rbspline(size_t npts, size_t k, size_t p1,
 		              const std::vector<RS_Vector>& b,
@@ -165,6 +196,13 @@ private:
 
 protected:
 		RS_SplineData data;
+		//! Points of the curve, see update()
+		std::vector<RS_Vector> points;
+		//! true if the lines between the points are child entities
+		bool materialized;
+		//! Points of the curve for the zoom bucket zoomBucket, see draw()
+		std::vector<RS_Vector> zoomPoints;
+		int zoomBucket;
 }
 ;
 
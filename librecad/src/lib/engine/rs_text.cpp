@@ -288,15 +288,14 @@ void RS_Text::update() {
             letterPos+=space;
         } else {
             // One Letter:
-            QString letterText = QString(data.text.at(i));
-            if (font->findLetter(letterText) == NULL) {
-                RS_DEBUG->print("RS_Text::update: missing font for letter( %s ), replaced it with QChar(0xfffd)",qPrintable(letterText));
-                letterText = QChar(0xfffd);
+            RS_FontGlyph const glyph = font->findGlyph(data.text.at(i));
+            if (glyph.letter == NULL) {
+                continue;
             }
             RS_DEBUG->print("RS_Text::update: insert a "
                             "letter at pos: %f/%f", letterPos.x, letterPos.y);
 
-            RS_InsertData d(letterText,
+            RS_InsertData d(glyph.name,
                             letterPos,
                             RS_Vector(1.0, 1.0),
                             0.0,
@@ -304,13 +303,12 @@ void RS_Text::update() {
                             font->getLetterList(), RS2::NoUpdate);
 
             RS_Insert* letter = new RS_Insert(this, d);
-            RS_Vector letterWidth;
             letter->setPen(RS_Pen(RS2::FlagInvalid));
             letter->setLayer(NULL);
+            letter->setBlockForInsert(glyph.letter);
             letter->update();
-            letter->forcedCalculateBorders();
 
-            letterWidth = RS_Vector(letter->getMax().x-letterPos.x, 0.0);
+            RS_Vector letterWidth = RS_Vector(glyph.width, 0.0);
             if (letterWidth.x < 0)
                 letterWidth.x = -letterSpace.x;
 
@@ -26,11 +26,30 @@
 **********************************************************************/
 
 #include<iostream>
+#include<set>
 #include "qc_applicationwindow.h"
 #include "rs_undocycle.h"
 #include "rs_undo.h"
 #include "rs_debug.h"
 
+namespace {
+//! Memory budget of the undo list of each document in MB, 0 for no limit
+int memoryLimit {256};
+}
+
+/**
+ * Sets the memory budget of the undo lists in MB (preference
+ * Defaults/UndoMemoryLimit), 0 for no limit. Applies to cycles added
+ * afterwards.
+ */
+void RS_Undo::setMemoryLimit(int limitMB) {
+    memoryLimit = limitMB;
+}
+
+int RS_Undo::getMemoryLimit() {
+    return memoryLimit;
+}
+
 /**
  * @return Number of Cycles that can be undone.
  */
@@ -78,12 +97,61 @@ void RS_Undo::addUndoCycle(std::shared_ptr<RS_UndoCycle> const& i) {
 
 //    undoList.insert(++undoPointer, i);
 	undoList.insert(undoList.begin() + (++undoPointer), i);
+    i->updateMemoryUsage();
+    memoryUsage += i->getMemoryUsage();
+    trimUndoList();
 
     RS_DEBUG->print("RS_Undo::addUndoCycle: ok");
 }
 
 
 
+/**
+ * Removes the oldest undo cycles until the undo list fits the
+ * memory budget, see setMemoryLimit(). The current cycle is always
+ * kept. Undone entities of the removed cycles which no remaining
+ * cycle refers to are deleted.
+ */
+void RS_Undo::trimUndoList()
+{
+    if (memoryLimit <= 0) {
+        return;
+    }
+    size_t const limit = static_cast<size_t>(memoryLimit) << 20;
+
+    int count = 0;
+    size_t remaining = memoryUsage;
+    while (remaining > limit && count < undoPointer) {
+        remaining -= undoList[count++]->getMemoryUsage();
+    }
+    if (count == 0) {
+        return;
+    }
+
+    RS_DEBUG->print("RS_Undo::trimUndoList: removing %d undo cycles", count);
+
+    std::set<RS_Undoable*> referenced;
+    for (auto it = undoList.begin() + count; it != undoList.end(); ++it) {
+        referenced.insert((*it)->getUndoables().begin(), (*it)->getUndoables().end());
+    }
+
+    // the removed cycles are done, their undone entities are hidden
+    // originals and can't be restored anymore:
+    for (auto it = undoList.begin(); it != undoList.begin() + count; ++it) {
+        for (RS_Undoable* u: (*it)->getUndoables()) {
+            if (u->isUndone() && referenced.insert(u).second) {
+                removeUndoable(u);
+            }
+        }
+    }
+
+    undoList.erase(undoList.begin(), undoList.begin() + count);
+    undoPointer -= count;
+    memoryUsage = remaining;
+}
+
+
+
 /**
  * Starts a new cycle for one undo step. Every undoable that is
  * added after calling this method goes into this cycle.
@@ -128,6 +196,7 @@ void RS_Undo::startUndoCycle()
 
         // clean up obsolete undoCycles
         while (undoList.size() > removePointer) {
+            memoryUsage -= undoList.back()->getMemoryUsage();
             undoList.pop_back();
         }
     }
@@ -173,6 +242,7 @@ void RS_Undo::endUndoCycle()
 
     if (hasUndoable()) {
         // only keep the undoCycle, when it contains undoables
+        currentCycle->moveUndoneEntities();
         addUndoCycle(currentCycle);
     }
 
@@ -264,6 +334,7 @@ void RS_Undo::setGUIButtons() const
 	appWin->setRedoEnable(undoList.size() > 0 &&
 						  undoPointer+1 < int(undoList.size()));
 	appWin->setUndoEnable(undoList.size() > 0 && undoPointer >= 0);
+	appWin->updateUndoMemory(memoryUsage);
 }
 
 
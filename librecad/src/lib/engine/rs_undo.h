@@ -55,6 +55,12 @@ public:
     virtual int countUndoCycles();
     virtual int countRedoCycles();
     virtual bool hasUndoable();
+    /** @return Estimated bytes held by the undo list. */
+    size_t getMemoryUsage() const {
+        return memoryUsage;
+    }
+    static void setMemoryLimit(int limitMB);
+    static int getMemoryLimit();
 
     virtual void startUndoCycle();
     virtual void addUndoable(RS_Undoable* u);
@@ -80,6 +86,7 @@ public:
 private:
 
 	void addUndoCycle(std::shared_ptr<RS_UndoCycle> const& i);
+	void trimUndoList();
     //! List of undo list items. every item is something that can be undone.
 	std::vector<std::shared_ptr<RS_UndoCycle>> undoList;
 
@@ -97,6 +104,8 @@ private:
     std::shared_ptr<RS_UndoCycle> currentCycle {nullptr};
 
     int refCount {0}; ///< reference counter for nested start/end calls
+
+    size_t memoryUsage {0}; ///< sum of the memory usage of all cycles
 };
 
 
@@ -26,8 +26,96 @@
 **********************************************************************/
 
 
+#include <map>
 #include <ostream>
+#include <vector>
 #include"rs_undocycle.h"
+#include "lc_undodelta.h"
+#include "rs_arc.h"
+#include "rs_circle.h"
+#include "rs_ellipse.h"
+#include "rs_hatch.h"
+#include "rs_insert.h"
+#include "rs_line.h"
+#include "rs_mtext.h"
+#include "rs_point.h"
+#include "rs_polyline.h"
+#include "rs_solid.h"
+#include "rs_spline.h"
+#include "rs_text.h"
+
+namespace {
+
+/**
+ * @return Estimated bytes used by the given entity and its children.
+ */
+size_t entityMemoryUsage(RS_Entity* e) {
+	size_t bytes = 0;
+	switch (e->rtti()) {
+	case RS2::EntityPoint:
+		bytes = sizeof(RS_Point);
+		break;
+	case RS2::EntityLine:
+		bytes = sizeof(RS_Line);
+		break;
+	case RS2::EntityArc:
+		bytes = sizeof(RS_Arc);
+		break;
+	case RS2::EntityCircle:
+		bytes = sizeof(RS_Circle);
+		break;
+	case RS2::EntityEllipse:
+		bytes = sizeof(RS_Ellipse);
+		break;
+	case RS2::EntitySolid:
+		bytes = sizeof(RS_Solid);
+		break;
+	case RS2::EntityPolyline:
+		bytes = sizeof(RS_Polyline);
+		break;
+	case RS2::EntitySpline:
+		bytes = sizeof(RS_Spline)
+				+ static_cast<RS_Spline*>(e)->getNumberOfControlPoints()*sizeof(RS_Vector);
+		break;
+	case RS2::EntityInsert:
+		bytes = sizeof(RS_Insert);
+		break;
+	case RS2::EntityText:
+		bytes = sizeof(RS_Text);
+		break;
+	case RS2::EntityMText:
+		bytes = sizeof(RS_MText);
+		break;
+	case RS2::EntityHatch:
+		bytes = sizeof(RS_Hatch);
+		break;
+	default:
+		bytes = e->isContainer() ? sizeof(RS_EntityContainer) : sizeof(RS_Line);
+		break;
+	}
+
+	// inserts count the copies they hold, they are not materialized here:
+	if (e->isContainer()) {
+		for (RS_Entity* child: *static_cast<RS_EntityContainer*>(e)) {
+			bytes += entityMemoryUsage(child) + sizeof(RS_Entity*);
+		}
+	}
+	return bytes;
+}
+
+}
+
+/**
+ * Deletes the undoables owned by this cycle. Entities and layers
+ * belong to their containers, deltas belong to the cycle.
+ */
+RS_UndoCycle::~RS_UndoCycle() {
+	for (RS_Undoable* u: undoables) {
+		if (u->undoRtti()==RS2::UndoableDelta) {
+			delete u;
+		}
+	}
+}
 
 /**
  * Adds an Undoable to this Undo Cycle. Every Cycle can contain one or
@@ -62,6 +150,52 @@ void RS_UndoCycle::changeUndoState()
 {
 	for (RS_Undoable* u: undoables)
 		u->changeUndoState();
+	moveUndoneEntities();
+}
+
+/**
+ * Lets the containers of the entities of this cycle move the undone
+ * ones out of their entity lists and the redone ones back in.
+ */
+void RS_UndoCycle::moveUndoneEntities()
+{
+	std::map<RS_EntityContainer*, std::vector<RS_Entity*>> containers;
+	for (RS_Undoable* u: undoables) {
+		if (u->undoRtti()==RS2::UndoableEntity) {
+			RS_Entity* e = static_cast<RS_Entity*>(u);
+			if (e->getParent()) {
+				containers[e->getParent()].push_back(e);
+			}
+		}
+	}
+	for (auto const& c: containers) {
+		c.first->moveUndoneEntities(c.second);
+	}
+}
+
+/**
+ * Estimates the bytes held by this cycle. Entities are counted in
+ * both roles, as originals hidden by the cycle and as entities
+ * added by it, as one of them is always kept for undo or redo only.
+ * Called once the cycle is complete.
+ */
+void RS_UndoCycle::updateMemoryUsage()
+{
+	memoryUsage = sizeof(RS_UndoCycle);
+	for (RS_Undoable* u: undoables) {
+		// node of the set:
+		memoryUsage += 4*sizeof(void*);
+		switch (u->undoRtti()) {
+		case RS2::UndoableEntity:
+			memoryUsage += entityMemoryUsage(static_cast<RS_Entity*>(u));
+			break;
+		case RS2::UndoableDelta:
+			memoryUsage += static_cast<LC_UndoDelta*>(u)->getMemoryUsage();
+			break;
+		default:
+			break;
+		}
+	}
 }
 
 std::set<RS_Undoable*> const& RS_UndoCycle::getUndoables() const
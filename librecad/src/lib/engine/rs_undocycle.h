@@ -54,6 +54,7 @@ public:
      * @param type Type of undo item.
      */
 	RS_UndoCycle(/*RS2::UndoType type*/)=default;
+	~RS_UndoCycle();
 
     /**
      * Adds an Undoable to this Undo Cycle. Every Cycle can contain one or
@@ -74,6 +75,13 @@ public:
 
     //! change undo state of all undoable in the current cycle
     void changeUndoState();
+    void moveUndoneEntities();
+
+    void updateMemoryUsage();
+    /** @return Estimated bytes held by this cycle, see updateMemoryUsage() */
+    size_t getMemoryUsage() const {
+        return memoryUsage;
+    }
 
     friend std::ostream& operator << (std::ostream& os, RS_UndoCycle& uc);
 
@@ -86,6 +94,7 @@ private:
     //RS2::UndoType type;
     //! List of entity id's that were affected by this action
     std::set<RS_Undoable*> undoables;
+    size_t memoryUsage {0};
 };
 
 #endif
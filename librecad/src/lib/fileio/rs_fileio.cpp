@@ -102,8 +102,9 @@ RS2::FormatType RS_FileIO::detectFormat(QString const& file, bool forRead)
 		{"cxf", RS2::FormatCXF},
 		{"lff", RS2::FormatLFF}
 	};
-	// only read support for dwg
-	if(forRead) list["dwg"]=RS2::FormatDWG;
+#ifdef DWGSUPPORT
+	list["dwg"]=RS2::FormatDWG;
+#endif
 
 	QString const extension = QFileInfo(file).suffix().toLower();
 	RS2::FormatType type=(list.find(extension)!=
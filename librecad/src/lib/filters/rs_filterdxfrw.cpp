@@ -54,9 +54,11 @@
 #include "rs_graphicview.h"
 #include "rs_dialogfactory.h"
 #include "rs_math.h"
+#include "lc_regenscheduler.h"
 
 #ifdef DWGSUPPORT
 #include "libdwgr.h"
+#include "libdwgw.h"
 #include "rs_debug.h"
 #endif
 
@@ -166,6 +168,15 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatT
         //require to notify
         graphic->getLayerList()->activate(cl, true);
     }
+    // hatches and dimensions are updated at once, inserts depend on them:
+    RS_DEBUG->print("RS_FilterDXFRW::fileImport: updating hatches and dimensions");
+    LC_RegenScheduler regen;
+    for (RS_Block* b: *graphic->getBlockList()) {
+        regen.addAll(b);
+    }
+    regen.addAll(graphic);
+    regen.run();
+
     RS_DEBUG->print("RS_FilterDXFRW::fileImport: updating inserts");
     graphic->updateInserts();
 
@@ -890,7 +901,6 @@ void RS_FilterDXFRW::addDimAlign(const DRW_DimAligned *data) {
                             dimensionData, d);
     setEntityAttributes(entity, data);
     entity->updateDimPoint();
-    entity->update();
     currentContainer->addEntity(entity);
 }
 
@@ -914,7 +924,6 @@ void RS_FilterDXFRW::addDimLinear(const DRW_DimLinear *data) {
     RS_DimLinear* entity = new RS_DimLinear(currentContainer,
                                             dimensionData, d);
     setEntityAttributes(entity, data);
-    entity->update();
     currentContainer->addEntity(entity);
 }
 
@@ -936,7 +945,6 @@ void RS_FilterDXFRW::addDimRadial(const DRW_DimRadial* data) {
                                             dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
     currentContainer->addEntity(entity);
 }
 
@@ -958,7 +966,6 @@ void RS_FilterDXFRW::addDimDiametric(const DRW_DimDiametric* data) {
                               dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
     currentContainer->addEntity(entity);
 }
 
@@ -983,7 +990,6 @@ void RS_FilterDXFRW::addDimAngular(const DRW_DimAngular* data) {
                             dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
     currentContainer->addEntity(entity);
 }
 
@@ -1009,7 +1015,6 @@ void RS_FilterDXFRW::addDimAngular3P(const DRW_DimAngular3p* data) {
                             dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
     currentContainer->addEntity(entity);
 }
 
@@ -1154,10 +1159,7 @@ void RS_FilterDXFRW::addHatch(const DRW_Hatch *data) {
 
     }
 
-    RS_DEBUG->print("hatch->update()");
-    if (hatch->validate()) {
-        hatch->update();
-    } else {
+    if (!hatch->validate()) {
         graphic->removeEntity(hatch);
         RS_DEBUG->print(RS_Debug::D_ERROR,
                     "RS_FilterDXFRW::endEntity(): updating hatch failed: invalid hatch area");
@@ -1368,6 +1370,12 @@ bool RS_FilterDXFRW::fileExport(RS_Graphic& g, const QString& file, RS2::FormatT
     } else if (type==RS2::FormatDXFRW2000) {
         exportVersion = DRW::AC1015;
         version = 1015;
+#ifdef DWGSUPPORT
+    } else if (type==RS2::FormatDWG) {
+        //dwg writer only supports R2000
+        exportVersion = DRW::AC1015;
+        version = 1015;
+#endif
     } else if (type==RS2::FormatDXFRW2004) {
         exportVersion = DRW::AC1018;
         version = 1018;
@@ -1378,6 +1386,11 @@ bool RS_FilterDXFRW::fileExport(RS_Graphic& g, const QString& file, RS2::FormatT
         exactColor = true;
     }
 
+#ifdef DWGSUPPORT
+    if (type==RS2::FormatDWG)
+        dxfW = new dwgW(QFile::encodeName(file));
+    else
+#endif
     dxfW = new dxfRW(QFile::encodeName(file));
     bool success = dxfW->write(this, exportVersion, false); //ascii
 //    bool success = dxf->write(this, exportVersion, true); //binary
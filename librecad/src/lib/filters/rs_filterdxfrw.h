@@ -71,8 +71,13 @@ public:
         }
         
     virtual bool canExport(const QString &/*fileName*/, RS2::FormatType t) const {
+#ifdef DWGSUPPORT
+        return (t==RS2::FormatDXFRW || t==RS2::FormatDXFRW2004 || t==RS2::FormatDXFRW2000
+                || t==RS2::FormatDXFRW14 || t==RS2::FormatDXFRW12 || t==RS2::FormatDWG);
+#else
         return (t==RS2::FormatDXFRW || t==RS2::FormatDXFRW2004 || t==RS2::FormatDXFRW2000
                 || t==RS2::FormatDXFRW14 || t==RS2::FormatDXFRW12);
+#endif
     }
 
     // Import:
@@ -76,6 +76,7 @@ public:
 	void updateSelectionWidget(int, double) override {}
 	void updateArcTangentialOptions(const double& , bool) override{}
 	void commandMessage(const QString&) override {}
+	void updateProgress(const QString&, int, int) override {}
 	void setMouseWidget(QG_MouseWidget*) override {}
 	void setCoordinateWidget(QG_CoordinateWidget* ) override {}
 	void setSelectionWidget(QG_SelectionWidget* ) override {}
@@ -437,6 +437,16 @@ public:
      * @param message The message for the user.
      */
     virtual void commandMessage(const QString& message) = 0;
+
+    /**
+     * This virtual method must be overwritten if the graphic view has
+     * a component that shows the progress of long operations.
+     *
+     * @param message Description of the operation.
+     * @param done Number of finished steps, equal to total when finished.
+     * @param total Total number of steps.
+     */
+    virtual void updateProgress(const QString& message, int done, int total) = 0;
 	virtual void setMouseWidget(QG_MouseWidget*) = 0;
 	virtual void setCoordinateWidget(QG_CoordinateWidget* ) = 0;
 	virtual void setSelectionWidget(QG_SelectionWidget* ) = 0;
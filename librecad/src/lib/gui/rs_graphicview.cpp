@@ -37,6 +37,8 @@
 #include "rs_graphicview.h"
 
 #include "rs_line.h"
+#include "rs_insert.h"
+#include "rs_block.h"
 #include "rs_linetypepattern.h"
 #include "rs_eventhandler.h"
 #include "rs_graphic.h"
@@ -972,7 +974,13 @@ void RS_GraphicView::setPenForEntity(RS_Painter *painter,RS_Entity *e)
 	}
 
 	// Getting pen from entity (or layer)
-	RS_Pen pen = e->getPen(true);
+	RS_Pen pen;
+	if (insertStack.empty()) {
+		pen = e->getPen(true);
+	} else {
+		RS_Layer* layer;
+		resolveInInsert(e, pen, layer);
+	}
 
 	int w = pen.getWidth();
 	if (w<0) {
@@ -1031,7 +1039,7 @@ void RS_GraphicView::setPenForEntity(RS_Painter *painter,RS_Entity *e)
 	if (!isPrinting() && !isPrintPreview())
 	{
 		// this entity is selected:
-		if (e->isSelected()) {
+		if (isDrawnSelected(e)) {
 			pen.setLineType(RS2::DotLine);
 			pen.setColor(selectedColor);
 		}
@@ -1091,7 +1099,7 @@ void RS_GraphicView::drawEntity(RS_Painter *painter, RS_Entity* e, double& patte
 	}
 
 	// entity is not visible:
-	if (!e->isVisible()) {
+	if (insertStack.empty() ? !e->isVisible() : !isVisibleInInsert(e)) {
 		return;
 	}
 	if( isPrintPreview() || isPrinting() ) {
@@ -1102,12 +1110,22 @@ void RS_GraphicView::drawEntity(RS_Painter *painter, RS_Entity* e, double& patte
 	}
 
     // test if the entity is in the viewport
+    // (the borders of block entities drawn by an insert are block coordinates)
     if (!isPrinting() &&
         e->rtti() != RS2::EntityGraphic &&
-        e->rtti() != RS2::EntityLine &&
-       (toGuiX(e->getMax().x)<0 || toGuiX(e->getMin().x)>getWidth() ||
-        toGuiY(e->getMin().y)<0 || toGuiY(e->getMax().y)>getHeight())) {
-        return;
+        e->rtti() != RS2::EntityLine) {
+        if (insertStack.empty()) {
+            if (toGuiX(e->getMax().x)<0 || toGuiX(e->getMin().x)>getWidth() ||
+                toGuiY(e->getMin().y)<0 || toGuiY(e->getMax().y)>getHeight()) {
+                return;
+            }
+        } else {
+            InsertAttributes const& a = insertStack.back();
+            if (e->getMax().x<a.vpMin.x || e->getMin().x>a.vpMax.x ||
+                e->getMax().y<a.vpMin.y || e->getMin().y>a.vpMax.y) {
+                return;
+            }
+        }
     }
 
 	// set pen (color):
@@ -1135,7 +1153,7 @@ void RS_GraphicView::drawEntity(RS_Painter *painter, RS_Entity* e, double& patte
 	}
 
 	// draw reference points:
-	if (e->isSelected() && !(isPrinting() || isPrintPreview())) {
+	if (insertStack.empty() && e->isSelected() && !(isPrinting() || isPrintPreview())) {
 		if (!e->isParentSelected()) {
 			RS_VectorSolutions const& s = e->getRefPoints();
 
@@ -1173,7 +1191,7 @@ void RS_GraphicView::drawEntityPlain(RS_Painter *painter, RS_Entity* e, double&
 		return;
 	}
 
-	if (!e->isContainer() && (e->isSelected()!=painter->shouldDrawSelected())) {
+	if (!e->isContainer() && (isDrawnSelected(e)!=painter->shouldDrawSelected())) {
 		return;
 	}
 
@@ -1185,12 +1203,148 @@ void RS_GraphicView::drawEntityPlain(RS_Painter *painter, RS_Entity* e) {
 		return;
 	}
 
-	if (!e->isContainer() && (e->isSelected()!=painter->shouldDrawSelected())) {
+	if (!e->isContainer() && (isDrawnSelected(e)!=painter->shouldDrawSelected())) {
 		return;
 	}
 	double patternOffset(0.);
 	e->draw(painter, this, patternOffset);
 }
+/**
+ * Starts drawing the block of an insert. Everything drawn until
+ * endInsert() is mapped through the transform t, which maps the
+ * screen coordinates of the block entities to the screen coordinates
+ * of the insert.
+ *
+ * @return false if the painter can't transform its output. The insert
+ *         has to draw copies of the block entities in that case.
+ */
+bool RS_GraphicView::beginInsert(RS_Painter *painter, const RS_Insert* insert,
+								 const QTransform& t) {
+	if (!(painter && insert) || !painter->pushTransform(t)) {
+		return false;
+	}
+
+	InsertAttributes a;
+	a.insert = insert;
+	if (insertStack.empty()) {
+		a.pen = insert->getPen(true);
+		a.layer = insert->getLayer(true);
+		a.transform = t;
+	} else {
+		// nested insert, itself an entity of the block being drawn:
+		resolveInInsert(insert, a.pen, a.layer);
+		a.transform = t * insertStack.back().transform;
+	}
+	// not rounded to pixels, the block may be scaled up by the insert:
+	QRectF r = a.transform.inverted().mapRect(QRectF(0., 0., getWidth(), getHeight()));
+	a.vpMin = RS_Vector((r.left() - offsetX)/factor.x,
+						-(r.bottom() - getHeight() + offsetY)/factor.y);
+	a.vpMax = RS_Vector((r.right() - offsetX)/factor.x,
+						-(r.top() - getHeight() + offsetY)/factor.y);
+	insertStack.push_back(a);
+	return true;
+}
+
+void RS_GraphicView::endInsert(RS_Painter *painter) {
+	if (insertStack.empty()) {
+		return;
+	}
+	insertStack.pop_back();
+	painter->popTransform();
+}
+
+/**
+ * Visible area of the view in graph coordinates. While the block of
+ * an insert is drawn, this is the bounding box of the visible area in
+ * block coordinates.
+ */
+void RS_GraphicView::getVisibleArea(RS_Vector& vpMin, RS_Vector& vpMax) const {
+	if (insertStack.empty()) {
+		vpMin = toGraph(0, getHeight());
+		vpMax = toGraph(getWidth(), 0);
+		return;
+	}
+
+	vpMin = insertStack.back().vpMin;
+	vpMax = insertStack.back().vpMax;
+}
+
+/**
+ * Visibility of a block entity drawn by the innermost insert.
+ * Entities on layer "0" are on the layer of the insert.
+ */
+bool RS_GraphicView::isVisibleInInsert(const RS_Entity* e) const {
+	if (!e->getFlag(RS2::FlagVisible) || e->isUndone()) {
+		return false;
+	}
+	if (e->rtti()==RS2::EntityInsert) {
+		RS_Block* blk = static_cast<const RS_Insert*>(e)->getBlockForInsert();
+		if (blk && blk->isFrozen()) {
+			return false;
+		}
+	}
+
+	RS_Layer* layer = e->getLayer(false);
+	if (!layer || layer->getName()=="0") {
+		layer = insertStack.back().layer;
+	}
+	return !(layer && layer->isFrozen());
+}
+
+/**
+ * Block entities drawn by an insert are selected with the outermost
+ * insert, the one that is part of the drawing.
+ */
+bool RS_GraphicView::isDrawnSelected(const RS_Entity* e) const {
+	if (insertStack.empty()) {
+		return e->isSelected();
+	}
+	return insertStack.front().insert->isSelected();
+}
+
+/**
+ * Resolves pen and layer of a block entity drawn by the innermost
+ * insert, the same way RS_Insert::update() does for the entities
+ * it copies from its block.
+ */
+void RS_GraphicView::resolveInInsert(const RS_Entity* e, RS_Pen& pen,
+									 RS_Layer*& layer) const {
+	const InsertAttributes& a = insertStack.back();
+
+	layer = e->getLayer(false);
+	if (!layer || layer->getName()=="0") {
+		layer = a.layer;
+	}
+
+	pen = e->getPen(false);
+	if (!pen.isValid()) {
+		pen = a.pen;
+		return;
+	}
+
+	if (pen.getColor().isByBlock()) {
+		pen.setColor(a.pen.getColor());
+	}
+	if (pen.getWidth()==RS2::WidthByBlock) {
+		pen.setWidth(a.pen.getWidth());
+	}
+	if (pen.getLineType()==RS2::LineByBlock) {
+		pen.setLineType(a.pen.getLineType());
+	}
+
+	if (layer) {
+		if (pen.getColor().isByLayer()) {
+			pen.setColor(layer->getPen().getColor());
+		}
+		if (pen.getWidth()==RS2::WidthByLayer) {
+			pen.setWidth(layer->getPen().getWidth());
+		}
+		if (pen.getLineType()==RS2::LineByLayer) {
+			pen.setLineType(layer->getPen().getLineType());
+		}
+	}
+}
+
 /**
  * Deletes an entity with the background color.
  * Might be recursively called e.g. for polylines.
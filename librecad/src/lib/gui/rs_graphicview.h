@@ -37,6 +37,7 @@
 #include <tuple>
 #include <memory>
 #include <QAction>
+#include <QTransform>
 
 
 class QMouseEvent;
@@ -45,6 +46,8 @@ class RS_ActionInterface;
 class RS_EventHandler;
 class RS_CommandEvent;
 class RS_Grid;
+class RS_Insert;
+class RS_Layer;
 struct RS_LineTypePattern;
 
 
@@ -273,6 +276,10 @@ public:
 	virtual void drawEntityPlain(RS_Painter *painter, RS_Entity* e);
 	virtual void drawEntityPlain(RS_Painter *painter, RS_Entity* e, double& patternOffset);
 	virtual void setPenForEntity(RS_Painter *painter, RS_Entity* e );
+	virtual bool beginInsert(RS_Painter *painter, const RS_Insert* insert,
+							 const QTransform& t);
+	virtual void endInsert(RS_Painter *painter);
+	void getVisibleArea(RS_Vector& vpMin, RS_Vector& vpMax) const;
     virtual RS_Vector getMousePosition() const = 0;
 
 	virtual const RS_LineTypePattern* getPattern(RS2::LineType t);
@@ -429,6 +436,27 @@ protected:
     LC_Rect view_rect;
 
 private:
+	bool isVisibleInInsert(const RS_Entity* e) const;
+	bool isDrawnSelected(const RS_Entity* e) const;
+	void resolveInInsert(const RS_Entity* e, RS_Pen& pen, RS_Layer*& layer) const;
+
+	/**
+	 * An insert whose block is being drawn through a painter transform.
+	 * Block entities on layer "0" or with ByBlock attributes are drawn
+	 * with the layer and pen of the innermost insert.
+	 */
+	struct InsertAttributes {
+		const RS_Insert* insert;
+		RS_Pen pen;
+		RS_Layer* layer;
+		//! block screen coordinates to view screen coordinates
+		QTransform transform;
+		//! bounding box of the visible area in block coordinates
+		RS_Vector vpMin;
+		RS_Vector vpMax;
+	};
+	//! Inserts being drawn, innermost last
+	std::vector<InsertAttributes> insertStack;
 
 	bool zoomFrozen=false;
 	bool draftMode=false;
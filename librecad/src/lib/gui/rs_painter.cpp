@@ -23,6 +23,7 @@
 ** This copyright notice MUST APPEAR in all copies of the script!
 **
 **********************************************************************/
+#include<algorithm>
 #include<cmath>
 #include<QPolygon>
 #include "rs_pen.h"
@@ -31,6 +32,14 @@
 #include "rs_math.h"
 #include "rs_debug.h"
 
+double RS_Painter::chordStep(double radius, double tolerance) {
+    if (radius<=tolerance) {
+        return M_PI/2.;
+    }
+    // sagitta of a chord spanning a: r*(1-cos(a/2))
+    return std::min(2.*acos(1.-tolerance/radius), M_PI/2.);
+}
+
 void RS_Painter::createArc(QPolygon& pa,
                              const RS_Vector& cp, double radius,
                              double a1, double a2,
@@ -42,8 +51,7 @@ void RS_Painter::createArc(QPolygon& pa,
         return;
     }
 
-    double aStep=fabs(2.0/radius);         // Angle Step (rad)
-    if(aStep>=0.5) aStep=0.5;
+    double aStep=std::min(chordStep(radius), 0.5);         // Angle Step (rad)
     if(reversed) {
         if(a1<=a2+RS_TOLERANCE) a1+=2.*M_PI;
         aStep *= -1;
@@ -96,8 +104,9 @@ void RS_Painter::createEllipse(QPolygon& pa,
         ea2 = ea1 +(reversed?-dA:dA);
     const RS_Vector angleVector(-angle);
     /*
-      draw a new line after tangent changes by 0.01 rad
-      ds^2 = (a^2 sin^2 + b^2 cos^2) da^2
+      keep the chord error below half a pixel: the chord allowed by the
+      local radius of curvature rho=|P'|^3/(ab) is ds=sqrt(8*rho*tol),
+      ds^2 = (a^2 sin^2 + b^2 cos^2) da^2 = |P'|^2 da^2
       */
     RS_Vector vp(-ea1);
     vp.scale(vr);
@@ -119,7 +128,7 @@ void RS_Painter::createEllipse(QPolygon& pa,
         vp=va;
         double r2=va.scale(rvp).squared();
         if( r2<RS_TOLERANCE15) r2=RS_TOLERANCE15;
-        double aStep=ab/(r2*sqrt(r2));
+        double aStep=sqrt(8.*0.5*sqrt(r2)/ab);
         if(aStep < minDea) aStep=minDea;
         if(aStep > M_PI/4.) aStep=M_PI/4.;
         ea1 += reversed?-aStep:aStep;
@@ -38,6 +38,7 @@ class QPolygon;
 class QPolygonF;
 class QImage;
 class QBrush;
+class QTransform;
 
 /**
  * This class is a common interface for a painter class. Such
@@ -94,6 +95,12 @@ public:
     virtual void drawArc(const RS_Vector& cp, double radius,
                          double a1, double a2,
                          bool reversed) = 0;
+    /**
+     * @return Angle step (rad) for which the chord of a circle with the
+     * given radius deviates at most tolerance from the circle. Both in
+     * pixels, so the tessellation follows the current zoom.
+     */
+    static double chordStep(double radius, double tolerance=0.5);
     void createArc(QPolygon& pa,
                    const RS_Vector& cp, double radius,
                    double a1, double a2,
@@ -149,6 +156,30 @@ public:
 
     virtual void setClipRect(int x, int y, int w, int h) = 0;
     virtual void resetClipping() = 0;
+
+    /**
+     * Combines the given transform with the current one. Everything
+     * drawn until popTransform() is mapped through it (used to draw
+     * the block of an insert without copying its entities).
+     *
+     * @return false if this painter can not transform its output.
+     */
+    virtual bool pushTransform(const QTransform& /*t*/) {
+        return false;
+    }
+    virtual void popTransform() {}
+
+    /**
+     * Restricts everything drawn until popClipPath() to the inside
+     * of the given path in screen coordinates.
+     *
+     * @return false if this painter can not clip its output.
+     */
+    virtual bool pushClipPath(const QPainterPath& /*path*/) {
+        return false;
+    }
+    virtual void popClipPath() {}
+
 	int toScreenX(double x) const;
 	int toScreenY(double y) const;
 
@@ -84,7 +84,7 @@ Qt::PenStyle rsToQtLineType(RS2::LineType t) {
  */
 // RVT_PORT changed from RS_PainterQt::RS_PainterQt( const QPaintDevice* pd)
 RS_PainterQt::RS_PainterQt( QPaintDevice* pd)
-        : QPainter(pd), RS_Painter() {}
+        : QPainter(pd), RS_Painter(), transformDepth(0), clipDepth(0) {}
 
 void RS_PainterQt::moveTo(int x, int y) {
         //RVT_PORT changed from QPainter::moveTo(x,y);
@@ -185,25 +185,10 @@ void RS_PainterQt::drawArc(const RS_Vector& cp, double radius,
     } else {
         int   cix;            // Next point on circle
         int   ciy;            //
-        double aStep;         // Angle Step (rad)
         double a;             // Current Angle (rad)
-        double linStep;       // linear step (pixels)
-
-        if (drawingMode==RS2::ModePreview) {
-            linStep = 20.0;
-        } else {
-            linStep = 6.0;
-        }
-
-        if (fabs(linStep/radius)<=1.0) {
-            aStep=asin(linStep/radius);
-        } else {
-            aStep=1.0;
-        }
-
-        if (aStep<0.05) {
-            aStep = 0.05;
-        }
+        // Angle Step (rad), previews may deviate more from the arc
+        double aStep=chordStep(radius,
+                               drawingMode==RS2::ModePreview ? 2.0 : 0.5);
 
         if(!reversed) {
             // Arc Counterclockwise:
@@ -418,7 +403,8 @@ void RS_PainterQt::drawImg(QImage& img, const RS_Vector& pos,
     wm.translate(pos.x, pos.y);
     wm.rotate(RS_Math::rad2deg(-angle));
     wm.scale(factor.x, factor.y);
-    setWorldMatrix(wm);
+    // combined, images can be drawn inside a transformed insert:
+    setWorldMatrix(wm, true);
 
 
     drawImage(0,-img.height(), img);
@@ -531,6 +517,10 @@ void RS_PainterQt::setPen(const RS_Pen& pen) {
 		   rsToQtLineType(lpen.getLineType()));
     p.setJoinStyle(Qt::RoundJoin);
     p.setCapStyle(Qt::RoundCap);
+    // screen widths must not be scaled by the transform of an insert:
+    if (transformDepth>0) {
+        p.setCosmetic(true);
+    }
     QPainter::setPen(p);
 }
 
@@ -612,6 +602,34 @@ void RS_PainterQt::resetClipping() {
     setClipping(false);
 }
 
+bool RS_PainterQt::pushTransform(const QTransform& t) {
+    save();
+    setWorldTransform(t, true);
+    ++transformDepth;
+    return true;
+}
+
+void RS_PainterQt::popTransform() {
+    if (transformDepth>0) {
+        --transformDepth;
+        restore();
+    }
+}
+
+bool RS_PainterQt::pushClipPath(const QPainterPath& path) {
+    save();
+    setClipPath(path, hasClipping() ? Qt::IntersectClip : Qt::ReplaceClip);
+    ++clipDepth;
+    return true;
+}
+
+void RS_PainterQt::popClipPath() {
+    if (clipDepth>0) {
+        --clipDepth;
+        restore();
+    }
+}
+
 void RS_PainterQt::fillRect ( const QRectF & rectangle, const RS_Color & color ) {
 
         double x1=rectangle.left();
@@ -108,8 +108,15 @@ public:
     virtual void setClipRect(int x, int y, int w, int h);
     virtual void resetClipping();
 
+    virtual bool pushTransform(const QTransform& t);
+    virtual void popTransform();
+    virtual bool pushClipPath(const QPainterPath& path);
+    virtual void popClipPath();
+
 protected:
     RS_Pen lpen;
+    int transformDepth; // Number of transforms pushed, pens are cosmetic while > 0
+    int clipDepth; // Number of clip paths pushed
     long rememberX; // Used for the moment because QPainter doesn't support moveTo anymore, thus we need to remember ourselves the moveTo positions
     long rememberY;
 };
@@ -25,6 +25,10 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <queue>
 #include <vector>
 #include "rs_information.h"
 #include "rs_entitycontainer.h"
@@ -273,9 +277,33 @@ RS_VectorSolutions RS_Information::getIntersection(RS_Entity const* e1,
 			return type == RS2::EntityCircle || type == RS2::EntityArc;
 		};
 
+		auto isLine = [](RS_Entity const* e) {
+			return e->rtti() == RS2::EntityLine;
+		};
+		// ellipses with a zero minor radius are left to the quadratic solver
+		auto isEllipse = [](RS_Entity const* e) {
+			return e->rtti() == RS2::EntityEllipse
+					&& static_cast<RS_Ellipse const*>(e)->getRatio() > RS_TOLERANCE;
+		};
+
+		// closed form solvers for the common pairs, they don't need the
+		// LC_Quadratic matrices:
 		if(isArc(e1) && isArc(e2)){
 			//use specialized arc-arc intersection solver
 			ret=getIntersectionArcArc(e1, e2);
+		}else if(isLine(e1) && isLine(e2)){
+			ret=getIntersectionLineLine(static_cast<RS_Line const*>(e1),
+										static_cast<RS_Line const*>(e2));
+		}else if(isLine(e1) && isArc(e2)){
+			ret=getIntersectionLineArc(static_cast<RS_Line const*>(e1), e2);
+		}else if(isArc(e1) && isLine(e2)){
+			ret=getIntersectionLineArc(static_cast<RS_Line const*>(e2), e1);
+		}else if(isLine(e1) && isEllipse(e2)){
+			ret=getIntersectionEllipseLine(static_cast<RS_Line const*>(e1),
+										   static_cast<RS_Ellipse const*>(e2));
+		}else if(isEllipse(e1) && isLine(e2)){
+			ret=getIntersectionEllipseLine(static_cast<RS_Line const*>(e2),
+										   static_cast<RS_Ellipse const*>(e1));
 		}else{
 			const auto qf1=e1->getQuadratic();
 			const auto qf2=e2->getQuadratic();
@@ -336,8 +364,8 @@ RS_VectorSolutions RS_Information::getIntersection(RS_Entity const* e1,
 /**
  * @return Intersection between two lines.
  */
-RS_VectorSolutions RS_Information::getIntersectionLineLine(RS_Line* e1,
-        RS_Line* e2) {
+RS_VectorSolutions RS_Information::getIntersectionLineLine(RS_Line const* e1,
+        RS_Line const* e2) {
 
     RS_VectorSolutions ret;
 
@@ -374,10 +402,11 @@ RS_VectorSolutions RS_Information::getIntersectionLineLine(RS_Line* e1,
 
 
 /**
- * @return One or two intersection points between given entities.
+ * @return One or two intersection points between a line and an arc
+ * or circle.
  */
-RS_VectorSolutions RS_Information::getIntersectionLineArc(RS_Line* line,
-        RS_Arc* arc) {
+RS_VectorSolutions RS_Information::getIntersectionLineArc(RS_Line const* line,
+        RS_Entity const* arc) {
 
     RS_VectorSolutions ret;
 
@@ -386,9 +415,13 @@ RS_VectorSolutions RS_Information::getIntersectionLineArc(RS_Line* line,
     double dist=0.0;
     RS_Vector nearest;
     nearest = line->getNearestPointOnEntity(arc->getCenter(), false, &dist);
+    RS_Vector c = arc->getCenter();
+    double r = arc->getRadius();
 
-    // special case: arc touches line (tangent):
-    if (nearest.valid && fabs(dist - arc->getRadius()) < 1.0e-4) {
+    // special case: arc touches line (tangent), the tolerance shrinks
+    // with small circles, otherwise any line through them is a tangent:
+    double const tolTangent = 1.0e-4*std::min(1., r);
+    if (nearest.valid && fabs(dist - r) < tolTangent) {
 		ret = RS_VectorSolutions({nearest});
         ret.setTangent(true);
         return ret;
@@ -397,8 +430,6 @@ RS_VectorSolutions RS_Information::getIntersectionLineArc(RS_Line* line,
     RS_Vector p = line->getStartpoint();
     RS_Vector d = line->getEndpoint() - line->getStartpoint();
     double d2=d.squared();
-    RS_Vector c = arc->getCenter();
-    double r = arc->getRadius();
     RS_Vector delta = p - c;
     if (d2<RS_TOLERANCE2) {
         //line too short, still check the whether the line touches the arc
@@ -413,16 +444,19 @@ RS_VectorSolutions RS_Information::getIntersectionLineArc(RS_Line* line,
     // solution = p + t d;
     //| p -c+ t d|^2 = r^2
     // |d|^2 t^2 + 2 (p-c).d t + |p-c|^2 -r^2 = 0
+    // the discriminant is |d|^2 (r^2 - distance^2), tolerances are
+    // relative to |d|^2 r^2:
     double a1 = RS_Vector::dotP(delta,d);
     double term1 = a1*a1 - d2*(delta.squared()-r*r);
+    double const tolTerm = RS_TOLERANCE * d2 * r*r;
 //        std::cout<<" discriminant= "<<term1<<std::endl;
-    if( term1 < - RS_TOLERANCE) {
+    if( term1 < - tolTerm) {
 //        std::cout<<"no intersection\n";
     return ret;
     }else{
         term1=fabs(term1);
 //        std::cout<< "term1="<<term1 <<" threshold: "<< RS_TOLERANCE * d2 <<std::endl;
-        if( term1 < RS_TOLERANCE * d2 ) {
+        if( term1 < tolTerm ) {
             //tangential;
 //            ret=RS_VectorSolutions(p - d*(a1/d2));
 			ret=RS_VectorSolutions({line->getNearestPointOnEntity(c, false)});
@@ -517,9 +551,10 @@ RS_VectorSolutions RS_Information::getIntersectionArcArc(RS_Entity const* e1,
 
     double s, t1, t2, term;
 
-    s = 1.0/2.0 * ((r1*r1 - r2*r2)/(RS_Math::pow(u.magnitude(), 2.0)) + 1.0);
+    double const u2 = u.squared();
+    s = 1.0/2.0 * ((r1*r1 - r2*r2)/u2 + 1.0);
 
-    term = (r1*r1)/(RS_Math::pow(u.magnitude(), 2.0)) - s*s;
+    term = (r1*r1)/u2 - s*s;
 
     // no intersection:
     if (term<0.0) {
@@ -681,8 +716,8 @@ RS_VectorSolutions RS_Information::getIntersectionArcEllipse(RS_Arc * a1,
 /**
  * @return One or two intersection points between given entities.
  */
-RS_VectorSolutions RS_Information::getIntersectionEllipseLine(RS_Line* line,
-        RS_Ellipse* ellipse) {
+RS_VectorSolutions RS_Information::getIntersectionEllipseLine(RS_Line const* line,
+        RS_Ellipse const* ellipse) {
 
     RS_VectorSolutions ret;
 
@@ -714,6 +749,13 @@ RS_VectorSolutions RS_Information::getIntersectionEllipseLine(RS_Line* line,
     double a = RS_Vector::dotP(dir, mDir);
     double b = RS_Vector::dotP(dir, mDiff);
     double c = RS_Vector::dotP(diff, mDiff) - 1.0;
+    if (dir.squared()<RS_TOLERANCE2) {
+        //line too short, still check whether the line touches the ellipse
+        if (fabs(c) < 2.*RS_TOLERANCE/ry) {
+            ret.push_back(line->getMiddlePoint());
+        }
+        return ret;
+    }
     double d = b*b - a*c;
 
 //    std::cout<<"RS_Information::getIntersectionEllipseLine(): d="<<d<<std::endl;
@@ -741,6 +783,197 @@ RS_VectorSolutions RS_Information::getIntersectionEllipseLine(RS_Line* line,
 }
 
 
+namespace {
+/**
+ * Boxes crossed by the sweep line of getAllIntersections(), by their
+ * extent in y. A segment tree over the y coordinates of all boxes
+ * finds the boxes containing a value, a map ordered by the lower
+ * border finds the boxes starting within a range. Boxes left behind
+ * by the sweep line are dropped through a queue of their right
+ * borders, and from the tree nodes when these are next visited.
+ */
+class SweepActiveSet {
+public:
+	/**
+	 * @param ys sorted y coordinates of all boxes
+	 * @param n number of boxes
+	 */
+	SweepActiveSet(std::vector<double> const& ys, size_t n):
+		ys(ys)
+	  ,nodes(4*ys.size())
+	  ,starts(n)
+	  ,active(n, false)
+	{}
+
+	//! Adds box i from y1 to y2, both in ys, ending at x2
+	void insert(size_t i, double y1, double y2, double x2) {
+		insert(1, 0, ys.size() - 1, index(y1), index(y2), i);
+		starts[i] = byStart.emplace(y1, i);
+		active[i] = true;
+		ends.emplace(x2, i);
+	}
+
+	//! Removes the boxes ending left of x
+	void removeLeftOf(double x) {
+		while (!ends.empty() && ends.top().first < x) {
+			size_t const i = ends.top().second;
+			ends.pop();
+			active[i] = false;
+			byStart.erase(starts[i]);
+		}
+	}
+
+	//! Calls f for every box overlapping y1 to y2, y1 in ys
+	template<class F>
+	void forOverlapping(double y1, double y2, F const& f) {
+		// boxes containing y1, on the path to its leaf:
+		size_t const leaf = index(y1);
+		size_t node = 1, lo = 0, hi = ys.size() - 1;
+		for (;;) {
+			std::vector<size_t>& boxes = nodes[node];
+			boxes.erase(std::remove_if(boxes.begin(), boxes.end(), [this](size_t i) {
+							return !active[i];
+						}), boxes.end());
+			for (size_t i: boxes)
+				f(i);
+			if (lo == hi)
+				break;
+			size_t const mid = (lo + hi)/2;
+			if (leaf <= mid) {
+				node = 2*node;
+				hi = mid;
+			} else {
+				node = 2*node + 1;
+				lo = mid + 1;
+			}
+		}
+		// boxes starting above y1:
+		for (auto it = byStart.upper_bound(y1); it != byStart.end() && it->first <= y2; ++it)
+			f(it->second);
+	}
+
+private:
+	size_t index(double y) const {
+		return std::lower_bound(ys.begin(), ys.end(), y) - ys.begin();
+	}
+
+	void insert(size_t node, size_t lo, size_t hi, size_t l, size_t r, size_t i) {
+		if (r < lo || hi < l)
+			return;
+		if (l <= lo && hi <= r) {
+			nodes[node].push_back(i);
+			return;
+		}
+		size_t const mid = (lo + hi)/2;
+		insert(2*node, lo, mid, l, r, i);
+		insert(2*node + 1, mid + 1, hi, l, r, i);
+	}
+
+	std::vector<double> const& ys;
+	std::vector<std::vector<size_t>> nodes;
+	std::multimap<double, size_t> byStart;
+	std::vector<std::multimap<double, size_t>::iterator> starts;
+	std::vector<bool> active;
+	std::priority_queue<std::pair<double, size_t>, std::vector<std::pair<double, size_t>>,
+			std::greater<std::pair<double, size_t>>> ends;
+};
+}
+
+
+/**
+ * Finds all intersections between the given atomic entities.
+ *
+ * A sweep line moves over the entities sorted by their left border,
+ * only entities whose bounding boxes are crossed by the sweep line at
+ * the same time and overlap in y are intersected. The entities crossed
+ * by the sweep line are kept by their extent in y, so finding the
+ * overlapping ones takes logarithmic time plus their number. Points
+ * where both entities end (connected entities, segments of a polyline)
+ * are not reported. Construction lines are infinite and are ignored.
+ *
+ * @param others If not empty, only intersections of entities with
+ *  others are reported, with the entity of others as e2, including
+ *  points where both end.
+ */
+std::vector<RS_Information::Crossing> RS_Information::getAllIntersections(
+		std::vector<RS_Entity*> const& entities,
+		std::vector<RS_Entity*> const& others) {
+	struct Item {
+		RS_Entity* e;
+		LC_Rect rect;
+		size_t set;
+	};
+	std::vector<Item> items;
+	items.reserve(entities.size() + others.size());
+	for (size_t set: {0, 1}) {
+		for (RS_Entity* e: set ? others : entities) {
+			if (e && !e->isConstruction() && e->getMin().valid && e->getMax().valid)
+				items.push_back({e, {e->getMin(), e->getMax()}, set});
+		}
+	}
+	std::vector<Crossing> ret;
+	if (items.empty())
+		return ret;
+	std::sort(items.begin(), items.end(), [](Item const& a, Item const& b) {
+		return a.rect.minP().x < b.rect.minP().x;
+	});
+
+	// boxes are grown by half the tolerance in y, so grown boxes overlap
+	// if the boxes are at most the tolerance apart:
+	auto bottom = [](Item const& item) {
+		return item.rect.minP().y - 0.5*RS_TOLERANCE;
+	};
+	auto top = [](Item const& item) {
+		return item.rect.maxP().y + 0.5*RS_TOLERANCE;
+	};
+	std::vector<double> ys;
+	ys.reserve(2*items.size());
+	for (Item const& item: items) {
+		ys.push_back(bottom(item));
+		ys.push_back(top(item));
+	}
+	std::sort(ys.begin(), ys.end());
+	ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+	auto isEnd = [](RS_Entity const* e, RS_Vector const& vp) {
+		return vp.squaredTo(e->getStartpoint()) < RS_TOLERANCE2
+				|| vp.squaredTo(e->getEndpoint()) < RS_TOLERANCE2;
+	};
+
+	// entities are only intersected with the active ones of the other set:
+	bool const single = others.empty();
+	std::vector<SweepActiveSet> active(single ? 1 : 2, SweepActiveSet(ys, items.size()));
+	for (size_t k = 0; k < items.size(); ++k) {
+		Item const& item = items[k];
+		// entities left of the sweep line are done:
+		double const x = item.rect.minP().x - RS_TOLERANCE;
+		for (SweepActiveSet& set: active)
+			set.removeLeftOf(x);
+
+		active[single ? 0 : 1 - item.set].forOverlapping(bottom(item), top(item), [&](size_t j) {
+			Item const& a = items[j];
+			if (!a.rect.intersects(item.rect, RS_TOLERANCE))
+				return;
+			for (RS_Vector const& vp: getIntersection(a.e, item.e, true)) {
+				if (!vp.valid)
+					continue;
+				if (single) {
+					if (!(isEnd(a.e, vp) && isEnd(item.e, vp)))
+						ret.push_back({vp, a.e, item.e});
+				} else if (item.set) {
+					ret.push_back({vp, a.e, item.e});
+				} else {
+					ret.push_back({vp, item.e, a.e});
+				}
+			}
+		});
+		active[single ? 0 : item.set].insert(k, bottom(item), top(item),
+											 item.rect.maxP().x);
+	}
+	return ret;
+}
+
+
 /**
  * Checks if the given coordinate is inside the given contour.
  *
@@ -27,13 +27,13 @@
 #ifndef RS_INFORMATION_H
 #define RS_INFORMATION_H
 
+#include <vector>
 #include "rs.h"
+#include "rs_vector.h"
 
 class RS_Ellipse;
 class RS_Entity;
 class RS_EntityContainer;
-class RS_Vector;
-class RS_VectorSolutions;
 class RS_Arc;
 class RS_Circle;
 class RS_Line;
@@ -49,6 +49,13 @@ class RS_Line;
  */
 class RS_Information {
 public:
+	/** An intersection point and the two entities crossing there. */
+	struct Crossing {
+		RS_Vector point;
+		RS_Entity* e1;
+		RS_Entity* e2;
+	};
+
     RS_Information(RS_EntityContainer& entityContainer);
 
 	static bool isDimension(RS2::EntityType type);
@@ -70,11 +77,11 @@ public:
 			RS_Entity const* e2,
             bool onEntities = false);
 
-    static RS_VectorSolutions getIntersectionLineLine(RS_Line* e1,
-            RS_Line* e2);
+    static RS_VectorSolutions getIntersectionLineLine(RS_Line const* e1,
+            RS_Line const* e2);
 
-    static RS_VectorSolutions getIntersectionLineArc(RS_Line* line,
-            RS_Arc* arc);
+    static RS_VectorSolutions getIntersectionLineArc(RS_Line const* line,
+            RS_Entity const* arc);
 
 	static RS_VectorSolutions getIntersectionArcArc(RS_Entity const* e1,
 			RS_Entity const* e2);
@@ -87,8 +94,11 @@ public:
     static RS_VectorSolutions getIntersectionCircleEllipse(RS_Circle* e1,
             RS_Ellipse* e2);
     
-	static RS_VectorSolutions getIntersectionEllipseLine(RS_Line* line,
-            RS_Ellipse* ellipse);
+	static RS_VectorSolutions getIntersectionEllipseLine(RS_Line const* line,
+            RS_Ellipse const* ellipse);
+	static std::vector<Crossing> getAllIntersections(
+			std::vector<RS_Entity*> const& entities,
+			std::vector<RS_Entity*> const& others = {});
 	/**
 	 * @brief createQuadrilateral form quadrilateral from 4 straight lines
 	 * @param container contains 4 straight lines
@@ -35,6 +35,7 @@
 #include "rs_clipboard.h"
 #include "rs_creation.h"
 #include "rs_graphic.h"
+#include "rs_hatch.h"
 #include "rs_information.h"
 #include "rs_insert.h"
 #include "rs_block.h"
@@ -47,6 +48,7 @@
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
 #include "lc_undosection.h"
+#include "lc_undodelta.h"
 
 #ifdef EMU_C99
 #include "emu_c99.h"
@@ -167,9 +169,15 @@ bool RS_Modification::changeAttributes(
     }
 
     LC_UndoSection  undo(document);
-    QList<RS_Entity*> clones;
+    // attributes are changed in place, the delta keeps the old ones:
+    LC_UndoDelta* delta = document ? new LC_UndoDelta() : nullptr;
     QSet<RS_Block*> blocks;
 
+    // entities of a block are changed in place, its inserts need an update:
+    if (cont->rtti()==RS2::EntityBlock) {
+        static_cast<RS_Block*>(cont)->setChanged(true);
+    }
+
     for (auto en: *cont) {
         if (!en) continue;
         if (!en->isSelected()) continue;
@@ -179,11 +187,12 @@ bool RS_Modification::changeAttributes(
             blocks << bl;
         }
 
-        RS_Entity* cl = en->clone();
-        RS_Pen pen = cl->getPen(false);
+        RS_Layer* layer = en->getLayer(false);
+        RS_Pen pen = en->getPen(false);
 
         if (data.changeLayer==true) {
-            cl->setLayer(data.layer);
+            RS_Graphic* g = en->getGraphic();
+            layer = g ? g->findLayer(data.layer) : nullptr;
         }
 
         if (data.changeColor==true) {
@@ -195,21 +204,30 @@ bool RS_Modification::changeAttributes(
         if (data.changeWidth==true) {
             pen.setWidth(data.pen.getWidth());
         }
-        cl->setPen(pen);
 
         if (graphicView) {
             graphicView->deleteEntity(en);
         }
 
+        if (delta) {
+            delta->setAttributes(en, layer, pen);
+        } else {
+            en->setLayer(layer);
+            en->setPen(pen);
+        }
         en->setSelected(false);
-        cl->setSelected(false);
 
-        clones << cl;
-
-        if (!graphic) continue;
+        if (graphicView) {
+            graphicView->drawEntity(en);
+        }
+    }
 
-        en->setUndoState(true);
-        graphic->addUndoable(en);
+    if (delta) {
+        if (delta->isEmpty()) {
+            delete delta;
+        } else {
+            undo.addUndoable(delta);
+        }
     }
 
     for (auto bl: blocks.values()) {
@@ -220,18 +238,6 @@ bool RS_Modification::changeAttributes(
         changeAttributes(data, (RS_EntityContainer*)bl);
     }
 
-    for (auto cl: clones) {
-        cont->addEntity(cl);
-
-        if (graphicView) {;
-            graphicView->drawEntity(cl);
-        }
-
-        if (graphic) {
-            graphic->addUndoable(cl);
-        }
-    }
-
     if (graphic) {
         graphic->updateInserts();
     }
@@ -682,6 +688,8 @@ bool RS_Modification::pasteContainer(RS_Entity* entity, RS_EntityContainer* cont
 
     // copy content of block/insert to destination
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Modification::pasteInsert: copy content to the subcontainer");
+    bool const copied = !i->isMaterialized();
+    i->materialize();
     for(auto* e: *i) {
 
         if(!e) {
@@ -703,6 +711,9 @@ bool RS_Modification::pasteContainer(RS_Entity* entity, RS_EntityContainer* cont
         }
     }
 
+    if (copied) {
+        i->release();
+    }
     ic->update();
     ic->setSelected(false);
 
@@ -1587,6 +1598,10 @@ bool RS_Modification::move(RS_MoveData& data) {
     }
 
 	std::vector<RS_Entity*> addList;
+	LC_UndoDelta* delta = createDelta(data.number==0, false);
+	if (delta) {
+		delta->move(data.offset);
+	}
 
     // Create new entities
     for (int num=1;
@@ -1618,6 +1633,8 @@ bool RS_Modification::move(RS_MoveData& data) {
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
     deselectOriginals(data.number==0);
+    // since 2.0.4.0: keep selection
+    finishDelta(delta, undo, data.useCurrentLayer, data.useCurrentAttributes, true);
     addNewEntities(addList);
 
     return true;
@@ -1690,6 +1707,10 @@ bool RS_Modification::rotate(RS_RotateData& data) {
     }
 
 	std::vector<RS_Entity*> addList;
+	LC_UndoDelta* delta = createDelta(data.number==0, true);
+	if (delta) {
+		delta->rotate(data.center, data.angle);
+	}
 
     // Create new entities
     for (int num=1;
@@ -1720,6 +1741,7 @@ bool RS_Modification::rotate(RS_RotateData& data) {
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
     deselectOriginals(data.number==0);
+    finishDelta(delta, undo, data.useCurrentLayer, data.useCurrentAttributes, false);
     addNewEntities(addList);
 
     return true;
@@ -1739,6 +1761,13 @@ bool RS_Modification::scale(RS_ScaleData& data) {
     }
 
 	std::vector<RS_Entity*> selectedList,addList;
+	// non-isotropic scaling replaces circles and arcs, always copied:
+	bool isotropic = fabs(data.factor.x - data.factor.y) <= RS_TOLERANCE
+			&& fabs(data.factor.x) > RS_TOLERANCE;
+	LC_UndoDelta* delta = createDelta(data.number==0 && isotropic, true);
+	if (delta) {
+		delta->scale(data.referencePoint, data.factor);
+	}
 
 	for(auto ec: *container){
         if (ec->isSelected() ) {
@@ -1799,6 +1828,7 @@ bool RS_Modification::scale(RS_ScaleData& data) {
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
     deselectOriginals(data.number==0);
+    finishDelta(delta, undo, data.useCurrentLayer, data.useCurrentAttributes, false);
     addNewEntities(addList);
 
     return true;
@@ -1818,6 +1848,10 @@ bool RS_Modification::mirror(RS_MirrorData& data) {
     }
 
 	std::vector<RS_Entity*> addList;
+	LC_UndoDelta* delta = createDelta(data.copy==false, true);
+	if (delta) {
+		delta->mirror(data.axisPoint1, data.axisPoint2);
+	}
 
     // Create new entities
     for (int num=1;
@@ -1848,6 +1882,7 @@ bool RS_Modification::mirror(RS_MirrorData& data) {
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
     deselectOriginals(data.copy==false);
+    finishDelta(delta, undo, data.useCurrentLayer, data.useCurrentAttributes, false);
     addNewEntities(addList);
 
     return true;
@@ -1866,6 +1901,13 @@ bool RS_Modification::rotate2(RS_Rotate2Data& data) {
     }
 
 	std::vector<RS_Entity*> addList;
+	LC_UndoDelta* delta = createDelta(data.number==0, true);
+	if (delta) {
+		RS_Vector center2 = data.center2;
+		center2.rotate(data.center1, data.angle1);
+		delta->rotate(data.center1, data.angle1);
+		delta->rotate(center2, data.angle2);
+	}
 
     // Create new entities
     for (int num=1;
@@ -1901,6 +1943,7 @@ bool RS_Modification::rotate2(RS_Rotate2Data& data) {
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
     deselectOriginals(data.number==0);
+    finishDelta(delta, undo, data.useCurrentLayer, data.useCurrentAttributes, false);
     addNewEntities(addList);
 
     return true;
@@ -1919,6 +1962,11 @@ bool RS_Modification::moveRotate(RS_MoveRotateData& data) {
     }
 
 	std::vector<RS_Entity*> addList;
+	LC_UndoDelta* delta = createDelta(data.number==0, true);
+	if (delta) {
+		delta->move(data.offset);
+		delta->rotate(data.referencePoint + data.offset, data.angle);
+	}
 
     // Create new entities
     for (int num=1;
@@ -1951,6 +1999,7 @@ bool RS_Modification::moveRotate(RS_MoveRotateData& data) {
 
     LC_UndoSection undo( document, handleUndo); // bundle remove/add entities in one undoCycle
     deselectOriginals(data.number==0);
+    finishDelta(delta, undo, data.useCurrentLayer, data.useCurrentAttributes, false);
     addNewEntities(addList);
 
     return true;
@@ -2037,6 +2086,73 @@ void RS_Modification::addNewEntities(std::vector<RS_Entity*>& addList)
 
 
 
+/**
+ * Takes the selected entities out of the selection and collects them
+ * in an undo delta, so they are modified in place instead of being
+ * replaced by modified copies.
+ *
+ * @param inPlace true: the originals are replaced by the modification.
+ * @param rigid true: only entities which can be rotated, scaled and
+ *        mirrored back exactly are modified in place.
+ * @return The delta or nullptr if all entities are copied.
+ */
+LC_UndoDelta* RS_Modification::createDelta(bool inPlace, bool rigid)
+{
+    if (!inPlace || !handleUndo || !document) {
+        return nullptr;
+    }
+
+    LC_UndoDelta* delta = new LC_UndoDelta();
+    for (auto e: *container) {
+        if (e && e->isSelected()
+                && (!rigid || LC_UndoDelta::isInvertible(e))) {
+            e->setSelected(false);
+            delta->addEntity(e);
+        }
+    }
+    return delta;
+}
+
+
+
+/**
+ * Applies the active layer and pen to the entities modified in place
+ * and adds the delta to the undo cycle.
+ *
+ * @param keepSelection true: the modified entities stay selected.
+ */
+void RS_Modification::finishDelta(LC_UndoDelta* delta, LC_UndoSection& undo,
+                                  bool useCurrentLayer, bool useCurrentAttributes,
+                                  bool keepSelection)
+{
+    if (!delta) {
+        return;
+    }
+
+    if (useCurrentLayer || useCurrentAttributes) {
+        RS_Layer* layer = graphic ? graphic->getActiveLayer() : nullptr;
+        for (RS_Entity* e: delta->getEntities()) {
+            delta->setAttributes(e,
+                                 useCurrentLayer ? layer : e->getLayer(false),
+                                 useCurrentAttributes ? document->getActivePen() : e->getPen(false));
+        }
+    }
+
+    if (delta->isEmpty()) {
+        delete delta;
+        return;
+    }
+
+    undo.addUndoable(delta);
+    if (keepSelection) {
+        for (RS_Entity* e: delta->getEntities()) {
+            e->setSelected(true);
+        }
+    }
+}
+
+
+
 /**
  * Trims or extends the given trimEntity to the intersection point of the
  * trimEntity and the limitEntity.
@@ -3064,9 +3180,11 @@ bool RS_Modification::explode(const bool remove /*= true*/)
                 bool resolveLayer;
 
                 switch (ec->rtti()) {
+                case RS2::EntityHatch:
+                    static_cast<RS_Hatch*>(ec)->materializePattern();
+                    // fall-through
                 case RS2::EntityMText:
                 case RS2::EntityText:
-                case RS2::EntityHatch:
                 case RS2::EntityPolyline:
                     rl = RS2::ResolveAll;
                     resolveLayer = true;
@@ -3133,6 +3251,10 @@ bool RS_Modification::explode(const bool remove /*= true*/)
 */
                     }
                 }
+                // everything is cloned, the copies in the insert aren't needed:
+                if (ec->rtti()==RS2::EntityInsert) {
+                    static_cast<RS_Insert*>(ec)->release();
+                }
             } else {
                 e->setSelected(false);
             }
@@ -40,6 +40,8 @@ class RS_Polyline;
 class RS_Document;
 class RS_Graphic;
 class RS_GraphicView;
+class LC_UndoDelta;
+class LC_UndoSection;
 
 /**
  * Holds the data needed for move modifications.
@@ -295,6 +297,10 @@ public:
 private:
     void deselectOriginals(bool remove);
 	void addNewEntities(std::vector<RS_Entity*>& addList);
+	LC_UndoDelta* createDelta(bool inPlace, bool rigid);
+	void finishDelta(LC_UndoDelta* delta, LC_UndoSection& undo,
+					 bool useCurrentLayer, bool useCurrentAttributes,
+					 bool keepSelection);
 	bool explodeTextIntoLetters(RS_MText* text, std::vector<RS_Entity*>& addList);
 	bool explodeTextIntoLetters(RS_Text* text, std::vector<RS_Entity*>& addList);
 
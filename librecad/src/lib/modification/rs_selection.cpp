@@ -24,6 +24,10 @@
 **
 **********************************************************************/
 
+#include <functional>
+#include <map>
+#include <set>
+#include <vector>
 #include "rs_selection.h"
 
 #include "rs_line.h"
@@ -31,7 +35,9 @@
 #include "rs_polyline.h"
 #include "rs_entity.h"
 #include "rs_graphic.h"
+#include "rs_insert.h"
 #include "rs_layer.h"
+#include "lc_rect.h"
 
 
 
@@ -144,6 +150,11 @@ void RS_Selection::selectWindow(const RS_Vector& v1, const RS_Vector& v2,
 /**
  * Selects all entities that are intersected by the given line.
  *
+ * Entities and the parts of containers whose boxes touch the box of
+ * the line are intersected with it by
+ * RS_Information::getAllIntersections(). Construction lines are
+ * infinite and are intersected with the line directly.
+ *
  * @param v1 Startpoint of line.
  * @param v2 Endpoint of line.
  * @param select true: select, false: deselect
@@ -152,54 +163,148 @@ void RS_Selection::selectIntersected(const RS_Vector& v1, const RS_Vector& v2,
                                      bool select) {
 
 	RS_Line line{v1, v2};
-    bool inters;
-
+	LC_Rect const area{line.getMin(), line.getMax()};
+
+	std::vector<RS_Entity*> segments;
+	std::map<RS_Entity const*, RS_Entity*> owners;
+	std::set<RS_Entity*> intersected;
+	auto add = [&](RS_Entity* e, RS_Entity* owner) {
+		if (e->isConstruction()) {
+			if (RS_Information::getIntersection(&line, e, true).hasValid()) {
+				intersected.insert(owner);
+			}
+		} else if (area.intersects({e->getMin(), e->getMax()}, RS_TOLERANCE)) {
+			segments.push_back(e);
+			owners[e] = owner;
+		}
+	};
+
+	// inserts copied here are released once the intersections are known:
+	std::vector<RS_Insert*> copied;
 	for(auto e: *container){
-    //for (unsigned i=0; i<container->count(); ++i) {
-        //RS_Entity* e = container->entityAt(i);
-
-        if (e && e->isVisible()) {
-
-            inters = false;
-
-            // select containers / groups:
-            if (e->isContainer()) {
-                RS_EntityContainer* ec = (RS_EntityContainer*)e;
-
-                for (RS_Entity* e2=ec->firstEntity(RS2::ResolveAll); e2;
-                        e2=ec->nextEntity(RS2::ResolveAll)) {
+		if (!e || !e->isVisible()) {
+			continue;
+		}
+		if (!e->isContainer()) {
+			add(e, e);
+			continue;
+		}
+		if (!e->isConstruction()
+				&& !area.intersects({e->getMin(), e->getMax()}, RS_TOLERANCE)) {
+			continue;
+		}
+		RS_EntityContainer* ec = (RS_EntityContainer*)e;
+		if (e->rtti()==RS2::EntityInsert && !static_cast<RS_Insert*>(e)->isMaterialized()) {
+			copied.push_back(static_cast<RS_Insert*>(e));
+		}
+		for (RS_Entity* e2=ec->firstEntity(RS2::ResolveAll); e2;
+			 e2=ec->nextEntity(RS2::ResolveAll)) {
+			add(e2, e);
+		}
+	}
+
+	for (auto const& c: RS_Information::getAllIntersections(segments, {&line})) {
+		intersected.insert(owners[c.e1]);
+	}
+	for (RS_Insert* i: copied) {
+		i->release();
+	}
 
-                    RS_VectorSolutions sol =
-                        RS_Information::getIntersection(&line, e2, true);
+	for(auto e: *container){
+		if (!intersected.count(e)) {
+			continue;
+		}
+		if (graphicView) {
+			graphicView->deleteEntity(e);
+		}
+
+		e->setSelected(select);
+
+		if (graphicView) {
+			graphicView->drawEntity(e);
+		}
+	}
+}
 
-                    if (sol.hasValid()) {
-                        inters = true;
-                    }
-                }
-            } else {
 
-                RS_VectorSolutions sol =
-                    RS_Information::getIntersection(&line, e, true);
 
-                if (sol.hasValid()) {
-                    inters = true;
+/**
+ * Selects all lines, arcs, circles, ellipses, polylines and splines
+ * which cross another one (or themselves), using
+ * RS_Information::getAllIntersections(). Inserts are resolved and
+ * selected if entities of their blocks cross.
+ *
+ * @return Number of intersections found.
+ */
+size_t RS_Selection::selectCrossings(bool select) {
+    std::vector<RS_Entity*> segments;
+    std::map<RS_Entity const*, RS_Entity*> owners;
+    // inserts copied here, released in reverse order after the sweep:
+    std::vector<RS_Insert*> copied;
+
+    std::function<void(RS_Entity*, RS_Entity*)> collect = [&](RS_Entity* e, RS_Entity* owner) {
+        switch (e->rtti()) {
+        case RS2::EntityLine:
+        case RS2::EntityArc:
+        case RS2::EntityCircle:
+        case RS2::EntityEllipse:
+            segments.push_back(e);
+            owners[e] = owner;
+            break;
+        case RS2::EntityPolyline:
+        case RS2::EntitySpline: {
+            RS_EntityContainer* ec = static_cast<RS_EntityContainer*>(e);
+            for (RS_Entity* e2=ec->firstEntity(RS2::ResolveAll); e2;
+                 e2=ec->nextEntity(RS2::ResolveAll)) {
+                segments.push_back(e2);
+                owners[e2] = owner;
+            }
+            break;
+        }
+        case RS2::EntityInsert: {
+            RS_Insert* insert = static_cast<RS_Insert*>(e);
+            if (!insert->isMaterialized()) {
+                insert->materialize();
+                copied.push_back(insert);
+            }
+            for (auto e2: *insert) {
+                if (e2->isVisible()) {
+                    collect(e2, owner);
                 }
             }
+            break;
+        }
+        default:
+            break;
+        }
+    };
 
-            if (inters) {
-                if (graphicView) {
-                    graphicView->deleteEntity(e);
-                }
+    for (auto e: *container) {
+        if (e && e->isVisible()) {
+            collect(e, e);
+        }
+    }
 
-                e->setSelected(select);
+    auto const crossings = RS_Information::getAllIntersections(segments);
+    for (auto it = copied.rbegin(); it != copied.rend(); ++it) {
+        (*it)->release();
+    }
 
-                if (graphicView) {
-                    graphicView->drawEntity(e);
-                }
+    for (auto const& c: crossings) {
+        for (RS_Entity* e: {owners[c.e1], owners[c.e2]}) {
+            if (e->isSelected() == select) {
+                continue;
+            }
+            if (graphicView) {
+                graphicView->deleteEntity(e);
+            }
+            e->setSelected(select);
+            if (graphicView) {
+                graphicView->drawEntity(e);
             }
         }
     }
-
+    return crossings.size();
 }
 
 
@@ -62,6 +62,7 @@ public:
 		selectIntersected(v1, v2, false);
 	}
     void selectContour(RS_Entity* e);
+    size_t selectCrossings(bool select=true);
 	
     void selectLayer(RS_Entity* e);
     void selectLayer(const QString& layerName, bool select=true);
@@ -0,0 +1,246 @@
+/******************************************************************************
+**
+** This file was created for the LibreCAD project, a 2D CAD program.
+**
+** Copyright (C) 2026 LibreCAD.org
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU General Public License version 2 as published by the Free Software
+** Foundation and appearing in the file gpl-2.0.txt included in the
+** packaging of this file.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+******************************************************************************/
+
+#include <QtCore>
+#include <QCoreApplication>
+
+#include "libdxfrw.h"
+#include "libdwgr.h"
+
+#include "main.h"
+
+#include "console_dxfinfo.h"
+
+
+/**
+ * Collects drawing metadata reported by dxfRW::probe() / dwgR::probe().
+ * Only header and table callbacks are of interest, the entity callbacks
+ * are never called when probing and are left empty.
+ */
+class DxfInfoCollector : public DRW_Interface {
+public:
+    QJsonObject info;
+    QJsonArray layers;
+    QJsonArray blocks;
+
+    void addHeader(const DRW_Header* data) override {
+        QJsonObject vars;
+        for (auto const& v: data->vars) {
+            // DWG header vars are stored without the leading '$'
+            QString key = QString::fromStdString(v.first);
+            if (!key.startsWith('$'))
+                key.prepend('$');
+            DRW_Variant *var = v.second;
+            switch (var->type()) {
+            case DRW_Variant::COORD:
+                vars[key] = QJsonArray{var->content.v->x, var->content.v->y, var->content.v->z};
+                break;
+            case DRW_Variant::STRING:
+                vars[key] = QString::fromUtf8(var->content.s->c_str());
+                break;
+            case DRW_Variant::INTEGER:
+                vars[key] = var->content.i;
+                break;
+            case DRW_Variant::DOUBLE:
+                vars[key] = var->content.d;
+                break;
+            default:
+                break;
+            }
+        }
+        for (auto const& key: {"$ACADVER", "$INSUNITS", "$EXTMIN", "$EXTMAX"}) {
+            if (vars.contains(key))
+                info[QString(key).mid(1).toLower()] = vars[key];
+        }
+    }
+    void addLayer(const DRW_Layer& data) override {
+        layers.append(QString::fromUtf8(data.name.c_str()));
+    }
+    void addBlock(const DRW_Block& data) override {
+        blocks.append(QString::fromUtf8(data.name.c_str()));
+    }
+
+    void addLType(const DRW_LType&) override {}
+    void addDimStyle(const DRW_Dimstyle&) override {}
+    void addVport(const DRW_Vport&) override {}
+    void addTextStyle(const DRW_Textstyle&) override {}
+    void addAppId(const DRW_AppId&) override {}
+    void setBlock(const int) override {}
+    void endBlock() override {}
+    void addPoint(const DRW_Point&) override {}
+    void addLine(const DRW_Line&) override {}
+    void addRay(const DRW_Ray&) override {}
+    void addXline(const DRW_Xline&) override {}
+    void addArc(const DRW_Arc&) override {}
+    void addCircle(const DRW_Circle&) override {}
+    void addEllipse(const DRW_Ellipse&) override {}
+    void addLWPolyline(const DRW_LWPolyline&) override {}
+    void addPolyline(const DRW_Polyline&) override {}
+    void addSpline(const DRW_Spline*) override {}
+    void addKnot(const DRW_Entity&) override {}
+    void addInsert(const DRW_Insert&) override {}
+    void addTrace(const DRW_Trace&) override {}
+    void add3dFace(const DRW_3Dface&) override {}
+    void addSolid(const DRW_Solid&) override {}
+    void addMText(const DRW_MText&) override {}
+    void addText(const DRW_Text&) override {}
+    void addDimAlign(const DRW_DimAligned*) override {}
+    void addDimLinear(const DRW_DimLinear*) override {}
+    void addDimRadial(const DRW_DimRadial*) override {}
+    void addDimDiametric(const DRW_DimDiametric*) override {}
+    void addDimAngular(const DRW_DimAngular*) override {}
+    void addDimAngular3P(const DRW_DimAngular3p*) override {}
+    void addDimOrdinate(const DRW_DimOrdinate*) override {}
+    void addLeader(const DRW_Leader*) override {}
+    void addHatch(const DRW_Hatch*) override {}
+    void addViewport(const DRW_Viewport&) override {}
+    void addImage(const DRW_Image*) override {}
+    void linkImage(const DRW_ImageDef*) override {}
+    void addComment(const char*) override {}
+    void addPlotSettings(const DRW_PlotSettings*) override {}
+
+    void writeHeader(DRW_Header&) override {}
+    void writeBlocks() override {}
+    void writeBlockRecords() override {}
+    void writeEntities() override {}
+    void writeLTypes() override {}
+    void writeLayers() override {}
+    void writeTextstyles() override {}
+    void writeVports() override {}
+    void writeDimstyles() override {}
+    void writeObjects() override {}
+    void writeAppId() override {}
+};
+
+
+static QString dwgVersionString(DRW::Version version)
+{
+    switch (version) {
+    case DRW::AC1006: return "AC1006";
+    case DRW::AC1009: return "AC1009";
+    case DRW::AC1012: return "AC1012";
+    case DRW::AC1014: return "AC1014";
+    case DRW::AC1015: return "AC1015";
+    case DRW::AC1018: return "AC1018";
+    case DRW::AC1021: return "AC1021";
+    case DRW::AC1024: return "AC1024";
+    case DRW::AC1027: return "AC1027";
+    default: return QString();
+    }
+}
+
+
+static QJsonObject probeFile(const QString& fileName)
+{
+    DxfInfoCollector collector;
+    QByteArray path = QFile::encodeName(fileName);
+    bool ok = false;
+
+    if (QFileInfo(fileName).suffix().toLower() == "dwg") {
+        dwgR dwg(path.constData());
+        ok = dwg.probe(&collector);
+        collector.info["acadver"] = dwgVersionString(dwg.getVersion());
+    } else {
+        dxfRW dxf(path.constData());
+        ok = dxf.probe(&collector);
+    }
+
+    QJsonObject result = collector.info;
+    result["file"] = fileName;
+    result["ok"] = ok;
+    result["layers"] = collector.layers;
+    result["blocks"] = collector.blocks;
+    return result;
+}
+
+
+int console_dxfinfo(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("LibreCAD");
+    QCoreApplication::setApplicationName("LibreCAD");
+    QCoreApplication::setApplicationVersion(XSTR(LC_VERSION));
+
+    QFileInfo prgInfo(QFile::decodeName(argv[0]));
+
+    QCommandLineParser parser;
+
+    QString appDesc;
+    if (prgInfo.baseName() != "dxfinfo") {
+        appDesc = "\ndxfinfo usage: " + prgInfo.filePath()
+            + " dxfinfo [options] <dxf/dwg files>\n";
+    }
+    appDesc += "\nPrint version, units, extents, layer and block names of";
+    appDesc += "\nDXF/DWG files, one JSON object per line.";
+    appDesc += "\nOnly header and tables are read, entities are skipped.";
+    parser.setApplicationDescription(appDesc);
+
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption outFileOpt(QStringList() << "o" << "outfile",
+        "Output file, default is stdout.", "file");
+    parser.addOption(outFileOpt);
+
+    parser.addPositionalArgument("<files>", "Input DXF/DWG file(s)");
+
+    parser.process(app);
+
+    QStringList args = parser.positionalArguments();
+    if (!args.isEmpty() && args[0] == "dxfinfo")
+        args.removeFirst();
+
+    QStringList files;
+    for (auto const& arg : args) {
+        QString suffix = QFileInfo(arg).suffix().toLower();
+        if (suffix != "dxf" && suffix != "dwg")
+            continue; // Skip files without .dxf or .dwg extension
+        files.append(arg);
+    }
+
+    if (files.isEmpty())
+        parser.showHelp(EXIT_FAILURE);
+
+    QFile out;
+    if (parser.isSet(outFileOpt)) {
+        out.setFileName(parser.value(outFileOpt));
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            qDebug() << "ERROR: Cannot open output file" << out.fileName();
+            return EXIT_FAILURE;
+        }
+    } else {
+        out.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+    }
+
+    int failed = 0;
+    for (auto const& f : files) {
+        QJsonObject info = probeFile(f);
+        if (!info["ok"].toBool())
+            ++failed;
+        out.write(QJsonDocument(info).toJson(QJsonDocument::Compact));
+        out.write("\n");
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
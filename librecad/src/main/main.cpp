@@ -46,6 +46,7 @@
 #include "rs_debug.h"
 
 #include "console_dxf2pdf.h"
+#include "console_dxfinfo.h"
 
 
 /**
@@ -73,6 +74,9 @@ int main(int argc, char** argv)
         if (arg.compare("dxf2pdf") == 0) {
             return console_dxf2pdf(argc, argv);
         }
+        if (arg.compare("dxfinfo") == 0) {
+            return console_dxfinfo(argc, argv);
+        }
     }
 
     RS_DEBUG->setLevel(RS_Debug::D_WARNING);
@@ -110,6 +114,7 @@ int main(int argc, char** argv)
             qDebug()<<"Commands:";
             qDebug()<<"";
             qDebug()<<"  dxf2pdf\tRun librecad as console dxf2pdf tool. Use -h for help.";
+            qDebug()<<"  dxfinfo\tPrint DXF/DWG metadata without loading entities. Use -h for help.";
             qDebug()<<"";
             qDebug()<<"Options:";
             qDebug()<<"";
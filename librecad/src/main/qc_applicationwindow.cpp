@@ -106,6 +106,10 @@
 #include "lc_penwizard.h"
 #include "textfileviewer.h"
 #include "lc_undosection.h"
+#include "lc_regenscheduler.h"
+#include "rs_block.h"
+#include "rs_graphic.h"
+#include "rs_hatch.h"
 
 #include <boost/version.hpp>
 
@@ -179,6 +183,9 @@ QC_ApplicationWindow::QC_ApplicationWindow()
     grid_status = new TwoStackedLabels(status_bar);
     grid_status->setTopLabel(tr("Grid Status"));
     status_bar->addWidget(grid_status);
+    undo_status = new TwoStackedLabels(status_bar);
+    undo_status->setTopLabel(tr("Undo Memory"));
+    status_bar->addWidget(undo_status);
 
     settings.beginGroup("Widgets");
     int allow_statusbar_fontsize = settings.value("AllowStatusbarFontSize", 0).toInt();
@@ -351,6 +358,8 @@ QC_ApplicationWindow::QC_ApplicationWindow()
 
     RS_DEBUG->print("QC_ApplicationWindow::QC_ApplicationWindow: init settings");
     initSettings();
+    RS_Hatch::setRenderPatterns(settings.value("Appearance/RenderHatchPatterns", 0).toBool());
+    RS_Undo::setMemoryLimit(settings.value("Defaults/UndoMemoryLimit", 256).toInt());
 
     auto command_file = settings.value("Paths/VariableFile", "").toString();
     if (!command_file.isEmpty())
@@ -821,6 +830,15 @@ void QC_ApplicationWindow::setRedoEnable(bool enable){
     }
 }
 
+/**
+ * Shows the memory held by the undo list of the current drawing.
+ */
+void QC_ApplicationWindow::updateUndoMemory(size_t bytes){
+    if(undo_status){
+        undo_status->setBottomLabel(tr("%1 MB").arg(bytes/1048576., 0, 'f', 1));
+    }
+}
+
 void QC_ApplicationWindow::slotEnableActions(bool enable) {
     if(previousZoom){
         previousZoom->setEnabled(enable&& previousZoomEnable);
@@ -1008,6 +1026,10 @@ void QC_ApplicationWindow::slotWindowActivated(QMdiSubWindow* w) {
         blockWidget->setBlockList(m->getDocument()->getBlockList());
 
         // Update all inserts in this graphic (blocks might have changed):
+        RS_BlockList* blockList = m->getDocument()->getBlockList();
+        if (blockList) {
+            blockList->setAllChanged(true);
+        }
         m->getDocument()->updateInserts();
         // whether to enable undo/redo buttons
         m->getDocument()->setGUIButtons();
@@ -2798,12 +2820,33 @@ void QC_ApplicationWindow::slotOptionsGeneral() {
 
     RS_SETTINGS->beginGroup("/Appearance");
     int antialiasing = RS_SETTINGS->readNumEntry("/Antialiasing");
+    bool renderPatterns = RS_SETTINGS->readNumEntry("/RenderHatchPatterns");
     RS_SETTINGS->endGroup();
 
+    RS_SETTINGS->beginGroup("/Defaults");
+    RS_Undo::setMemoryLimit(RS_SETTINGS->readNumEntry("/UndoMemoryLimit", 256));
+    RS_SETTINGS->endGroup();
+
+    // hatches switch between pattern lines and patterns drawn on the fly:
+    bool regenHatches = renderPatterns != RS_Hatch::getRenderPatterns();
+    RS_Hatch::setRenderPatterns(renderPatterns);
+
     QList<QMdiSubWindow*> windows = mdiAreaCAD->subWindowList();
     for (int i = 0; i < windows.size(); ++i) {
         QC_MDIWindow* m = qobject_cast<QC_MDIWindow*>(windows.at(i));
         if (m) {
+            RS_Graphic* graphic = m->getGraphic();
+            if (regenHatches && graphic) {
+                LC_RegenScheduler regen;
+                for (RS_Block* b: *graphic->getBlockList()) {
+                    regen.addAll(b);
+                }
+                regen.addAll(graphic);
+                regen.run();
+                // inserts copy the regenerated hatches of all blocks:
+                graphic->getBlockList()->setAllChanged(true);
+                graphic->updateInserts();
+            }
             QG_GraphicView* gv = m->getGraphicView();
             if (gv) {
                 gv->setBackground(background);
@@ -2815,7 +2858,7 @@ void QC_ApplicationWindow::slotOptionsGeneral() {
                 gv->setHandleColor(handleColor);
                 gv->setEndHandleColor(endHandleColor);
                 gv->setAntialiasing(antialiasing?true:false);
-                gv->redraw(RS2::RedrawGrid);
+                gv->redraw(regenHatches ? RS2::RedrawAll : RS2::RedrawGrid);
             }
         }
     }
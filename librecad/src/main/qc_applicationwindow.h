@@ -92,6 +92,7 @@ public:
     virtual void keyPressEvent(QKeyEvent* e) override;
     void setRedoEnable(bool enable);
     void setUndoEnable(bool enable);
+    void updateUndoMemory(size_t bytes);
     bool loadStyleSheet(QString path);
 
     bool eventFilter(QObject *obj, QEvent *event) override;
@@ -381,6 +382,7 @@ private:
     QG_SelectionWidget* selectionWidget {nullptr};
     QG_ActiveLayerName* m_pActiveLayerName {nullptr};
     TwoStackedLabels* grid_status {nullptr};
+    TwoStackedLabels* undo_status {nullptr};
 
     // --- Menus ---
     QMenu* windowsMenu {nullptr};
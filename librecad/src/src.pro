@@ -103,6 +103,7 @@ INCLUDEPATH += \
     actions \
     main \
     main/console_dxf2pdf \
+    main/console_dxfinfo \
     test \
     plugins \
     ui \
@@ -217,6 +218,8 @@ HEADERS += \
     actions/lc_actionfileexportmakercam.h \
     lib/engine/lc_rect.h \
     lib/engine/lc_undosection.h \
+    lib/engine/lc_undodelta.h \
+    lib/engine/lc_regenscheduler.h \
     lib/printing/lc_printing.h \
     actions/lc_actiondrawlinepolygon3.h \
     main/lc_application.h
@@ -245,6 +248,7 @@ SOURCES += \
     lib/engine/rs_entity.cpp \
     lib/engine/rs_entitycontainer.cpp \
     lib/engine/rs_font.cpp \
+    lib/engine/rs_fontchar.cpp \
     lib/engine/rs_fontlist.cpp \
     lib/engine/rs_graphic.cpp \
     lib/engine/rs_hatch.cpp \
@@ -307,6 +311,8 @@ SOURCES += \
     lib/engine/rs_flags.cpp \
     lib/engine/lc_rect.cpp \
     lib/engine/lc_undosection.cpp \
+    lib/engine/lc_undodelta.cpp \
+    lib/engine/lc_regenscheduler.cpp \
     lib/engine/rs.cpp \
     lib/printing/lc_printing.cpp \
     actions/lc_actiondrawlinepolygon3.cpp \
@@ -437,6 +443,7 @@ HEADERS += actions/rs_actionblocksadd.h \
     actions/rs_actionselectcontour.h \
     actions/rs_actionselectintersected.h \
     actions/rs_actionselectinvert.h \
+    actions/rs_actionselectcrossings.h \
     actions/rs_actionselectsingle.h \
     actions/rs_actionselectwindow.h \
     actions/rs_actionselectlayer.h \
@@ -572,6 +579,7 @@ SOURCES += actions/rs_actionblocksadd.cpp \
     actions/rs_actionselectcontour.cpp \
     actions/rs_actionselectintersected.cpp \
     actions/rs_actionselectinvert.cpp \
+    actions/rs_actionselectcrossings.cpp \
     actions/rs_actionselectsingle.cpp \
     actions/rs_actionselectwindow.cpp \
     actions/rs_actionselectlayer.cpp \
@@ -891,7 +899,8 @@ HEADERS += \
     main/main.h \
     main/mainwindowx.h \
     main/console_dxf2pdf/console_dxf2pdf.h \
-    main/console_dxf2pdf/pdf_print_loop.h
+    main/console_dxf2pdf/pdf_print_loop.h \
+    main/console_dxfinfo/console_dxfinfo.h
 
 SOURCES += \
     main/qc_applicationwindow.cpp \
@@ -904,7 +913,8 @@ SOURCES += \
     main/main.cpp \
     main/mainwindowx.cpp \
     main/console_dxf2pdf/console_dxf2pdf.cpp \
-    main/console_dxf2pdf/pdf_print_loop.cpp
+    main/console_dxf2pdf/pdf_print_loop.cpp \
+    main/console_dxfinfo/console_dxfinfo.cpp
 
 # If C99 emulation is needed, add the respective source files.
 contains(DEFINES, EMU_C99) {
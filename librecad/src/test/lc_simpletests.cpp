@@ -1,7 +1,15 @@
 #include <iostream>
 #include <cmath>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include <QElapsedTimer>
 #include <QMenuBar>
+#include <QDir>
+#include <QFileInfo>
+#include <QThreadPool>
 #include "lc_simpletests.h"
 #include "qc_applicationwindow.h"
 #include "rs_graphic.h"
@@ -10,6 +18,7 @@
 #include "rs_block.h"
 #include "rs_circle.h"
 #include "rs_ellipse.h"
+#include "rs_font.h"
 #include "rs_line.h"
 #include "rs_dimaligned.h"
 #include "rs_dimangular.h"
@@ -20,12 +29,19 @@
 #include "rs_image.h"
 #include "rs_insert.h"
 #include "rs_mtext.h"
+#include "rs_pattern.h"
 #include "rs_point.h"
+#include "rs_system.h"
 #include "rs_text.h"
 #include "rs_entitycontainer.h"
 #include "rs_layer.h"
 #include "rs_graphicview.h"
+#include "rs_information.h"
+#include "lc_quadratic.h"
 #include "rs_debug.h"
+#ifdef DWGSUPPORT
+#include "rs_filterdxfrw.h"
+#endif
 
 LC_SimpleTests::LC_SimpleTests(QWidget *parent):
 	QObject(parent)
@@ -95,6 +111,33 @@ LC_SimpleTests::LC_SimpleTests(QWidget *parent):
 				this, SLOT(slotTestMath01()));
 		testMenu->addAction(action);
 
+		action = new QAction("Intersection Benchmark", this);
+		connect(action, SIGNAL(triggered()),
+				this, SLOT(slotTestIntersectionBenchmark()));
+		testMenu->addAction(action);
+
+		action = new QAction("Intersection Sweep Benchmark", this);
+		connect(action, SIGNAL(triggered()),
+				this, SLOT(slotTestIntersectionSweep()));
+		testMenu->addAction(action);
+
+		action = new QAction("Font Cache Round Trip", this);
+		connect(action, SIGNAL(triggered()),
+				this, SLOT(slotTestLffCache()));
+		testMenu->addAction(action);
+
+		action = new QAction("Pattern Cache Round Trip", this);
+		connect(action, SIGNAL(triggered()),
+				this, SLOT(slotTestPatternCache()));
+		testMenu->addAction(action);
+
+#ifdef DWGSUPPORT
+		action = new QAction("DWG Round Trip", this);
+		connect(action, SIGNAL(triggered()),
+				this, SLOT(slotTestDwgRoundTrip()));
+		testMenu->addAction(action);
+#endif
+
 		action = new QAction("Resize to 640x480", this);
 		connect(action, SIGNAL(triggered()),
 				this, SLOT(slotTestResize640()));
@@ -424,6 +467,11 @@ void LC_SimpleTests::slotTestUpdateInserts() {
 
 	RS_Document* d = QC_ApplicationWindow::getAppWindow()->getDocument();
 	if (d) {
+		// force a complete update, not only of changed blocks:
+		RS_BlockList* bl = d->getBlockList();
+		if (bl) {
+			bl->setAllChanged(true);
+		}
 		d->updateInserts();
 	}
 	RS_DEBUG->print("%s\n: end\n", __func__);
@@ -1074,6 +1122,285 @@ void LC_SimpleTests::slotTestMath01() {
 	RS_DEBUG->print("%s\n: end\n", __func__);
 }
 
+/**
+ * Testing function.
+ * Intersects random lines, arcs, circles and ellipses with each other
+ * and prints the time per call of RS_Information::getIntersection()
+ * next to the time of the generic LC_Quadratic solver for the same
+ * pairs. The seed is fixed, so runs can be compared.
+ */
+void LC_SimpleTests::slotTestIntersectionBenchmark() {
+	RS_DEBUG->print("%s\n: begin\n", __func__);
+
+	const size_t count = 200;
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<double> coord(0., 100.);
+	std::uniform_real_distribution<double> size(1., 30.);
+	std::uniform_real_distribution<double> angle(0., 2.*M_PI);
+	std::uniform_real_distribution<double> ratio(0.1, 1.);
+
+	const char* names[] = {"line", "arc", "circle", "ellipse"};
+	std::vector<std::unique_ptr<RS_Entity>> entities[4];
+	for (size_t i=0; i<count; ++i) {
+		RS_Vector const c{coord(gen), coord(gen)};
+		entities[0].emplace_back(new RS_Line{nullptr, c, c + RS_Vector{angle(gen)}*size(gen)});
+		entities[1].emplace_back(new RS_Arc{nullptr,
+											{c, size(gen), angle(gen), angle(gen), false}});
+		entities[2].emplace_back(new RS_Circle{nullptr, {c, size(gen)}});
+		entities[3].emplace_back(new RS_Ellipse{nullptr,
+												{c, RS_Vector{angle(gen)}*size(gen), ratio(gen),
+												 0., 0., false}});
+	}
+
+	std::cout << "intersection benchmark, " << count*count << " pairs each" << std::endl;
+	for (int t1=0; t1<4; ++t1) {
+		for (int t2=t1; t2<4; ++t2) {
+			size_t found = 0;
+			QElapsedTimer timer;
+			timer.start();
+			for (auto const& e1: entities[t1])
+				for (auto const& e2: entities[t2])
+					found += RS_Information::getIntersection(e1.get(), e2.get(), true).size();
+			double const direct = timer.nsecsElapsed()/double(count*count);
+
+			timer.restart();
+			for (auto const& e1: entities[t1])
+				for (auto const& e2: entities[t2])
+					LC_Quadratic::getIntersection(e1->getQuadratic(), e2->getQuadratic());
+			double const quadratic = timer.nsecsElapsed()/double(count*count);
+
+			std::cout << names[t1] << "-" << names[t2] << ": "
+					  << direct << " ns/pair (" << found << " points), quadratic solver: "
+					  << quadratic << " ns/pair" << std::endl;
+		}
+	}
+	RS_DEBUG->print("%s\n: end\n", __func__);
+}
+
+/**
+ * Testing function.
+ * Finds all intersections between 100000 random short lines and arcs
+ * with RS_Information::getAllIntersections() and prints the time.
+ * The result for the first 2000 entities is compared with testing
+ * every pair.
+ */
+void LC_SimpleTests::slotTestIntersectionSweep() {
+	RS_DEBUG->print("%s\n: begin\n", __func__);
+
+	const size_t count = 100000;
+	const size_t checked = 2000;
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<double> coord(0., 1000.);
+	std::uniform_real_distribution<double> size(0.5, 5.);
+	std::uniform_real_distribution<double> angle(0., 2.*M_PI);
+
+	std::vector<std::unique_ptr<RS_Entity>> owned;
+	std::vector<RS_Entity*> entities;
+	for (size_t i=0; i<count; ++i) {
+		RS_Vector const c{coord(gen), coord(gen)};
+		if (i%4 == 3) {
+			owned.emplace_back(new RS_Arc{nullptr,
+										  {c, size(gen), angle(gen), angle(gen), false}});
+		} else {
+			owned.emplace_back(new RS_Line{nullptr, c, c + RS_Vector{angle(gen)}*size(gen)});
+		}
+		entities.push_back(owned.back().get());
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	size_t const found = RS_Information::getAllIntersections(entities).size();
+	std::cout << "intersection sweep: " << found << " intersections of " << count
+			  << " entities in " << timer.elapsed() << " ms" << std::endl;
+
+	std::vector<RS_Entity*> const subset(entities.begin(), entities.begin() + checked);
+	timer.restart();
+	size_t const swept = RS_Information::getAllIntersections(subset).size();
+	double const sweepTime = timer.nsecsElapsed()*1e-6;
+	timer.restart();
+	// like the sweep, points where both entities end are no crossings:
+	auto isEnd = [](RS_Entity const* e, RS_Vector const& vp) {
+		return vp.squaredTo(e->getStartpoint()) < RS_TOLERANCE2
+				|| vp.squaredTo(e->getEndpoint()) < RS_TOLERANCE2;
+	};
+	size_t pairwise = 0;
+	for (size_t i=0; i<checked; ++i) {
+		for (size_t j=i+1; j<checked; ++j) {
+			for (RS_Vector const& vp: RS_Information::getIntersection(subset[i], subset[j], true)) {
+				if (vp.valid && !(isEnd(subset[i], vp) && isEnd(subset[j], vp)))
+					++pairwise;
+			}
+		}
+	}
+	std::cout << checked << " entities: sweep " << swept << " in " << sweepTime
+			  << " ms, pairwise " << pairwise << " in " << timer.nsecsElapsed()*1e-6 << " ms"
+			  << (swept == pairwise ? "" : "  MISMATCH") << std::endl;
+	RS_DEBUG->print("%s\n: end\n", __func__);
+}
+
+/**
+ * Testing function.
+ * Parses every lff font from its source file, waits for the cache to
+ * be written, reads the cache into a second font and compares the
+ * settings and the generated letters of both fonts.
+ */
+void LC_SimpleTests::slotTestLffCache() {
+	RS_DEBUG->print("%s\n: begin\n", __func__);
+
+	auto sameLetter = [](RS_Block* a, RS_Block* b) {
+		if (!a || !b)
+			return a == b;
+		return a->count() == b->count()
+				&& a->getMin().distanceTo(b->getMin()) < RS_TOLERANCE
+				&& a->getMax().distanceTo(b->getMax()) < RS_TOLERANCE
+				&& std::abs(a->getLength() - b->getLength()) < RS_TOLERANCE;
+	};
+
+	int failed = 0;
+	for (QString const& path: RS_SYSTEM->getNewFontList()) {
+		QFileInfo const source(path);
+		QString const cachePath = RS_Font::getLffCachePath(source);
+		if (cachePath.isEmpty()) {
+			std::cout << "lff cache: no cache directory" << std::endl;
+			return;
+		}
+		QFile::remove(cachePath);
+
+		RS_Font parsed(path);
+		parsed.readLFF(path);
+		QThreadPool::globalInstance()->waitForDone();
+
+		RS_Font cached(path);
+		bool ok = cached.readLffCache(cachePath, source);
+		ok = ok && parsed.lffIndex.keys().toSet() == cached.lffIndex.keys().toSet()
+				&& parsed.letterSpacing == cached.letterSpacing
+				&& parsed.wordSpacing == cached.wordSpacing
+				&& parsed.lineSpacingFactor == cached.lineSpacingFactor
+				&& parsed.names == cached.names
+				&& parsed.authors == cached.authors
+				&& parsed.encoding == cached.encoding;
+		int letters = 0;
+		if (ok) {
+			parsed.generateAllFonts();
+			cached.generateAllFonts();
+			for (QChar const& ch: parsed.lffIndex.keys()) {
+				++letters;
+				if (!sameLetter(parsed.letterList.find(ch), cached.letterList.find(ch))) {
+					std::cout << "lff cache: " << source.fileName().toStdString()
+							  << ": letter " << std::hex << ch.unicode() << std::dec
+							  << " MISMATCH" << std::endl;
+					ok = false;
+				}
+			}
+		}
+		std::cout << "lff cache: " << source.fileName().toStdString() << ": "
+				  << letters << " letters" << (ok ? "" : "  FAILED") << std::endl;
+		if (!ok)
+			++failed;
+	}
+	std::cout << (failed ? "lff cache: FAILED" : "lff cache: OK") << std::endl;
+	RS_DEBUG->print("%s\n: end\n", __func__);
+}
+
+/**
+ * Testing function.
+ * Loads every pattern from its source file, which writes the cache
+ * for patterns made of lines, reads the cache into a second pattern
+ * and compares the line families of both patterns.
+ */
+void LC_SimpleTests::slotTestPatternCache() {
+	RS_DEBUG->print("%s\n: begin\n", __func__);
+
+	int failed = 0;
+	for (QString const& path: RS_SYSTEM->getPatternList()) {
+		QFileInfo const source(path);
+		QString const cachePath = RS_Pattern::getCachePath(source);
+		if (cachePath.isEmpty()) {
+			std::cout << "pattern cache: no cache directory" << std::endl;
+			return;
+		}
+		QFile::remove(cachePath);
+
+		RS_Pattern loaded(path);
+		loaded.loadPattern();
+		if (loaded.hasCurves()) {
+			// not cached
+			continue;
+		}
+
+		RS_Pattern cached(path);
+		bool ok = cached.readCache(source)
+				&& loaded.getLines().size() == cached.getLines().size();
+		for (size_t i=0; ok && i<loaded.getLines().size(); ++i) {
+			RS_PatternLine const& a = loaded.getLines()[i];
+			RS_PatternLine const& b = cached.getLines()[i];
+			ok = a.origin == b.origin && a.angle == b.angle && a.length == b.length;
+		}
+		std::cout << "pattern cache: " << source.fileName().toStdString() << ": "
+				  << loaded.getLines().size() << " lines" << (ok ? "" : "  FAILED") << std::endl;
+		if (!ok)
+			++failed;
+	}
+	std::cout << (failed ? "pattern cache: FAILED" : "pattern cache: OK") << std::endl;
+	RS_DEBUG->print("%s\n: end\n", __func__);
+}
+
+#ifdef DWGSUPPORT
+/**
+ * Testing function.
+ * Writes the current drawing to a temporary dwg file, reads it back
+ * and prints the number of layers, blocks and entities of each type.
+ */
+void LC_SimpleTests::slotTestDwgRoundTrip() {
+	RS_DEBUG->print("%s\n: begin\n", __func__);
+
+	RS_Document* d = QC_ApplicationWindow::getAppWindow()->getDocument();
+	if (!d || d->rtti()!=RS2::EntityGraphic)
+		return;
+	RS_Graphic* graphic = static_cast<RS_Graphic*>(d);
+	QString file = QDir::temp().filePath("librecad_roundtrip.dwg");
+
+	RS_FilterDXFRW writer;
+	if (!writer.fileExport(*graphic, file, RS2::FormatDWG)) {
+		std::cout << "dwg round trip: can't write " << file.toStdString() << std::endl;
+		return;
+	}
+	RS_Graphic readBack;
+	RS_FilterDXFRW reader;
+	if (!reader.fileImport(readBack, file, RS2::FormatDWG)) {
+		std::cout << "dwg round trip: can't read " << file.toStdString() << std::endl;
+		return;
+	}
+
+	auto countTypes = [](RS_Graphic* g) {
+		std::map<int, int> counts;
+		for (auto e: g->getEntityList())
+			if (!e->isUndone())
+				++counts[e->rtti()];
+		return counts;
+	};
+	std::map<int, int> before = countTypes(graphic);
+	std::map<int, int> after = countTypes(&readBack);
+	std::map<int, int> all = before;
+	all.insert(after.begin(), after.end());
+
+	std::cout << "dwg round trip: " << file.toStdString() << std::endl;
+	std::cout << "layers: " << graphic->countLayers() << " -> " << readBack.countLayers() << std::endl;
+	std::cout << "blocks: " << graphic->countBlocks() << " -> " << readBack.countBlocks() << std::endl;
+	bool same = true;
+	for (auto const& c: all) {
+		int b = before.count(c.first) ? before[c.first] : 0;
+		int a = after.count(c.first) ? after[c.first] : 0;
+		std::cout << "rtti " << c.first << ": " << b << " -> " << a
+				  << (a == b ? "" : "  MISMATCH") << std::endl;
+		if (a != b)
+			same = false;
+	}
+	std::cout << (same ? "dwg round trip: OK" : "dwg round trip: FAILED") << std::endl;
+	RS_DEBUG->print("%s\n: end\n", __func__);
+}
+#endif
+
 /**
  * Testing function.
  */
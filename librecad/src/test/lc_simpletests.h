@@ -36,6 +36,18 @@ public slots:
 	void slotTestUnicode();
 	/** math experimental */
 	void slotTestMath01();
+	/** times RS_Information::getIntersection() for each pair of entity types */
+	void slotTestIntersectionBenchmark();
+	/** times RS_Information::getAllIntersections() on 100000 segments */
+	void slotTestIntersectionSweep();
+	/** parses all lff fonts, writes and reads their caches and compares the letters */
+	void slotTestLffCache();
+	/** loads all patterns, writes and reads their caches and compares the lines */
+	void slotTestPatternCache();
+#ifdef DWGSUPPORT
+	/** saves the drawing as dwg, reads it back and compares entity counts */
+	void slotTestDwgRoundTrip();
+#endif
 	/** resizes window to 640x480 for screen shots */
 	void slotTestResize640();
 	/** resizes window to 640x480 for screen shots */
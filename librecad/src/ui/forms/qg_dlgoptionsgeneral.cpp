@@ -136,6 +136,9 @@ void QG_DlgOptionsGeneral::init()
     checked = RS_SETTINGS->readNumEntry("/ScrollBars");
     scrollbars_check_box->setChecked(checked?true:false);
 
+    checked = RS_SETTINGS->readNumEntry("/RenderHatchPatterns");
+    cbRenderHatchPatterns->setChecked(checked?true:false);
+
     // preview:
 	initComboBox(cbMaxPreview, RS_SETTINGS->readEntry("/MaxPreview", "100"));
 
@@ -178,6 +181,7 @@ void QG_DlgOptionsGeneral::init()
     cbUnit->setCurrentIndex( cbUnit->findText(QObject::tr( RS_SETTINGS->readEntry("/Unit", def_unit).toUtf8().data() )) );
     // Auto save timer
     cbAutoSaveTime->setValue(RS_SETTINGS->readNumEntry("/AutoSaveTime", 5));
+    sbUndoMemoryLimit->setValue(RS_SETTINGS->readNumEntry("/UndoMemoryLimit", 256));
     cbAutoBackup->setChecked(RS_SETTINGS->readNumEntry("/AutoBackupDocument", 1));
     cbUseQtFileOpenDialog->setChecked(RS_SETTINGS->readNumEntry("/UseQtFileOpenDialog", 1));
     cbWheelScrollInvertH->setChecked(RS_SETTINGS->readNumEntry("/WheelScrollInvertH", 0));
@@ -251,6 +255,7 @@ void QG_DlgOptionsGeneral::ok()
         RS_SETTINGS->writeEntry("/cursor_hiding", cursor_hiding_checkbox->isChecked());
         RS_SETTINGS->writeEntry("/Antialiasing", cb_antialiasing->isChecked()?1:0);
         RS_SETTINGS->writeEntry("/ScrollBars", scrollbars_check_box->isChecked()?1:0);
+        RS_SETTINGS->writeEntry("/RenderHatchPatterns", cbRenderHatchPatterns->isChecked()?1:0);
         RS_SETTINGS->endGroup();
 
         RS_SETTINGS->beginGroup("Colors");
@@ -278,6 +283,7 @@ void QG_DlgOptionsGeneral::ok()
         RS_SETTINGS->writeEntry("/Unit",
             RS_Units::unitToString( RS_Units::stringToUnit( cbUnit->currentText() ), false/*untr.*/) );
         RS_SETTINGS->writeEntry("/AutoSaveTime", cbAutoSaveTime->value() );
+        RS_SETTINGS->writeEntry("/UndoMemoryLimit", sbUndoMemoryLimit->value() );
         RS_SETTINGS->writeEntry("/AutoBackupDocument", cbAutoBackup->isChecked() ? 1 : 0);
         RS_SETTINGS->writeEntry("/UseQtFileOpenDialog", cbUseQtFileOpenDialog->isChecked() ? 1 : 0);
         RS_SETTINGS->writeEntry("/WheelScrollInvertH", cbWheelScrollInvertH->isChecked() ? 1 : 0);
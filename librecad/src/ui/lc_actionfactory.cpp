@@ -1032,6 +1032,13 @@ void LC_ActionFactory::fillActionContainer(QMap<QString, QAction*>& a_map, LC_Ac
     action->setObjectName("SelectInvert");
     a_map["SelectInvert"] = action;
 
+    action = new QAction(tr("Select Crossing Entities"), agm->select);
+    action->setIcon(QIcon(":/icons/select_intersected_entities.svg"));
+    connect(action, SIGNAL(triggered()),
+    action_handler, SLOT(slotSelectCrossings()));
+    action->setObjectName("SelectCrossings");
+    a_map["SelectCrossings"] = action;
+
     // <[~ Misc ~]>
 
     action = new QAction(tr("Export as CA&M/plain SVG..."), agm->file);
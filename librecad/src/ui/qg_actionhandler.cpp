@@ -138,6 +138,7 @@
 #include "rs_actionselectcontour.h"
 #include "rs_actionselectintersected.h"
 #include "rs_actionselectinvert.h"
+#include "rs_actionselectcrossings.h"
 #include "rs_actionselectlayer.h"
 #include "rs_actionselectsingle.h"
 #include "rs_actionselectwindow.h"
@@ -358,6 +359,9 @@ RS_ActionInterface* QG_ActionHandler::setCurrentAction(RS2::ActionType id) {
     case RS2::ActionSelectInvert:
         a = new RS_ActionSelectInvert(*document, *view);
         break;
+    case RS2::ActionSelectCrossings:
+        a = new RS_ActionSelectCrossings(*document, *view);
+        break;
     case RS2::ActionSelectIntersected:
         view->killSelectActions();
         a = new RS_ActionSelectIntersected(*document, *view, true);
@@ -1310,6 +1314,10 @@ void QG_ActionHandler::slotSelectInvert() {
     setCurrentAction(RS2::ActionSelectInvert);
 }
 
+void QG_ActionHandler::slotSelectCrossings() {
+    setCurrentAction(RS2::ActionSelectCrossings);
+}
+
 void QG_ActionHandler::slotSelectIntersected() {
     setCurrentAction(RS2::ActionSelectIntersected);
 }
@@ -111,6 +111,7 @@ public slots:
 	void slotSelectAll();
 	void slotDeselectAll();
 	void slotSelectInvert();
+	void slotSelectCrossings();
 	void slotSelectIntersected();
 	void slotDeselectIntersected();
 	void slotSelectLayer();
@@ -34,6 +34,8 @@
 #include <QString>
 #include <QFileDialog>
 #include <QToolBar>
+#include <QMainWindow>
+#include <QStatusBar>
 #include <QRegularExpression>
 
 #include "rs_patternlist.h"
@@ -1997,6 +1999,27 @@ void QG_DialogFactory::commandMessage(const QString& message) {
 
 
 
+/**
+ * Shows the progress of a long operation in the status bar.
+ * Only the status bar is repainted, events are not processed
+ * since the drawing may be in an intermediate state.
+ */
+void QG_DialogFactory::updateProgress(const QString& message, int done, int total) {
+	QMainWindow* mainWindow = qobject_cast<QMainWindow*>(parent);
+	if (!mainWindow) {
+		return;
+	}
+	QStatusBar* statusBar = mainWindow->statusBar();
+	if (done>=total || total<=0) {
+		statusBar->clearMessage();
+	} else {
+		statusBar->showMessage(QString("%1 %2%").arg(message).arg(100*done/total));
+	}
+	statusBar->repaint();
+}
+
+
+
 /**
  * Converts an extension to a format description.
  * e.g. "PNG" to "Portable Network Graphic"
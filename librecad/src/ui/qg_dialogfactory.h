@@ -236,6 +236,7 @@ public:
 								   const QString& right=QString()) override;
 	void updateSelectionWidget(int num, double length) override;//updated for total number of selected, and total length of selected
 	void commandMessage(const QString& message) override;
+	void updateProgress(const QString& message, int done, int total) override;
 
 	static QString extToFormat(const QString& ext);
 	void updateArcTangentialOptions(const double& d, bool byRadius) override;
@@ -212,6 +212,9 @@ QString QG_FileDialog::getSaveFile(RS2::FormatType* type){
 #else
     filters << fDxfrw2007 << fDxfrw2004 << fDxfrw2000 << fDxfrw14 << fDxfrw12 << fLff << fCxf;
 #endif
+#ifdef DWGSUPPORT
+    filters << fDwg;
+#endif
 
     ftype = RS2::FormatDXFRW;
     RS_DEBUG->print("defFilter: %s", fDxfrw2007.toLatin1().data());
@@ -257,7 +260,7 @@ QString QG_FileDialog::getSaveFile(RS2::FormatType* type){
         *type = ftype;
 
     // append default extension:
-	if (!fi.fileName().endsWith(".dxf",Qt::CaseInsensitive))
+	if (!fi.fileName().endsWith(getExtension(ftype),Qt::CaseInsensitive))
         fn += getExtension(ftype);
 
     // store new default settings: